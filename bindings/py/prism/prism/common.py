@@ -141,6 +141,18 @@ class PrismIncompatibleAbiError(PrismError, RuntimeError):
     """PRISM_ERROR_INCOMPATIBLE_ABI"""
 
 
+class PrismCancelledError(PrismError, RuntimeError):
+    """PRISM_ERROR_CANCELLED"""
+
+
+class PrismIoFailureError(PrismError, OSError):
+    """PRISM_ERROR_IO_FAILURE"""
+
+
+class PrismTimedOutError(PrismError, TimeoutError):
+    """PRISM_ERROR_TIMED_OUT"""
+
+
 _ERROR_MAP = {
     lib.PRISM_ERROR_NOT_INITIALIZED: PrismNotInitializedError,
     lib.PRISM_ERROR_INVALID_PARAM: PrismInvalidParamError,
@@ -165,6 +177,9 @@ _ERROR_MAP = {
     lib.PRISM_ERROR_LIBRARY_LOAD_FAILED: PrismLibraryLoadFailedError,
     lib.PRISM_ERROR_LIBRARY_INVALID: PrismLibraryInvalidError,
     lib.PRISM_ERROR_INCOMPATIBLE_ABI: PrismIncompatibleAbiError,
+    lib.PRISM_ERROR_CANCELLED: PrismCancelledError,
+    lib.PRISM_ERROR_IO_FAILURE: PrismIoFailureError,
+    lib.PRISM_ERROR_TIMED_OUT: PrismTimedOutError,
 }
 
 
@@ -30,18 +30,33 @@ if(NOT MSVC AND NOT PRISM_HAS_JTHREAD_NATIVE)
   target_link_options(prism_common INTERFACE -fexperimental-library)
 endif()
 set(_prism_sources
+    source/audio_cache.cpp
+    source/audio_convert.cpp
+    source/audio_stream.cpp
     source/backend_catalog.cpp
     source/backend_check.cpp
     source/backend_enumerator.cpp
+    source/backend_group.cpp
+    source/backend_selector.cpp
     source/delayimp.cpp
     source/simd_kernels.cpp
+    source/failover.cpp
     source/frozen_registry.cpp
+    source/latency_stats.cpp
     source/logging.cpp
+    source/phrase_pack.cpp
     source/plugin_loader.cpp
     source/poll_waiter.cpp
     source/power_notifier.cpp
+    source/prerenderer.cpp
     source/prism.cpp
+    source/ssml.cpp
+    source/text_normalizer.cpp
+    source/text_segmenter.cpp
+    source/trace.cpp
     source/utils.cpp
+    source/utterance_worker.cpp
+    source/voice_index.cpp
     source/backends/custom_backend.cpp)
 if(WIN32)
   list(APPEND _prism_sources source/backends/raw/fsapi.c
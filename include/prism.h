@@ -90,6 +90,11 @@ typedef struct PrismBackend PrismBackend;
 typedef uint64_t PrismBackendId;
 typedef struct PrismRegistry PrismRegistry;
 typedef struct PrismRegistryBuilder PrismRegistryBuilder;
+typedef struct PrismCancelToken PrismCancelToken;
+typedef struct PrismAudioStream PrismAudioStream;
+typedef struct PrismPhrasePack PrismPhrasePack;
+typedef struct PrismBackendGroup PrismBackendGroup;
+typedef struct PrismFailover PrismFailover;
 
 typedef void(PRISM_CALL *PrismAvailabilityCallback)(void *userdata,
                                                     PrismBackendId backend,
@@ -105,6 +110,9 @@ typedef struct {
   uint32_t availability_debounce_samples;
   uint32_t availability_backoff_max_ms;
   bool availability_auto_power_manage;
+  size_t audio_cache_bytes;
+  uint32_t selection_parallelism;
+  uint32_t selection_deadline_ms;
 } PrismConfig;
 
 #ifdef _MSC_VER
@@ -136,16 +144,203 @@ typedef enum PrismError {
   PRISM_ERROR_LIBRARY_LOAD_FAILED,
   PRISM_ERROR_LIBRARY_INVALID,
   PRISM_ERROR_INCOMPATIBLE_ABI,
+  PRISM_ERROR_CANCELLED,
+  PRISM_ERROR_IO_FAILURE,
+  PRISM_ERROR_TIMED_OUT,
   PRISM_ERROR_COUNT
 } PrismError;
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
 
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 26812)
+#endif
+typedef enum PrismTextFlags {
+  PRISM_TEXT_DEFAULT = 0,
+  PRISM_TEXT_PREVALIDATED = (1U << 0),
+  PRISM_TEXT_NUL_TERMINATED = (1U << 1)
+} PrismTextFlags;
+typedef enum PrismTextFilter {
+  PRISM_TEXT_FILTER_NONE = 0,
+  PRISM_TEXT_FILTER_STRIP_TAGS = (1U << 0),
+  PRISM_TEXT_FILTER_COLLAPSE_WHITESPACE = (1U << 1),
+  PRISM_TEXT_FILTER_STRIP_CONTROL = (1U << 2),
+  PRISM_TEXT_FILTER_DROP_EMPTY = (1U << 3)
+} PrismTextFilter;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
 typedef void(PRISM_CALL *PrismAudioCallback)(
     void *userdata, const float *PRISM_RESTRICT samples, size_t sample_count,
     size_t channels, size_t sample_rate);
 
+typedef uint64_t PrismUtteranceId;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 26812)
+#endif
+typedef enum PrismSpeechPriority {
+  PRISM_SPEECH_PRIORITY_IMPORTANT,
+  PRISM_SPEECH_PRIORITY_MESSAGE,
+  PRISM_SPEECH_PRIORITY_TEXT,
+  PRISM_SPEECH_PRIORITY_NOTIFICATION,
+  PRISM_SPEECH_PRIORITY_PROGRESS,
+  PRISM_SPEECH_PRIORITY_COUNT
+} PrismSpeechPriority;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+typedef void(PRISM_CALL *PrismCompletionCallback)(void *userdata,
+                                                  PrismUtteranceId utterance,
+                                                  PrismError result);
+
+typedef void(PRISM_CALL *PrismBackendReadyCallback)(void *userdata,
+                                                    PrismBackend *backend,
+                                                    PrismError result);
+
+typedef struct PrismUtterance {
+  const char *text;
+  size_t length;
+  uint32_t flags;
+  bool interrupt;
+} PrismUtterance;
+
+typedef struct PrismCoalescingStats {
+  uint64_t dropped;
+  uint64_t deduplicated;
+} PrismCoalescingStats;
+
+typedef struct PrismAudioCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t bytes;
+  size_t entries;
+} PrismAudioCacheStats;
+
+typedef struct PrismFailoverOptions {
+  size_t size;
+  uint32_t timeout_ms;
+  uint32_t hedge_ms;
+  uint32_t latency_threshold_ms;
+  uint32_t cooldown_ms;
+  float error_threshold;
+} PrismFailoverOptions;
+
+typedef struct PrismBackendHealth {
+  float error_rate;
+  float latency_ms;
+  uint64_t successes;
+  uint64_t failures;
+  bool circuit_open;
+} PrismBackendHealth;
+
+typedef struct PrismVoice {
+  const char *name;
+  const char *language;
+  size_t index;
+  uint64_t id;
+} PrismVoice;
+
+typedef struct PrismVoiceList {
+  size_t count;
+  const PrismVoice *voices;
+} PrismVoiceList;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 26812)
+#endif
+typedef enum PrismStatsOperation {
+  PRISM_STATS_INITIALIZE,
+  PRISM_STATS_SPEAK,
+  PRISM_STATS_SPEAK_TO_MEMORY,
+  PRISM_STATS_BRAILLE,
+  PRISM_STATS_OUTPUT,
+  PRISM_STATS_STOP,
+  PRISM_STATS_PAUSE,
+  PRISM_STATS_RESUME,
+  PRISM_STATS_IS_SPEAKING,
+  PRISM_STATS_SET_PARAMETER,
+  PRISM_STATS_GET_PARAMETER,
+  PRISM_STATS_VOICES,
+  PRISM_STATS_PROBE,
+  PRISM_STATS_OPERATION_COUNT
+} PrismStatsOperation;
+typedef enum PrismStatsLayer {
+  PRISM_STATS_LAYER_API,
+  PRISM_STATS_LAYER_ENGINE,
+  PRISM_STATS_LAYER_COUNT
+} PrismStatsLayer;
+typedef enum PrismVoiceQuery {
+  PRISM_VOICE_QUERY_NAME,
+  PRISM_VOICE_QUERY_LANGUAGE,
+  PRISM_VOICE_QUERY_COUNT
+} PrismVoiceQuery;
+typedef enum PrismParamFlags {
+  PRISM_PARAM_VOLUME = (1U << 0),
+  PRISM_PARAM_RATE = (1U << 1),
+  PRISM_PARAM_PITCH = (1U << 2),
+  PRISM_PARAM_VOICE = (1U << 3)
+} PrismParamFlags;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#define PRISM_STATS_BUCKET_COUNT 124
+
+typedef struct PrismLatencyHistogram {
+  uint64_t count;
+  uint64_t sum_us;
+  uint64_t buckets[PRISM_STATS_BUCKET_COUNT];
+} PrismLatencyHistogram;
+
+typedef struct PrismPhraseAudio {
+  const float *samples;
+  size_t frames;
+  size_t channels;
+  size_t sample_rate;
+} PrismPhraseAudio;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 26812)
+#endif
+typedef enum PrismMemoryFlags {
+  PRISM_MEMORY_DEFAULT = 0,
+  PRISM_MEMORY_INCREMENTAL = (1U << 0)
+} PrismMemoryFlags;
+typedef enum PrismSampleFormat {
+  PRISM_SAMPLE_FORMAT_F32,
+  PRISM_SAMPLE_FORMAT_S16,
+  PRISM_SAMPLE_FORMAT_S24,
+  PRISM_SAMPLE_FORMAT_COUNT
+} PrismSampleFormat;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+typedef struct PrismMemoryOptions {
+  size_t size;
+  uint32_t flags;
+  size_t max_chunk_frames;
+  PrismCancelToken *cancel;
+  uint32_t sample_format;
+  uint32_t channels;
+  uint32_t sample_rate;
+} PrismMemoryOptions;
+
+typedef void(PRISM_CALL *PrismPcmCallback)(void *userdata,
+                                           const void *PRISM_RESTRICT data,
+                                           size_t frames, size_t channels,
+                                           size_t sample_rate,
+                                           PrismSampleFormat format);
+
 typedef struct PrismBackendVTable {
   size_t size;
   void *(PRISM_CALL *create)(void *userdata);
@@ -182,6 +377,11 @@ typedef struct PrismBackendVTable {
   PrismError(PRISM_CALL *get_sample_rate)(void *instance,
                                           size_t *out_sample_rate);
   PrismError(PRISM_CALL *get_bit_depth)(void *instance, size_t *out_bit_depth);
+  PrismError(PRISM_CALL *speak_batch)(void *instance,
+                                      const PrismUtterance *items,
+                                      size_t count);
+  PrismError(PRISM_CALL *speak_ssml)(void *instance, const char *ssml,
+                                     bool interrupt);
 } PrismBackendVTable;
 
 #ifdef _MSC_VER
@@ -270,7 +470,8 @@ typedef const PrismPluginBackend *(PRISM_CALL *PrismPluginQueryFn)(
 #define PRISM_BACKEND_SYSTEM_ACCESS UINT64_C(0x8380F2A37B2C3EB6)
 #define PRISM_BACKEND_WINDOW_EYES UINT64_C(0x9120D89908785C13)
 #define PRISM_BACKEND_SPIEL UINT64_C(0x478B44F14AD3D89C)
-#define PRISM_CONFIG_VERSION 3
+#define PRISM_UTTERANCE_INVALID UINT64_C(0)
+#define PRISM_CONFIG_VERSION 5
 #define PRISM_PLUGIN_ABI_VERSION UINT64_C(1)
 
 #ifdef _MSC_VER
@@ -340,6 +541,27 @@ PRISM_API void PRISM_CALL prism_availability_poll_resume(PrismContext *ctx);
 PRISM_API PRISM_NODISCARD bool PRISM_CALL
 prism_availability_auto_power_supported(void);
 
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_audio_cache_get_stats(PrismContext *ctx,
+                                PrismAudioCacheStats *PRISM_RESTRICT out_stats);
+
+PRISM_API PRISM_NONNULL(1) void PRISM_CALL
+    prism_audio_cache_clear(PrismContext *ctx);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(4) PrismError PRISM_CALL
+    prism_stats_snapshot(PrismBackendId backend, PrismStatsOperation operation,
+                         PrismStatsLayer layer,
+                         PrismLatencyHistogram *PRISM_RESTRICT out_histogram);
+
+PRISM_API void PRISM_CALL prism_stats_reset(void);
+
+PRISM_API PRISM_NODISCARD uint64_t PRISM_CALL
+prism_stats_bucket_floor(size_t bucket);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) uint64_t PRISM_CALL
+    prism_stats_percentile(const PrismLatencyHistogram *histogram,
+                           double percentile);
+
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) size_t PRISM_CALL
     prism_registry_count(PrismContext *ctx);
 
@@ -374,6 +596,11 @@ PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismBackend *PRISM_CALL
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismBackend *PRISM_CALL
     prism_registry_acquire_best(PrismContext *ctx);
 
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_registry_acquire_best_async(PrismContext *ctx,
+                                      PrismBackendReadyCallback callback,
+                                      void *userdata);
+
 PRISM_API
 void PRISM_CALL prism_backend_free(PrismBackend *backend);
 
@@ -407,6 +634,211 @@ PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2)
     prism_backend_output(PrismBackend *backend, const char *PRISM_RESTRICT text,
                          bool interrupt);
 
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_speak_n(PrismBackend *backend,
+                          const char *PRISM_RESTRICT text, size_t length,
+                          bool interrupt, uint32_t flags);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 4) PrismError PRISM_CALL
+    prism_backend_speak_to_memory_n(PrismBackend *backend,
+                                    const char *PRISM_RESTRICT text,
+                                    size_t length, PrismAudioCallback callback,
+                                    void *userdata, uint32_t flags);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_braille_n(PrismBackend *backend,
+                            const char *PRISM_RESTRICT text, size_t length,
+                            uint32_t flags);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_output_n(PrismBackend *backend,
+                           const char *PRISM_RESTRICT text, size_t length,
+                           bool interrupt, uint32_t flags);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_speak_ssml(PrismBackend *backend,
+                             const char *PRISM_RESTRICT ssml, size_t length,
+                             bool interrupt, uint32_t flags);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_speak_batch(PrismBackend *backend,
+                              const PrismUtterance *PRISM_RESTRICT items,
+                              size_t count);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_speak_async(PrismBackend *backend,
+                              const char *PRISM_RESTRICT text, size_t length,
+                              bool interrupt, uint32_t flags,
+                              PrismCompletionCallback callback, void *userdata,
+                              PrismUtteranceId *PRISM_RESTRICT out_id);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_speak_prioritized(PrismBackend *backend,
+                                    const char *PRISM_RESTRICT text,
+                                    size_t length,
+                                    PrismSpeechPriority priority,
+                                    uint32_t flags,
+                                    PrismCompletionCallback callback,
+                                    void *userdata,
+                                    PrismUtteranceId *PRISM_RESTRICT out_id);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_wait(PrismBackend *backend, PrismUtteranceId utterance);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_set_coalescing(PrismBackend *backend, uint32_t window_ms);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_set_text_filters(PrismBackend *backend, uint32_t filters);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_set_segmentation(PrismBackend *backend,
+                                   size_t max_segment_bytes);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_feed_open(PrismBackend *backend, bool interrupt);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_feed_append(PrismBackend *backend,
+                              const char *PRISM_RESTRICT text, size_t length);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_feed_close(PrismBackend *backend);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_get_coalescing_stats(
+        PrismBackend *backend, PrismCoalescingStats *PRISM_RESTRICT out_stats);
+
+PRISM_API PRISM_NODISCARD PRISM_MALLOC PrismCancelToken *PRISM_CALL
+prism_cancel_token_new(void);
+
+PRISM_API PRISM_NONNULL(1) void PRISM_CALL
+    prism_cancel_token_cancel(PrismCancelToken *token);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) bool PRISM_CALL
+    prism_cancel_token_is_cancelled(const PrismCancelToken *token);
+
+PRISM_API void PRISM_CALL prism_cancel_token_free(PrismCancelToken *token);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 4, 7) PrismError PRISM_CALL
+    prism_backend_speak_to_memory_ex(PrismBackend *backend,
+                                     const char *PRISM_RESTRICT text,
+                                     size_t length, PrismAudioCallback callback,
+                                     void *userdata, uint32_t flags,
+                                     const PrismMemoryOptions *options);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 4, 7) PrismError PRISM_CALL
+    prism_backend_speak_to_memory_pcm(PrismBackend *backend,
+                                      const char *PRISM_RESTRICT text,
+                                      size_t length, PrismPcmCallback callback,
+                                      void *userdata, uint32_t flags,
+                                      const PrismMemoryOptions *options);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_prerender(PrismBackend *backend, const char *const *texts,
+                            size_t count, PrismSpeechPriority priority);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2)
+    PRISM_NULL_TERMINATED_STRING_ARG(2) PrismError PRISM_CALL
+    prism_backend_hint(PrismBackend *backend, const char *PRISM_RESTRICT text);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_cancel_hints(PrismBackend *backend);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 3) PrismError PRISM_CALL
+    prism_backend_group_new(PrismBackend *const *members, size_t count,
+                            PrismBackendGroup **PRISM_RESTRICT out_group);
+
+PRISM_API void PRISM_CALL prism_backend_group_free(PrismBackendGroup *group);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) size_t PRISM_CALL
+    prism_backend_group_count(PrismBackendGroup *group);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_group_speak(PrismBackendGroup *group,
+                              const char *PRISM_RESTRICT text, size_t length,
+                              bool interrupt, uint32_t flags,
+                              uint32_t timeout_ms, PrismError *out_results);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_group_output(PrismBackendGroup *group,
+                               const char *PRISM_RESTRICT text, size_t length,
+                               bool interrupt, uint32_t flags,
+                               uint32_t timeout_ms, PrismError *out_results);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_group_braille(PrismBackendGroup *group,
+                                const char *PRISM_RESTRICT text,
+                                size_t length, uint32_t flags,
+                                uint32_t timeout_ms, PrismError *out_results);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_group_stop(PrismBackendGroup *group, uint32_t timeout_ms,
+                             PrismError *out_results);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 4) PrismError PRISM_CALL
+    prism_failover_new(PrismBackend *const *members, size_t count,
+                       const PrismFailoverOptions *options,
+                       PrismFailover **PRISM_RESTRICT out_failover);
+
+PRISM_API void PRISM_CALL prism_failover_free(PrismFailover *failover);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) size_t PRISM_CALL
+    prism_failover_count(PrismFailover *failover);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_failover_speak(PrismFailover *failover,
+                         const char *PRISM_RESTRICT text, size_t length,
+                         bool interrupt, uint32_t flags, size_t *out_member);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_failover_output(PrismFailover *failover,
+                          const char *PRISM_RESTRICT text, size_t length,
+                          bool interrupt, uint32_t flags, size_t *out_member);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 3) PrismError PRISM_CALL
+    prism_failover_get_health(PrismFailover *failover, size_t index,
+                              PrismBackendHealth *PRISM_RESTRICT out_health);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 6) PrismError PRISM_CALL
+    prism_backend_open_stream(PrismBackend *backend,
+                              const char *PRISM_RESTRICT text, size_t length,
+                              uint32_t flags, size_t capacity_frames,
+                              PrismAudioStream **PRISM_RESTRICT out_stream);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 3) PrismError PRISM_CALL
+    prism_audio_stream_get_format(PrismAudioStream *stream,
+                                  size_t *PRISM_RESTRICT out_channels,
+                                  size_t *PRISM_RESTRICT out_sample_rate);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 5) PrismError PRISM_CALL
+    prism_audio_stream_read(PrismAudioStream *stream, float *PRISM_RESTRICT dst,
+                            size_t frames, bool wait,
+                            size_t *PRISM_RESTRICT out_frames);
+
+PRISM_API void PRISM_CALL prism_audio_stream_close(PrismAudioStream *stream);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 3)
+    PRISM_NULL_TERMINATED_STRING_ARG(2) PrismError PRISM_CALL
+    prism_backend_write_phrase_pack(PrismBackend *backend,
+                                    const char *PRISM_RESTRICT path,
+                                    const char *const *phrases, size_t count);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2)
+    PRISM_NULL_TERMINATED_STRING_ARG(1) PrismError PRISM_CALL
+    prism_phrase_pack_open(const char *PRISM_RESTRICT path,
+                           PrismPhrasePack **PRISM_RESTRICT out_pack);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) size_t PRISM_CALL
+    prism_phrase_pack_count(PrismPhrasePack *pack);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 4) bool PRISM_CALL
+    prism_phrase_pack_find(PrismPhrasePack *pack,
+                           const char *PRISM_RESTRICT text, size_t length,
+                           PrismPhraseAudio *PRISM_RESTRICT out_audio);
+
+PRISM_API void PRISM_CALL prism_phrase_pack_close(PrismPhrasePack *pack);
+
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
     prism_backend_stop(PrismBackend *backend);
 
@@ -429,6 +861,11 @@ PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
     prism_backend_set_pitch(PrismBackend *backend, float pitch);
 
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
+    prism_backend_set_params(PrismBackend *backend, uint32_t mask,
+                             float volume, float rate, float pitch,
+                             size_t voice_id);
+
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
     prism_backend_get_volume(PrismBackend *backend,
                              float *PRISM_RESTRICT out_volume);
@@ -456,6 +893,22 @@ PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 3) PrismError PRISM_CALL
     prism_backend_get_voice_language(PrismBackend *backend, size_t voice_id,
                                      const char **PRISM_RESTRICT out_language);
 
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2) PrismError PRISM_CALL
+    prism_backend_get_voices(PrismBackend *backend,
+                             PrismVoiceList **PRISM_RESTRICT out_list);
+
+PRISM_API void PRISM_CALL prism_voice_list_free(PrismVoiceList *list);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 2, 4) PrismError PRISM_CALL
+    prism_backend_find_voice(PrismBackend *backend,
+                             const char *PRISM_RESTRICT query,
+                             PrismVoiceQuery kind,
+                             size_t *PRISM_RESTRICT out_voice_id);
+
+PRISM_API PRISM_NODISCARD PRISM_NONNULL(1, 3) PrismError PRISM_CALL
+    prism_backend_find_voice_by_id(PrismBackend *backend, uint64_t id,
+                                   size_t *PRISM_RESTRICT out_voice_id);
+
 PRISM_API PRISM_NODISCARD PRISM_NONNULL(1) PrismError PRISM_CALL
     prism_backend_set_voice(PrismBackend *backend, size_t voice_id);
 
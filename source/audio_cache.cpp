@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "audio_cache.h"
+#include "utils.h"
+#include <cstring>
+#include <iterator>
+#include <new>
+
+namespace {
+// Roughly what a node costs besides its samples and key, so that a budget
+// full of short utterances is not wildly exceeded.
+constexpr std::size_t node_overhead = 128;
+
+template <typename T> void append_bytes(std::string &out, const T &value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.append(bytes, sizeof(T));
+}
+} // namespace
+
+void AudioCache::make_key(std::string &out, const AudioCacheParams &params,
+                          std::string_view text) {
+  out.clear();
+  append_bytes(out, params.backend);
+  append_bytes(out, params.voice);
+  append_bytes(out, params.rate);
+  append_bytes(out, params.pitch);
+  append_bytes(out, params.volume);
+  out.append(text);
+}
+
+std::shared_ptr<const AudioCache::Entry>
+AudioCache::find(std::string_view key) {
+  std::scoped_lock lock(mutex);
+  const auto it = index.find(key);
+  if (it == index.end()) {
+    ++counters.misses;
+    return nullptr;
+  }
+  ++counters.hits;
+  lru.splice(lru.begin(), lru, it->second);
+  return it->second->entry;
+}
+
+bool AudioCache::contains(std::string_view key) {
+  std::scoped_lock lock(mutex);
+  const auto it = index.find(key);
+  if (it == index.end())
+    return false;
+  lru.splice(lru.begin(), lru, it->second);
+  return true;
+}
+
+void AudioCache::insert(std::string_view key, std::vector<float> samples,
+                        std::size_t channels,
+                        std::size_t sample_rate) try {
+  const auto trimmed =
+      trim_silence_rms_gate_inplace(samples, channels, sample_rate);
+  if (trimmed.speech_detected) {
+    const auto first = trimmed.view.data() - samples.data();
+    samples.erase(samples.begin() + first + std::ssize(trimmed.view),
+                  samples.end());
+    samples.erase(samples.begin(), samples.begin() + first);
+  }
+  samples.shrink_to_fit();
+  const auto bytes =
+      (samples.size() * sizeof(float)) + key.size() + node_overhead;
+  if (bytes > budget)
+    return;
+  auto entry = std::make_shared<const Entry>(
+      Entry{.samples = std::move(samples),
+            .channels = channels,
+            .sample_rate = sample_rate});
+  std::scoped_lock lock(mutex);
+  if (index.contains(key))
+    return;
+  evict_to(budget - bytes);
+  lru.push_front(
+      Node{.key = std::string{key}, .entry = std::move(entry), .bytes = bytes});
+  try {
+    index.emplace(lru.front().key, lru.begin());
+  } catch (...) {
+    lru.pop_front();
+    throw;
+  }
+  counters.bytes += bytes;
+  ++counters.entries;
+} catch (const std::bad_alloc &) {
+  // Caching is best effort; the caller already has its audio.
+}
+
+void AudioCache::evict_to(std::size_t bytes) {
+  while (counters.bytes > bytes && !lru.empty()) {
+    const auto &victim = lru.back();
+    counters.bytes -= victim.bytes;
+    --counters.entries;
+    ++counters.evictions;
+    index.erase(victim.key);
+    lru.pop_back();
+  }
+}
+
+AudioCache::Stats AudioCache::stats() {
+  std::scoped_lock lock(mutex);
+  return counters;
+}
+
+void AudioCache::clear() {
+  std::scoped_lock lock(mutex);
+  index.clear();
+  lru.clear();
+  counters.bytes = 0;
+  counters.entries = 0;
+}
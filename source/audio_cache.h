@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend_catalog.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Everything besides the text that changes what an engine renders. Settings a
+// backend cannot report are left at their defaults.
+struct AudioCacheParams {
+  BackendId backend{};
+  std::size_t voice = SIZE_MAX;
+  float rate = -1.0F;
+  float pitch = -1.0F;
+  float volume = -1.0F;
+};
+
+// Rendered utterances shared by every backend of a context, evicted least
+// recently used first once they exceed the byte budget. Entries are immutable
+// and reference counted, so a hit is played back without holding the lock.
+class AudioCache {
+public:
+  struct Entry {
+    std::vector<float> samples;
+    std::size_t channels;
+    std::size_t sample_rate;
+  };
+  struct Stats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    std::size_t bytes;
+    std::size_t entries;
+  };
+
+private:
+  struct Node {
+    std::string key;
+    std::shared_ptr<const Entry> entry;
+    std::size_t bytes;
+  };
+
+  std::size_t budget;
+  std::mutex mutex;
+  // Most recently used first. The index points into the node's own key.
+  std::list<Node> lru;
+  std::unordered_map<std::string_view, std::list<Node>::iterator> index;
+  Stats counters{};
+
+  void evict_to(std::size_t bytes);
+
+public:
+  explicit AudioCache(std::size_t budget) : budget(budget) {}
+  static void make_key(std::string &out, const AudioCacheParams &params,
+                       std::string_view text);
+  std::shared_ptr<const Entry> find(std::string_view key);
+  // Like find, but for callers that only want to know whether rendering
+  // can be skipped; counts neither a hit nor a miss.
+  [[nodiscard]] bool contains(std::string_view key);
+  void insert(std::string_view key, std::vector<float> samples,
+              std::size_t channels, std::size_t sample_rate);
+  [[nodiscard]] Stats stats();
+  void clear();
+};
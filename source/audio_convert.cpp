@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "audio_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <numbers>
+
+void resample_linear(std::span<const float> in, double start, double step,
+                     std::span<float> out);
+void quantize_s16(std::span<const float> in, std::span<std::int16_t> out);
+void quantize_s24(std::span<const float> in, std::span<std::uint8_t> out);
+
+std::size_t AudioConverter::out_channels() const noexcept {
+  return target.channels != 0 ? target.channels : source_channels;
+}
+
+std::size_t AudioConverter::out_rate() const noexcept {
+  return target.sample_rate != 0 ? target.sample_rate : source_rate;
+}
+
+void AudioConverter::design_lowpass() {
+  // Bilinear-transform sections with the Q of a fourth-order Butterworth,
+  // cut off a little short of the output's Nyquist frequency.
+  constexpr std::array<double, 2> q{0.54119610, 1.30656296};
+  const double cutoff = 0.45 * static_cast<double>(out_rate()) /
+                        static_cast<double>(source_rate);
+  const double w = 2.0 * std::numbers::pi * cutoff;
+  const double cos_w = std::cos(w);
+  for (std::size_t i = 0; i < lowpass.size(); ++i) {
+    const double alpha = std::sin(w) / (2.0 * q[i]);
+    const double a0 = 1.0 + alpha;
+    const double b = (1.0 - cos_w) / 2.0 / a0;
+    lowpass[i] = Biquad{.b0 = static_cast<float>(b),
+                        .b1 = static_cast<float>(2.0 * b),
+                        .b2 = static_cast<float>(b),
+                        .a1 = static_cast<float>(-2.0 * cos_w / a0),
+                        .a2 = static_cast<float>((1.0 - alpha) / a0)};
+  }
+  filter_state.assign(out_channels() * lowpass.size() * 2, 0.0F);
+}
+
+void AudioConverter::filter(std::span<float> frames) {
+  const auto ch = out_channels();
+  const auto count = frames.size() / ch;
+  for (std::size_t c = 0; c < ch; ++c) {
+    for (std::size_t s = 0; s < lowpass.size(); ++s) {
+      const auto &f = lowpass[s];
+      float *z = filter_state.data() + (((c * lowpass.size()) + s) * 2);
+      for (std::size_t i = 0; i < count; ++i) {
+        float &x = frames[(i * ch) + c];
+        const float y = (f.b0 * x) + z[0];
+        z[0] = (f.b1 * x) - (f.a1 * y) + z[1];
+        z[1] = (f.b2 * x) - (f.a2 * y);
+        x = y;
+      }
+    }
+  }
+}
+
+void AudioConverter::remix(std::span<const float> in, std::size_t channels) {
+  const auto ch = out_channels();
+  const auto frames = in.size() / channels;
+  // The frame the resampler carried over from the last chunk stays in front.
+  const std::size_t kept = carrying ? ch : 0;
+  mixed.resize(kept + (frames * ch));
+  float *out = mixed.data() + kept;
+  if (ch == channels) {
+    std::ranges::copy(in.first(frames * ch), out);
+  } else if (ch == 1) {
+    const auto scale = 1.0F / static_cast<float>(channels);
+    for (std::size_t f = 0; f < frames; ++f) {
+      float sum = 0.0F;
+      for (std::size_t c = 0; c < channels; ++c)
+        sum += in[(f * channels) + c];
+      out[f] = sum * scale;
+    }
+  } else {
+    for (std::size_t f = 0; f < frames; ++f)
+      for (std::size_t c = 0; c < ch; ++c)
+        out[(f * ch) + c] = in[(f * channels) + (c % channels)];
+  }
+  if (!filter_state.empty())
+    filter({out, frames * ch});
+}
+
+std::span<const float> AudioConverter::resample() {
+  const auto ch = out_channels();
+  const auto frames = mixed.size() / ch;
+  if (frames == 0)
+    return {};
+  const double step =
+      static_cast<double>(source_rate) / static_cast<double>(out_rate());
+  const auto last = static_cast<double>(frames - 1);
+  std::size_t count = 0;
+  if (phase < last) {
+    count = static_cast<std::size_t>(std::ceil((last - phase) / step));
+    if (count != 0 &&
+        phase + (static_cast<double>(count - 1) * step) >= last)
+      --count;
+  }
+  resampled.resize(count * ch);
+  if (ch == 1) {
+    resample_linear(mixed, phase, step, resampled);
+  } else {
+    plane.resize(frames);
+    plane_out.resize(count);
+    for (std::size_t c = 0; c < ch; ++c) {
+      for (std::size_t f = 0; f < frames; ++f)
+        plane[f] = mixed[(f * ch) + c];
+      resample_linear(plane, phase, step, plane_out);
+      for (std::size_t j = 0; j < count; ++j)
+        resampled[(j * ch) + c] = plane_out[j];
+    }
+  }
+  phase += (static_cast<double>(count) * step) - last;
+  std::copy_n(mixed.end() - static_cast<std::ptrdiff_t>(ch), ch,
+              mixed.begin());
+  mixed.resize(ch);
+  carrying = true;
+  return resampled;
+}
+
+BackendResult<ConvertedChunk>
+AudioConverter::convert(std::span<const float> in, std::size_t channels,
+                        std::size_t sample_rate) try {
+  if (channels == 0 || sample_rate == 0)
+    return std::unexpected(BackendError::InvalidAudioFormat);
+  if (source_channels == 0) {
+    source_channels = channels;
+    source_rate = sample_rate;
+    if (out_rate() < source_rate)
+      design_lowpass();
+  } else if (channels != source_channels || sample_rate != source_rate) {
+    return std::unexpected(BackendError::InvalidAudioFormat);
+  }
+  const auto ch = out_channels();
+  const auto rate = out_rate();
+  std::span<const float> samples = in.first(in.size() / channels * channels);
+  if (ch != channels || rate != sample_rate) {
+    remix(samples, channels);
+    samples = rate == sample_rate ? std::span<const float>{mixed} : resample();
+  }
+  const auto frames = samples.size() / ch;
+  switch (target.format) {
+  case SampleFormat::S16:
+    pcm16.resize(samples.size());
+    quantize_s16(samples, pcm16);
+    return ConvertedChunk{.data = pcm16.data(),
+                          .frames = frames,
+                          .channels = ch,
+                          .sample_rate = rate};
+  case SampleFormat::S24:
+    pcm24.resize(samples.size() * 3);
+    quantize_s24(samples, pcm24);
+    return ConvertedChunk{.data = pcm24.data(),
+                          .frames = frames,
+                          .channels = ch,
+                          .sample_rate = rate};
+  case SampleFormat::F32:
+    break;
+  }
+  return ConvertedChunk{.data = samples.data(),
+                        .frames = frames,
+                        .channels = ch,
+                        .sample_rate = rate};
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+}
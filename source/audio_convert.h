@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class SampleFormat : std::uint8_t { F32, S16, S24 };
+
+[[nodiscard]] constexpr std::size_t
+bytes_per_sample(SampleFormat format) noexcept {
+  switch (format) {
+  case SampleFormat::S16:
+    return 2;
+  case SampleFormat::S24:
+    return 3;
+  case SampleFormat::F32:
+    break;
+  }
+  return 4;
+}
+
+// Zero means "whatever the engine produces".
+struct AudioFormat {
+  SampleFormat format = SampleFormat::F32;
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+};
+
+struct ConvertedChunk {
+  const void *data;
+  std::size_t frames;
+  std::size_t channels;
+  std::size_t sample_rate;
+};
+
+// Turns the float chunks of one utterance into the caller's format. Chunks
+// must keep the format of the first one, because the resampler carries one
+// frame and its phase across chunk boundaries. The returned chunk points
+// into the converter and is valid until the next call.
+//
+// Downsampling runs the mixed audio through a fourth-order Butterworth
+// low-pass just below the new Nyquist frequency first, since linear
+// interpolation alone would fold everything above it back into the band.
+class AudioConverter {
+  // One second-order section, in transposed direct form II.
+  struct Biquad {
+    float b0, b1, b2, a1, a2;
+  };
+
+  AudioFormat target;
+  std::size_t source_channels = 0;
+  std::size_t source_rate = 0;
+  double phase = 0.0;
+  bool carrying = false;
+  std::array<Biquad, 2> lowpass{};
+  // Two delay elements per section per channel; empty when not downsampling.
+  std::vector<float> filter_state;
+  std::vector<float> mixed;
+  std::vector<float> plane;
+  std::vector<float> plane_out;
+  std::vector<float> resampled;
+  std::vector<std::int16_t> pcm16;
+  std::vector<std::uint8_t> pcm24;
+
+  [[nodiscard]] std::size_t out_channels() const noexcept;
+  [[nodiscard]] std::size_t out_rate() const noexcept;
+  void design_lowpass();
+  void remix(std::span<const float> in, std::size_t channels);
+  void filter(std::span<float> frames);
+  [[nodiscard]] std::span<const float> resample();
+
+public:
+  explicit AudioConverter(AudioFormat target) : target(target) {}
+  BackendResult<ConvertedChunk> convert(std::span<const float> in,
+                                        std::size_t channels,
+                                        std::size_t sample_rate);
+};
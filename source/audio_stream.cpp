@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "audio_stream.h"
+#include "utterance_worker.h"
+#include <algorithm>
+#include <bit>
+#include <new>
+#ifdef _WIN32
+#include <objbase.h>
+#endif
+
+AudioStream::AudioStream(std::shared_ptr<TextToSpeechBackend> backend,
+                         UtteranceWorker &worker, std::string_view text,
+                         std::size_t capacity_frames)
+    : backend(std::move(backend)), worker(worker), text(text),
+      capacity_frames(capacity_frames) {
+  hook = worker.add_contention_hook([this] {
+    if (rendering.load(std::memory_order_acquire))
+      cancel();
+  });
+  try {
+    producer =
+        std::jthread([this](const std::stop_token &stop) { run(stop); });
+  } catch (...) {
+    worker.remove_contention_hook(hook);
+    throw;
+  }
+}
+
+AudioStream::~AudioStream() {
+  worker.remove_contention_hook(hook);
+  cancel();
+  if (producer.joinable())
+    producer.join();
+}
+
+void AudioStream::run(const std::stop_token &stop) {
+#ifdef _WIN32
+  const bool com_ok = SUCCEEDED(
+      CoInitializeEx(nullptr, COINIT_MULTITHREADED | COINIT_SPEED_OVER_MEMORY));
+#endif
+  BackendResult<> r;
+  {
+    const auto guard = worker.lock_backend();
+    rendering.store(true, std::memory_order_release);
+    if (!stop.stop_requested())
+      r = backend->speak_to_memory_ex(
+          text,
+          [this](void *, const float *samples, std::size_t count,
+                 std::size_t ch, std::size_t sr) {
+            deliver({samples, count}, ch, sr);
+          },
+          nullptr, MemoryOptions{.incremental = true, .cancel = stop});
+    rendering.store(false, std::memory_order_release);
+  }
+  if (r && failure == BackendError::Ok)
+    drain(stop);
+  if (stop.stop_requested())
+    result = BackendError::Cancelled;
+  else if (!r)
+    result = r.error();
+  else
+    result = failure;
+  overflow = {};
+#ifdef _WIN32
+  if (com_ok)
+    CoUninitialize();
+#endif
+  state.store(State::Finished, std::memory_order_release);
+  signal_consumer();
+}
+
+bool AudioStream::start(std::size_t ch, std::size_t sr) {
+  if (ch == 0 || sr == 0) {
+    failure = BackendError::InvalidAudioFormat;
+    return false;
+  }
+  const auto samples =
+      std::bit_ceil(std::max<std::size_t>(capacity_frames * ch, ch));
+  ring.reset(new (std::nothrow) float[samples]);
+  if (!ring) {
+    failure = BackendError::MemoryFailure;
+    return false;
+  }
+  mask = samples - 1;
+  channels = ch;
+  sample_rate = sr;
+  state.store(State::Streaming, std::memory_order_release);
+  signal_consumer();
+  return true;
+}
+
+// Runs inside the engine's callback, with the backend held, so it never
+// waits: what does not fit in the ring goes to the overflow, and once
+// anything has, everything after it does too.
+void AudioStream::deliver(std::span<const float> samples, std::size_t ch,
+                          std::size_t sr) {
+  if (failure != BackendError::Ok)
+    return;
+  if (state.load(std::memory_order_relaxed) == State::Starting) {
+    if (!start(ch, sr))
+      return;
+  } else if (ch != channels || sr != sample_rate) {
+    failure = BackendError::InvalidAudioFormat;
+    return;
+  }
+  if (overflow_at == overflow.size()) {
+    overflow.clear();
+    overflow_at = 0;
+    samples = samples.subspan(write(samples));
+  }
+  if (samples.empty())
+    return;
+  try {
+    overflow.insert(overflow.end(), samples.begin(), samples.end());
+  } catch (const std::bad_alloc &) {
+    failure = BackendError::MemoryFailure;
+  }
+}
+
+// Moves the overflow into the ring as the reader makes room, after the
+// backend has been released.
+void AudioStream::drain(const std::stop_token &stop) {
+  while (overflow_at != overflow.size()) {
+    const auto seen = consumed.load(std::memory_order_acquire);
+    const auto n = write(std::span{overflow}.subspan(overflow_at));
+    if (n != 0) {
+      overflow_at += n;
+      continue;
+    }
+    if (stop.stop_requested())
+      return;
+    consumed.wait(seen, std::memory_order_acquire);
+  }
+}
+
+// Copies as much of `samples` as the ring has room for.
+std::size_t AudioStream::write(std::span<const float> samples) {
+  const std::size_t size = mask + 1;
+  const auto h = head.load(std::memory_order_relaxed);
+  const auto t = tail.load(std::memory_order_acquire);
+  const auto n = std::min(size - (h - t), samples.size());
+  if (n == 0)
+    return 0;
+  const auto at = h & mask;
+  const auto first = std::min(n, size - at);
+  std::ranges::copy(samples.first(first), ring.get() + at);
+  std::ranges::copy(samples.subspan(first, n - first), ring.get());
+  head.store(h + n, std::memory_order_release);
+  signal_consumer();
+  return n;
+}
+
+void AudioStream::cancel() noexcept {
+  producer.request_stop();
+  signal_producer();
+}
+
+void AudioStream::signal_consumer() noexcept {
+  produced.fetch_add(1, std::memory_order_release);
+  produced.notify_all();
+}
+
+void AudioStream::signal_producer() noexcept {
+  consumed.fetch_add(1, std::memory_order_release);
+  consumed.notify_all();
+}
+
+BackendResult<std::pair<std::size_t, std::size_t>> AudioStream::format() {
+  while (true) {
+    const auto seen = produced.load(std::memory_order_acquire);
+    const auto s = state.load(std::memory_order_acquire);
+    if (s == State::Starting) {
+      produced.wait(seen, std::memory_order_acquire);
+      continue;
+    }
+    if (channels == 0 && result != BackendError::Ok)
+      return std::unexpected(result);
+    return std::pair{channels, sample_rate};
+  }
+}
+
+BackendResult<std::size_t> AudioStream::read(float *dst, std::size_t frames,
+                                             bool wait) {
+  std::size_t done = 0;
+  while (true) {
+    const auto seen = produced.load(std::memory_order_acquire);
+    const auto s = state.load(std::memory_order_acquire);
+    if (s != State::Starting && channels != 0) {
+      // Once Finished has been observed this load sees every sample the
+      // producer will ever write.
+      const auto want = frames * channels;
+      const auto h = head.load(std::memory_order_acquire);
+      const auto t = tail.load(std::memory_order_relaxed);
+      const auto available = (h - t) / channels * channels;
+      const auto n = std::min(available, want - done);
+      if (n != 0) {
+        const std::size_t size = mask + 1;
+        const auto at = t & mask;
+        const auto first = std::min(n, size - at);
+        std::copy_n(ring.get() + at, first, dst + done);
+        std::copy_n(ring.get(), n - first, dst + done + first);
+        tail.store(t + n, std::memory_order_release);
+        signal_producer();
+        done += n;
+      }
+      if (done == want || (done != 0 && !wait))
+        return done / channels;
+    }
+    if (s == State::Finished) {
+      if (done == 0 && result != BackendError::Ok)
+        return std::unexpected(result);
+      return channels == 0 ? 0 : done / channels;
+    }
+    if (!wait)
+      return std::size_t{0};
+    produced.wait(seen, std::memory_order_acquire);
+  }
+}
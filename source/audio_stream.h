@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "logging.h"
+#include "utterance_worker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Renders one utterance on a producer thread into a fixed single-producer
+// single-consumer ring that the application drains at its own pace. Only the
+// producer writes `head` and only the consumer writes `tail`; both are
+// free-running and masked on access. The ring is allocated once, when the
+// first chunk reveals the channel count, and never grows.
+//
+// The producer never waits for the reader while it holds the backend: audio
+// that does not fit while the engine is rendering is kept in `overflow` and
+// moved into the ring once the backend has been released. Anything else about
+// to wait for the backend cuts the render short.
+class AudioStream {
+  enum class State : std::uint8_t { Starting, Streaming, Finished };
+  // Fixed rather than std::hardware_destructive_interference_size, whose value
+  // follows -mtune and so would change this class's layout between builds.
+  static constexpr std::size_t cache_line = 64;
+
+  std::shared_ptr<TextToSpeechBackend> backend;
+  UtteranceWorker &worker;
+  UtteranceWorker::HookId hook = 0;
+  std::string text;
+  std::size_t capacity_frames;
+  std::unique_ptr<float[]> ring;
+  // Producer only.
+  std::vector<float> overflow;
+  std::size_t overflow_at = 0;
+  std::size_t mask = 0;
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+  BackendError failure = BackendError::Ok;
+  BackendError result = BackendError::Ok;
+  alignas(cache_line) std::atomic_size_t head{0};
+  alignas(cache_line) std::atomic_size_t tail{0};
+  // Bumped whenever the other side may have something new to look at, so
+  // each side can block in atomic wait without missing a wakeup.
+  alignas(cache_line) std::atomic_uint32_t produced{0};
+  alignas(cache_line) std::atomic_uint32_t consumed{0};
+  std::atomic<State> state{State::Starting};
+  // Set while the producer holds the backend.
+  std::atomic_bool rendering{false};
+  std::jthread producer;
+
+  void run(const std::stop_token &stop);
+  void deliver(std::span<const float> samples, std::size_t ch, std::size_t sr);
+  void drain(const std::stop_token &stop);
+  std::size_t write(std::span<const float> samples);
+  bool start(std::size_t ch, std::size_t sr);
+  void signal_consumer() noexcept;
+  void signal_producer() noexcept;
+
+public:
+  AudioStream(std::shared_ptr<TextToSpeechBackend> backend,
+              UtteranceWorker &worker, std::string_view text,
+              std::size_t capacity_frames);
+  ~AudioStream();
+  AudioStream(const AudioStream &) = delete;
+  AudioStream &operator=(const AudioStream &) = delete;
+  AudioStream(AudioStream &&) = delete;
+  AudioStream &operator=(AudioStream &&) = delete;
+  BackendResult<std::pair<std::size_t, std::size_t>> format();
+  BackendResult<std::size_t> read(float *dst, std::size_t frames, bool wait);
+  // Stops rendering and ends the stream with Cancelled once the reader has
+  // taken what is already in the ring.
+  void cancel() noexcept;
+};
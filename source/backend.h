@@ -1,13 +1,21 @@
 // SPDX-License-Identifier: MPL-2.0
 
 #pragma once
+#include <atomic>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 #ifdef __ANDROID__
 #include <jni.h>
 #endif
@@ -39,7 +47,10 @@ enum class BackendError : std::uint8_t {
   BackendEnteredUndefinedState,
   LibraryLoadFailed,
   LibraryInvalid,
-  IncompatibleAbi
+  IncompatibleAbi,
+  Cancelled,
+  IoFailure,
+  TimedOut
 };
 
 template <typename T = void>
@@ -85,13 +96,124 @@ inline constexpr auto KNOWN =
     SUPPORTS_GET_VOICE_LANGUAGE | SUPPORTS_GET_VOICE | SUPPORTS_SET_VOICE |
     SUPPORTS_GET_CHANNELS | SUPPORTS_GET_SAMPLE_RATE | SUPPORTS_GET_BIT_DEPTH |
     PERFORMS_SILENCE_TRIMMING_ON_SPEAK |
-    PERFORMS_SILENCE_TRIMMING_ON_SPEAK_TO_MEMORY;
-static_assert((KNOWN & SUPPORTS_SPEAK_SSML) == 0);
+    PERFORMS_SILENCE_TRIMMING_ON_SPEAK_TO_MEMORY | SUPPORTS_SPEAK_SSML;
 static_assert((KNOWN & SUPPORTS_SPEAK_TO_MEMORY_SSML) == 0);
 static_assert((KNOWN & (1ULL << 1)) == 0, "bit 1 has never been assigned");
 } // namespace BackendFeature
 
+enum class SpeechPriority : std::uint8_t {
+  Important,
+  Message,
+  Text,
+  Notification,
+  Progress,
+};
+
+struct Utterance {
+  std::string_view text;
+  bool interrupt;
+};
+
+struct MemoryOptions {
+  bool incremental = false;
+  std::stop_token cancel;
+};
+
+// Parameters to change in one go; those left empty keep their value.
+struct VoiceParams {
+  std::optional<float> volume;
+  std::optional<float> rate;
+  std::optional<float> pitch;
+  std::optional<std::size_t> voice;
+};
+
+// Every voice of a backend in index order. The strings share one buffer,
+// each followed by a NUL, so the list can be handed out as one allocation.
+class VoiceList {
+public:
+  struct Entry {
+    std::size_t name;
+    std::size_t language;
+  };
+
+private:
+  std::string text;
+  std::vector<Entry> entries;
+
+  std::size_t append(std::initializer_list<std::string_view> parts) {
+    const auto offset = text.size();
+    for (const auto part : parts)
+      text.append(part);
+    text.push_back('\0');
+    return offset;
+  }
+
+public:
+  void reserve(std::size_t voices) { entries.reserve(voices); }
+  // The name is the concatenation of `name`, for backends that compose it.
+  void add(std::initializer_list<std::string_view> name,
+           std::string_view language) {
+    const auto n = append(name);
+    entries.push_back({.name = n, .language = append({language})});
+  }
+  void add(std::string_view name, std::string_view language) {
+    add({name}, language);
+  }
+  [[nodiscard]] std::size_t size() const noexcept { return entries.size(); }
+  [[nodiscard]] const std::string &strings() const noexcept { return text; }
+  [[nodiscard]] const Entry &operator[](std::size_t i) const noexcept {
+    return entries[i];
+  }
+  [[nodiscard]] std::string_view name(std::size_t i) const noexcept {
+    return text.c_str() + entries[i].name;
+  }
+  [[nodiscard]] std::string_view language(std::size_t i) const noexcept {
+    return text.c_str() + entries[i].language;
+  }
+  // Survives refreshes that reorder the voices, unlike the index.
+  [[nodiscard]] static constexpr std::uint64_t
+  stable_id(std::string_view name, std::string_view language) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325;
+    const auto mix = [&hash](std::string_view s) {
+      for (const char c : s) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001B3;
+      }
+    };
+    mix(name);
+    mix({"", 1});
+    mix(language);
+    return hash;
+  }
+};
+
+// The parameters the core last set or read on one backend instance, shared
+// by every handle to it. `generation` moves on whenever the copy is dropped,
+// so a value read from the engine before that is not stored after it.
+struct ParamShadow {
+  std::mutex mutex;
+  // As the engine last reported them.
+  VoiceParams known;
+  // As last set. Engines may round what they are given, so these only let
+  // the same value be skipped when it is set again; the getters ask the
+  // engine once after every set.
+  VoiceParams requested;
+  std::uint64_t generation = 0;
+
+  void forget() {
+    std::scoped_lock lock(mutex);
+    known = {};
+    requested = {};
+    ++generation;
+  }
+};
+
+// Text handed to the speech entry points is valid UTF-8 and the view is always
+// followed by a NUL byte, so text.data() may be passed to C APIs directly.
 class TextToSpeechBackend {
+  ParamShadow shadow;
+  std::atomic<std::uint64_t> voices_generation{0};
+
 #ifdef __ANDROID__
 protected:
   JavaVM *java_vm{nullptr};
@@ -113,12 +235,48 @@ public:
                                 [[maybe_unused]] bool interrupt) {
     return std::unexpected(BackendError::NotImplemented);
   }
+  // Backends whose engine schedules by priority itself report true here; the
+  // core then leaves preemption between classes to the engine.
+  [[nodiscard]] virtual bool has_native_priorities() const { return false; }
+  // The longest text, in bytes, the engine reliably speaks in one call, or 0
+  // for no limit. Segmented speech never hands it a longer segment.
+  [[nodiscard]] virtual std::size_t max_text_bytes() const { return 0; }
+  virtual BackendResult<>
+  speak_with_priority(std::string_view text,
+                      [[maybe_unused]] SpeechPriority priority,
+                      bool interrupt) {
+    return speak(text, interrupt);
+  }
+  // Backends reporting SUPPORTS_SPEAK_SSML take the document as it is; the
+  // core reduces it to plain text for the rest.
+  virtual BackendResult<> speak_ssml([[maybe_unused]] std::string_view ssml,
+                                     [[maybe_unused]] bool interrupt) {
+    return std::unexpected(BackendError::NotImplemented);
+  }
+  virtual BackendResult<> speak_batch(std::span<const Utterance> items) {
+    for (const auto &item : items)
+      if (const auto r = speak(item.text, item.interrupt); !r)
+        return r;
+    return {};
+  }
   virtual BackendResult<>
   speak_to_memory([[maybe_unused]] std::string_view text,
                   [[maybe_unused]] AudioCallback callback,
                   [[maybe_unused]] void *userdata) {
     return std::unexpected(BackendError::NotImplemented);
   }
+  // Backends that can hand audio over while the engine is still producing it,
+  // or abort the engine part way through, override this. The core splits
+  // chunks and stops forwarding them once cancelled either way.
+  virtual BackendResult<>
+  speak_to_memory_ex(std::string_view text, AudioCallback callback,
+                     void *userdata,
+                     [[maybe_unused]] const MemoryOptions &options) {
+    return speak_to_memory(text, std::move(callback), userdata);
+  }
+  // True for backends whose speak_to_memory_ex aborts the engine itself once
+  // options.cancel is stopped, instead of letting it run to the end.
+  [[nodiscard]] virtual bool cancels_memory_synthesis() const { return false; }
   virtual BackendResult<> braille([[maybe_unused]] std::string_view text) {
     return std::unexpected(BackendError::NotImplemented);
   }
@@ -156,6 +314,42 @@ public:
   virtual BackendResult<float> get_pitch() {
     return std::unexpected(BackendError::NotImplemented);
   }
+  // Backends that can apply several parameters under one lock or in one
+  // round trip override this. The voice goes first, since some engines reset
+  // the other parameters when it changes.
+  virtual BackendResult<> set_params(const VoiceParams &params) {
+    if (params.voice)
+      if (const auto r = set_voice(*params.voice); !r)
+        return r;
+    if (params.volume)
+      if (const auto r = set_volume(*params.volume); !r)
+        return r;
+    if (params.rate)
+      if (const auto r = set_rate(*params.rate); !r)
+        return r;
+    if (params.pitch)
+      if (const auto r = set_pitch(*params.pitch); !r)
+        return r;
+    return {};
+  }
+  // The core serves the parameter getters from the values last read, asking
+  // the engine again after every set since engines may round what they are
+  // given. Backends whose parameters can change behind Prism's back, such as
+  // those speaking through a screen reader, return false to always be asked.
+  // Backends that own them but learn the engine has reset them anyway, say
+  // after reconnecting to it or when its voices change, call
+  // param_shadow().forget().
+  [[nodiscard]] virtual bool owns_params() const { return true; }
+  [[nodiscard]] ParamShadow &param_shadow() noexcept { return shadow; }
+  // Bumped whenever the voice list may have changed, so that lookups built
+  // over an earlier list are rebuilt. Backends whose engine adds, removes or
+  // renumbers voices on its own call voices_changed() when it does.
+  void voices_changed() noexcept {
+    voices_generation.fetch_add(1, std::memory_order_acq_rel);
+  }
+  [[nodiscard]] std::uint64_t voice_generation() const noexcept {
+    return voices_generation.load(std::memory_order_acquire);
+  }
   virtual BackendResult<> refresh_voices() {
     return std::unexpected(BackendError::NotImplemented);
   }
@@ -170,6 +364,24 @@ public:
   get_voice_language([[maybe_unused]] std::size_t id) {
     return std::unexpected(BackendError::NotImplemented);
   }
+  // Backends whose voices sit behind a lock or a round trip override this to
+  // collect them in one go.
+  virtual BackendResult<> get_voices(VoiceList &out) {
+    const auto count = count_voices();
+    if (!count)
+      return std::unexpected(count.error());
+    out.reserve(*count);
+    for (std::size_t i = 0; i < *count; ++i) {
+      const auto name = get_voice_name(i);
+      if (!name)
+        return std::unexpected(name.error());
+      const auto language = get_voice_language(i);
+      if (!language)
+        return std::unexpected(language.error());
+      out.add(*name, *language);
+    }
+    return {};
+  }
   virtual BackendResult<> set_voice([[maybe_unused]] std::size_t id) {
     return std::unexpected(BackendError::NotImplemented);
   }
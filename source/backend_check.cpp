@@ -3,6 +3,7 @@
 #include "backend_catalog.h"
 #include <cstdint>
 #include <prism.h>
+#include <utility>
 
 #define U64(x) static_cast<std::uint64_t>(x)
 #define CHECK(macro, backend_const)                                            \
@@ -64,6 +65,19 @@ CHECK_ERROR(BackendEnteredUndefinedState,
 CHECK_ERROR(LibraryLoadFailed, PRISM_ERROR_LIBRARY_LOAD_FAILED);
 CHECK_ERROR(LibraryInvalid, PRISM_ERROR_LIBRARY_INVALID);
 CHECK_ERROR(IncompatibleAbi, PRISM_ERROR_INCOMPATIBLE_ABI);
+CHECK_ERROR(Cancelled, PRISM_ERROR_CANCELLED);
+CHECK_ERROR(IoFailure, PRISM_ERROR_IO_FAILURE);
+CHECK_ERROR(TimedOut, PRISM_ERROR_TIMED_OUT);
+static_assert(std::to_underlying(SpeechPriority::Important) ==
+              PRISM_SPEECH_PRIORITY_IMPORTANT);
+static_assert(std::to_underlying(SpeechPriority::Message) ==
+              PRISM_SPEECH_PRIORITY_MESSAGE);
+static_assert(std::to_underlying(SpeechPriority::Text) ==
+              PRISM_SPEECH_PRIORITY_TEXT);
+static_assert(std::to_underlying(SpeechPriority::Notification) ==
+              PRISM_SPEECH_PRIORITY_NOTIFICATION);
+static_assert(std::to_underlying(SpeechPriority::Progress) ==
+              PRISM_SPEECH_PRIORITY_PROGRESS);
 CHECK_FEATURE(IS_SUPPORTED_AT_RUNTIME, PRISM_BACKEND_IS_SUPPORTED_AT_RUNTIME);
 CHECK_FEATURE(SUPPORTS_SPEAK, PRISM_BACKEND_SUPPORTS_SPEAK);
 CHECK_FEATURE(SUPPORTS_SPEAK_TO_MEMORY, PRISM_BACKEND_SUPPORTS_SPEAK_TO_MEMORY);
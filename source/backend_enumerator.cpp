@@ -2,6 +2,8 @@
 
 #include "backend_enumerator.h"
 #include "backend.h"
+#include "latency_stats.h"
+#include "trace.h"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -43,6 +45,8 @@ BackendEnumerator::BackendEnumerator(FrozenRegistry *registry,
   logger.trace("Zeroing confirmed and streak vectors");
   confirmed.assign(n, 0);
   streak.assign(n, 0);
+  down_bits = std::vector<std::atomic_uint64_t>((n + 63) / 64);
+  sampled_at = std::vector<std::atomic_int64_t>(n);
   logger.debug("Instantiating poll waiter");
   waiter = PollWaiter::create();
   logger.debug("Spawning enumerator thread");
@@ -159,7 +163,38 @@ void BackendEnumerator::run(const std::stop_token &stop) {
 #endif
 }
 
+void BackendEnumerator::publish(std::size_t slot, bool down) noexcept {
+  const auto bit = std::uint64_t{1} << (slot % 64);
+  auto &word = down_bits[slot / 64];
+  if (down)
+    word.fetch_or(bit, std::memory_order_relaxed);
+  else
+    word.fetch_and(~bit, std::memory_order_relaxed);
+  sampled_at[slot].store(
+      std::chrono::steady_clock::now().time_since_epoch().count(),
+      std::memory_order_release);
+}
+
+bool BackendEnumerator::known_down(std::size_t slot) const noexcept {
+  if (slot >= sampled_at.size())
+    return false;
+  const auto at = sampled_at[slot].load(std::memory_order_acquire);
+  if (at == 0)
+    return false;
+  // Two of the longest intervals the poll thread ever waits between sweeps.
+  const auto longest = std::chrono::milliseconds{
+      2 * static_cast<std::uint64_t>(std::max(interval_ms, backoff_max_ms))};
+  const auto age = std::chrono::steady_clock::now() -
+                   std::chrono::steady_clock::time_point{
+                       std::chrono::steady_clock::duration{at}};
+  if (age > longest)
+    return false;
+  const auto bit = std::uint64_t{1} << (slot % 64);
+  return (down_bits[slot / 64].load(std::memory_order_relaxed) & bit) != 0;
+}
+
 bool BackendEnumerator::poll_once(const SweepMode mode) {
+  const TraceScope trace("poll_once", "enumerator");
   logger.debug("Polling in mode {}", std::to_underlying(mode));
   const std::size_t n = confirmed.size();
   logger.debug("There are {} instances", n);
@@ -170,6 +205,8 @@ bool BackendEnumerator::poll_once(const SweepMode mode) {
       try {
         instances[slot] = registry->create_at(slot);
         assert(instances[slot]);
+        if (tracing())
+          trace_backend_name(registry->id_at(slot), registry->name_at(slot));
       } catch (...) {
         instances[slot] = nullptr;
       }
@@ -182,6 +219,7 @@ bool BackendEnumerator::poll_once(const SweepMode mode) {
                  instances[slot]->get_name());
     bool raw = false;
     try {
+      const LatencyScope timing(registry->id_at(slot), StatsOperation::Probe);
       const auto features = instances[slot]->get_features().to_ullong();
       logger.debug("Scan returned feature mask {}", features);
       raw = (features & BackendFeature::IS_SUPPORTED_AT_RUNTIME) != 0;
@@ -198,7 +236,7 @@ bool BackendEnumerator::poll_once(const SweepMode mode) {
     case SweepMode::Prime:
       confirmed[slot] = sample;
       streak[slot] = 0;
-      continue;
+      break;
     case SweepMode::Resync:
       streak[slot] = 0;
       if (sample != confirmed[slot]) {
@@ -207,11 +245,11 @@ bool BackendEnumerator::poll_once(const SweepMode mode) {
           callback(userdata, to_prism_id(registry->id_at(slot)),
                    registry->name_at(slot), raw);
       }
-      continue;
+      break;
     case SweepMode::Normal:
       if (sample == confirmed[slot]) {
         streak[slot] = 0;
-        continue;
+        break;
       }
       if (++streak[slot] >= debounce) {
         confirmed[slot] = sample;
@@ -220,8 +258,9 @@ bool BackendEnumerator::poll_once(const SweepMode mode) {
           callback(userdata, to_prism_id(registry->id_at(slot)),
                    registry->name_at(slot), raw);
       }
-      continue;
+      break;
     }
+    publish(slot, !raw && confirmed[slot] == 0);
   }
   return !disagreement;
 }
@@ -6,6 +6,9 @@
 #include "logging.h"
 #include "poll_waiter.h"
 #include "prism.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -33,6 +36,11 @@ private:
   std::vector<std::shared_ptr<TextToSpeechBackend>> instances;
   std::vector<std::uint8_t> confirmed;
   std::vector<std::uint32_t> streak;
+  // Shared with other threads: one bit per slot that is confirmed down and
+  // whose latest sample agrees, and when each slot was last sampled, in
+  // steady_clock ticks, or 0 if never.
+  std::vector<std::atomic_uint64_t> down_bits;
+  std::vector<std::atomic_int64_t> sampled_at;
   std::mutex mtx;
   bool paused = false;
   std::unique_ptr<PollWaiter> waiter;
@@ -44,6 +52,7 @@ private:
 
   void run(const std::stop_token &stop);
   bool poll_once(const SweepMode mode);
+  void publish(std::size_t slot, bool down) noexcept;
 
 public:
   BackendEnumerator(FrozenRegistry *registry,
@@ -58,4 +67,9 @@ public:
   BackendEnumerator &operator=(BackendEnumerator &&) = delete;
   void pause();
   void resume();
+  // True if entry `slot` is confirmed unavailable by a sample recent enough
+  // to trust, so there is no point trying to initialize it. Any thread may
+  // ask. Never true for a slot that has not been sampled lately, such as
+  // while polling is paused.
+  [[nodiscard]] bool known_down(std::size_t slot) const noexcept;
 };
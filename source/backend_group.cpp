@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "backend_group.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace {
+// Outlives the call when a member misses the deadline, since its completion
+// still arrives later.
+struct Outcome {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<BackendError> results;
+  std::size_t remaining;
+};
+} // namespace
+
+BackendResult<>
+BackendGroup::broadcast(std::span<const std::optional<std::string_view>> texts,
+                        bool interrupt, UtteranceWorker::Kind kind,
+                        std::chrono::milliseconds timeout,
+                        std::span<BackendError> results) try {
+  const auto outcome = std::make_shared<Outcome>();
+  outcome->results.assign(members.size(), BackendError::TimedOut);
+  outcome->remaining = members.size();
+  const auto stopping = kind == UtteranceWorker::Kind::Stop;
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    auto &worker = *members[i];
+    if (stopping)
+      worker.cancel_pending();
+    if (!texts[i]) {
+      std::scoped_lock lock(outcome->mutex);
+      outcome->results[i] = BackendError::Ok;
+      --outcome->remaining;
+      continue;
+    }
+    const auto id = worker.submit(
+        *texts[i], interrupt, kind,
+        [outcome, i](UtteranceId, BackendError error) {
+          {
+            std::scoped_lock lock(outcome->mutex);
+            outcome->results[i] = error;
+            --outcome->remaining;
+          }
+          outcome->cv.notify_all();
+        },
+        stopping ? SpeechPriority::Important : SpeechPriority::Message);
+    if (!id) {
+      std::scoped_lock lock(outcome->mutex);
+      outcome->results[i] = id.error();
+      --outcome->remaining;
+    }
+  }
+  std::unique_lock lock(outcome->mutex);
+  const auto settled = [&outcome] { return outcome->remaining == 0; };
+  if (timeout == std::chrono::milliseconds::zero())
+    outcome->cv.wait(lock, settled);
+  else
+    outcome->cv.wait_for(lock, timeout, settled);
+  std::copy_n(outcome->results.begin(),
+              std::min(results.size(), outcome->results.size()),
+              results.begin());
+  if (outcome->results.empty() ||
+      std::ranges::find(outcome->results, BackendError::Ok) !=
+          outcome->results.end())
+    return {};
+  return std::unexpected(outcome->results.front());
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+}
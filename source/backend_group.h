@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "utterance_worker.h"
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Sends the same request to several backends at once. Every member has a
+// worker of its own, so a member stuck in a slow call only delays its own
+// result; the group stops waiting for it at the deadline and reports
+// TimedOut while the call carries on in the background.
+class BackendGroup {
+  std::vector<UtteranceWorker *> members;
+
+public:
+  explicit BackendGroup(std::vector<UtteranceWorker *> members)
+      : members(std::move(members)) {}
+  [[nodiscard]] std::size_t size() const noexcept { return members.size(); }
+  // Sends each member its own entry of `texts`, or nothing where that is
+  // empty, which counts as done. Fills `results` with one entry per member,
+  // and fails only if every member did. A zero timeout waits for all of them.
+  BackendResult<>
+  broadcast(std::span<const std::optional<std::string_view>> texts,
+            bool interrupt, UtteranceWorker::Kind kind,
+            std::chrono::milliseconds timeout, std::span<BackendError> results);
+};
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "backend_selector.h"
+#include <algorithm>
+#include <condition_variable>
+#include <new>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <objbase.h>
+#endif
+
+namespace {
+enum class State : std::uint8_t { Waiting, Running, Ready, Failed };
+
+struct Race {
+  std::mutex mutex;
+  std::condition_variable_any cv;
+  // Registry entries in the order they are tried, and the state and instance
+  // of each, by position in that order.
+  std::vector<std::size_t> order;
+  std::vector<State> states;
+  std::vector<BackendSelector::Backend> backends;
+  // Bumped by every candidate that finishes.
+  std::size_t reports = 0;
+  bool decided = false;
+};
+
+// Runs on a thread of its own. A candidate that succeeds before the race is
+// decided waits for the outcome, then destroys itself here unless it won.
+void attempt(FrozenRegistry &registry, Race &race,
+             std::size_t position) noexcept {
+#ifdef _WIN32
+  const bool com_ok = SUCCEEDED(
+      CoInitializeEx(nullptr, COINIT_MULTITHREADED | COINIT_SPEED_OVER_MEMORY));
+#endif
+  BackendSelector::Backend backend;
+  try {
+    const auto index = race.order[position];
+    backend = registry.create_at(index);
+    if (backend != nullptr && !registry.initialize_at(index, *backend))
+      backend.reset();
+  } catch (...) {
+    backend.reset();
+  }
+  {
+    std::unique_lock lock(race.mutex);
+    if (!race.decided) {
+      race.states[position] =
+          backend != nullptr ? State::Ready : State::Failed;
+      race.backends[position] = std::move(backend);
+      ++race.reports;
+      race.cv.notify_all();
+      race.cv.wait(lock, [&race] { return race.decided; });
+      backend = std::move(race.backends[position]);
+    }
+  }
+  backend.reset();
+#ifdef _WIN32
+  if (com_ok)
+    CoUninitialize();
+#endif
+}
+} // namespace
+
+BackendSelector::BackendSelector(FrozenRegistry *registry,
+                                 const BackendEnumerator *enumerator,
+                                 std::size_t parallel,
+                                 std::chrono::milliseconds deadline) noexcept
+    : registry(registry), enumerator(enumerator),
+      parallel(std::max<std::size_t>(parallel, 1)), deadline(deadline) {}
+
+BackendSelector::~BackendSelector() {
+  std::list<Task> joining;
+  {
+    std::scoped_lock lock(mutex);
+    stopping = true;
+    joining.swap(tasks);
+  }
+  // Stop everything before joining anything, so a pending acquire_best_async
+  // gives up instead of waiting out its candidates.
+  for (auto &task : joining)
+    task.thread.request_stop();
+}
+
+bool BackendSelector::start(
+    std::function<void(const std::stop_token &)> work) noexcept try {
+  std::scoped_lock lock(mutex);
+  if (stopping)
+    return false;
+  tasks.remove_if([](const Task &task) { return task.done.load(); });
+  auto &task = tasks.emplace_back();
+  try {
+    task.thread = std::jthread(
+        [&task, work = std::move(work)](const std::stop_token &stop) {
+          work(stop);
+          task.done.store(true);
+        });
+  } catch (const std::system_error &e) {
+    tasks.pop_back();
+    logger.error("Failed to start a thread: {}", e.what());
+    return false;
+  }
+  return true;
+} catch (const std::bad_alloc &) {
+  return false;
+}
+
+FrozenRegistry::Defer BackendSelector::defer() const {
+  if (enumerator == nullptr)
+    return nullptr;
+  return [enumerator = enumerator](std::size_t index) {
+    return enumerator->known_down(index);
+  };
+}
+
+BackendResult<std::pair<std::size_t, BackendSelector::Backend>>
+BackendSelector::race(const std::stop_token &stop) try {
+  using Clock = std::chrono::steady_clock;
+  const auto race = std::make_shared<Race>();
+  race->order = registry->selection_order(defer());
+  const auto n = race->order.size();
+  race->states.resize(n, State::Waiting);
+  race->backends.resize(n);
+  std::optional<Clock::time_point> until;
+  if (deadline.count() > 0)
+    until = Clock::now() + deadline;
+  std::size_t next = 0;
+  std::optional<std::size_t> winner;
+  auto error = BackendError::BackendNotAvailable;
+  std::unique_lock lock(race->mutex);
+  for (;;) {
+    // Keep `parallel` candidates initializing, in priority order.
+    while (next < n && std::ranges::count(race->states, State::Running) <
+                           static_cast<std::ptrdiff_t>(parallel)) {
+      const auto position = next++;
+      race->states[position] = State::Running;
+      if (!start([this, race, position](const std::stop_token &) {
+            attempt(*registry, *race, position);
+          }))
+        race->states[position] = State::Failed;
+    }
+    // The best candidate still in the running wins as soon as it is ready.
+    const auto best = std::ranges::find_if(
+        race->states, [](State s) { return s != State::Failed; });
+    if (best == race->states.end())
+      break;
+    if (*best == State::Ready) {
+      winner = static_cast<std::size_t>(best - race->states.begin());
+      break;
+    }
+    if (stop.stop_requested()) {
+      error = BackendError::Cancelled;
+      break;
+    }
+    if (until && Clock::now() >= *until) {
+      // Past the deadline, the best that is ready beats waiting any longer.
+      if (const auto ready = std::ranges::find(race->states, State::Ready);
+          ready != race->states.end())
+        winner = static_cast<std::size_t>(ready - race->states.begin());
+      else
+        error = BackendError::TimedOut;
+      break;
+    }
+    const auto changed = [&race, seen = race->reports] {
+      return race->reports != seen;
+    };
+    if (until)
+      race->cv.wait_until(lock, stop, *until, changed);
+    else
+      race->cv.wait(lock, stop, changed);
+  }
+  Backend backend;
+  if (winner)
+    backend = std::move(race->backends[*winner]);
+  race->decided = true;
+  lock.unlock();
+  race->cv.notify_all();
+  if (!winner)
+    return std::unexpected(error);
+  const auto index = race->order[*winner];
+  logger.debug("Entry {} won the race", index);
+  return std::pair{index, std::move(backend)};
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+}
+
+BackendResult<BackendSelector::Backend> BackendSelector::create_best() {
+  if (parallel == 1 && deadline.count() == 0) {
+    if (auto backend = registry->create_best(defer()); backend != nullptr)
+      return backend;
+    return std::unexpected(BackendError::BackendNotAvailable);
+  }
+  auto won = race({});
+  if (!won)
+    return std::unexpected(won.error());
+  return std::move(won->second);
+}
+
+BackendResult<BackendSelector::Backend>
+BackendSelector::acquire_best(const std::stop_token &stop) {
+  if (parallel == 1 && deadline.count() == 0) {
+    if (auto backend = registry->acquire_best(defer()); backend != nullptr)
+      return backend;
+    return std::unexpected(BackendError::BackendNotAvailable);
+  }
+  if (auto cached = registry->cached_best(); cached != nullptr)
+    return cached;
+  auto won = race(stop);
+  if (!won)
+    return std::unexpected(won.error());
+  return registry->install_best(won->first, std::move(won->second));
+}
+
+bool BackendSelector::acquire_best_async(Ready ready) noexcept try {
+  return start([this, ready = std::move(ready)](const std::stop_token &stop) {
+#ifdef _WIN32
+    const bool com_ok = SUCCEEDED(CoInitializeEx(
+        nullptr, COINIT_MULTITHREADED | COINIT_SPEED_OVER_MEMORY));
+#endif
+    ready(acquire_best(stop));
+#ifdef _WIN32
+    if (com_ok)
+      CoUninitialize();
+#endif
+  });
+} catch (const std::bad_alloc &) {
+  return false;
+}
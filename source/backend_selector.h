@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "backend_enumerator.h"
+#include "frozen_registry.h"
+#include "logging.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+// Picks a context's best backend by initializing several candidates at once
+// rather than one after another. Up to `parallel` of the highest-priority
+// candidates initialize on threads of their own, each failure making room for
+// the next, and the highest-priority one to succeed wins. Once the deadline
+// passes, the best that has succeeded so far wins instead. Candidates still
+// initializing are left to finish, and every loser is destroyed on its own
+// thread, so a slow engine never holds up the caller.
+//
+// With one candidate at a time and no deadline this is exactly the registry's
+// own create_best() and acquire_best(), run on the calling thread.
+//
+// Given the context's enumerator, backends it has lately found not running
+// are tried only after every other has failed, so the usual choice costs a
+// single initialize.
+class BackendSelector {
+public:
+  using Backend = std::shared_ptr<TextToSpeechBackend>;
+  using Ready = std::function<void(BackendResult<Backend>)>;
+
+private:
+  struct Task {
+    std::jthread thread;
+    std::atomic_bool done{false};
+  };
+
+  FrozenRegistry *registry;
+  const BackendEnumerator *enumerator;
+  std::size_t parallel;
+  std::chrono::milliseconds deadline;
+  std::mutex mutex;
+  // Threads started and not yet joined. Finished ones are joined by the next
+  // start() rather than by themselves.
+  std::list<Task> tasks;
+  bool stopping = false;
+  LogSource logger{"Backend Selector"};
+
+  [[nodiscard]] bool
+  start(std::function<void(const std::stop_token &)> work) noexcept;
+  [[nodiscard]] FrozenRegistry::Defer defer() const;
+  // The winning entry's index and instance.
+  [[nodiscard]] BackendResult<std::pair<std::size_t, Backend>>
+  race(const std::stop_token &stop);
+
+public:
+  // `parallel` of 0 is taken as 1; a `deadline` of 0 waits for as long as
+  // candidates are still initializing. `enumerator` may be null, and must
+  // otherwise outlive the selector.
+  BackendSelector(FrozenRegistry *registry,
+                  const BackendEnumerator *enumerator, std::size_t parallel,
+                  std::chrono::milliseconds deadline) noexcept;
+  // Waits for every thread, including candidates still initializing.
+  ~BackendSelector();
+  BackendSelector(const BackendSelector &) = delete;
+  BackendSelector &operator=(const BackendSelector &) = delete;
+  BackendSelector(BackendSelector &&) = delete;
+  BackendSelector &operator=(BackendSelector &&) = delete;
+  [[nodiscard]] BackendResult<Backend> create_best();
+  [[nodiscard]] BackendResult<Backend>
+  acquire_best(const std::stop_token &stop = {});
+  // Runs acquire_best() on a thread of its own and passes the result to
+  // `ready` there, or to Cancelled if the selector is destroyed first. False
+  // if the thread could not be started, in which case `ready` is never called.
+  [[nodiscard]] bool acquire_best_async(Ready ready) noexcept;
+};
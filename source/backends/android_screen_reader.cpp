@@ -51,6 +51,9 @@ public:
     return "Android screen reader";
   }
 
+  // The screen reader's user owns these and may change them at any time.
+  [[nodiscard]] bool owns_params() const override { return false; }
+
   [[nodiscard]] std::bitset<64> get_features() const override try {
     if (backend) {
       return std::bitset<64>{
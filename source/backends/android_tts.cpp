@@ -70,6 +70,10 @@ public:
     return "Android Text to Speech";
   }
 
+  // TextToSpeech.getMaxSpeechInputLength(), counted in UTF-16 units, which
+  // is never more than the UTF-8 length.
+  [[nodiscard]] std::size_t max_text_bytes() const override { return 4000; }
+
   [[nodiscard]] std::bitset<64> get_features() const override try {
     if (backend) {
       return std::bitset<64>{
@@ -163,6 +167,16 @@ public:
     return {};
   }
 
+  BackendResult<> speak_ssml(std::string_view ssml, bool interrupt) override {
+    if (!backend)
+      return std::unexpected(BackendError::NotInitialized);
+    djinni::DataView view(reinterpret_cast<const uint8_t *>(ssml.data()),
+                          ssml.size());
+    if (const auto res = backend->speak_ssml(view, interrupt); !res)
+      return std::unexpected(static_cast<BackendError>(res.error()));
+    return {};
+  }
+
   BackendResult<> speak_to_memory(std::string_view text, AudioCallback callback,
                                   void *userdata) override {
     if (!backend)
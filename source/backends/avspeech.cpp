@@ -12,11 +12,14 @@
 #include <bitset>
 #include <chrono>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <simdutf.h>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 @interface AVSpeechSyncDelegate : NSObject <AVSpeechSynthesizerDelegate>
@@ -64,6 +67,16 @@ struct VoiceInfo {
   std::string name;
   std::string language;
 };
+
+// Incremental delivery state shared with the buffer callback, which can still
+// fire after speak_to_memory_ex has given up on a cancelled utterance.
+struct MemoryStream {
+  std::mutex lock;
+  TextToSpeechBackend::AudioCallback callback;
+  void *userdata;
+  std::vector<float> scratch;
+  bool closed = false;
+};
 } // namespace
 
 class AVSpeechBackend final : public TextToSpeechBackend {
@@ -80,6 +93,8 @@ private:
   std::atomic<std::size_t> audio_channels{1};
   std::atomic<std::size_t> audio_sample_rate{22050};
   std::atomic<std::size_t> audio_bit_depth{32};
+  static constexpr double synthesis_timeout_sec = 60.0 * 5.0;
+  static constexpr double cancel_poll_sec = 0.02;
 
   static void sync_on_main(dispatch_block_t block) {
     if ([NSThread isMainThread] == YES) {
@@ -89,7 +104,7 @@ private:
     }
   }
 
-  static void wait_for_semaphore_pumping_main(dispatch_semaphore_t sema,
+  static bool wait_for_semaphore_pumping_main(dispatch_semaphore_t sema,
                                               double timeout_sec) {
     if ([NSThread isMainThread] == YES) {
       NSDate *start = [NSDate date];
@@ -97,16 +112,53 @@ private:
                  sema, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_MSEC)) !=
              0) {
         if ([[NSDate date] timeIntervalSinceDate:start] > timeout_sec)
-          break;
+          return false;
         [[NSRunLoop currentRunLoop]
                runMode:NSDefaultRunLoopMode
             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
       }
-    } else {
-      dispatch_semaphore_wait(
-          sema, dispatch_time(DISPATCH_TIME_NOW,
-                              (int64_t)(timeout_sec * NSEC_PER_SEC)));
+      return true;
     }
+    return dispatch_semaphore_wait(
+               sema, dispatch_time(DISPATCH_TIME_NOW,
+                                   (int64_t)(timeout_sec * NSEC_PER_SEC))) == 0;
+  }
+
+  // Returns false if `cancel` fired before the engine signalled `sema`.
+  static bool wait_for_synthesis(dispatch_semaphore_t sema,
+                                 const std::stop_token &cancel) {
+    if (!cancel.stop_possible()) {
+      wait_for_semaphore_pumping_main(sema, synthesis_timeout_sec);
+      return true;
+    }
+    const auto deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration<double>(synthesis_timeout_sec);
+    while (!wait_for_semaphore_pumping_main(sema, cancel_poll_sec)) {
+      if (cancel.stop_requested())
+        return false;
+      if (std::chrono::steady_clock::now() >= deadline)
+        break;
+    }
+    return true;
+  }
+
+  static void append_interleaved(std::vector<float> &out,
+                                 AVAudioPCMBuffer *buffer,
+                                 std::size_t channels) {
+    auto *const *fd = buffer.floatChannelData;
+    if (fd == nullptr)
+      return;
+    const auto frames = buffer.frameLength;
+    if (channels == 1) {
+      out.insert(out.end(), fd[0], fd[0] + frames);
+      return;
+    }
+    const auto base = out.size();
+    out.resize(base + (frames * channels));
+    for (std::size_t f = 0; f < frames; ++f)
+      for (std::size_t ch = 0; ch < channels; ++ch)
+        out[base + (f * channels) + ch] = fd[ch][f];
   }
 
 public:
@@ -265,6 +317,16 @@ public:
 
   BackendResult<> speak_to_memory(std::string_view text, AudioCallback callback,
                                   void *userdata) override {
+    return speak_to_memory_ex(text, std::move(callback), userdata, {});
+  }
+
+  [[nodiscard]] bool cancels_memory_synthesis() const override {
+    return true;
+  }
+
+  BackendResult<> speak_to_memory_ex(std::string_view text,
+                                     AudioCallback callback, void *userdata,
+                                     const MemoryOptions &options) override {
     if (!initialized.test())
       return std::unexpected(BackendError::NotInitialized);
     if (!callback)
@@ -286,6 +348,12 @@ public:
           target_voice_id = voices[v_idx].identifier;
       }
       auto *acc = [[AVSpeechMemoryAccumulator alloc] init];
+      const bool incremental = options.incremental;
+      auto stream = std::make_shared<MemoryStream>();
+      if (incremental) {
+        stream->callback = callback;
+        stream->userdata = userdata;
+      }
       sync_on_main(^{
         if (memory_synthesizer == nullptr) {
           memory_synthesizer = [[AVSpeechSynthesizer alloc] init];
@@ -322,11 +390,34 @@ public:
                    }
                    if (acc.captured_format == nullptr)
                      acc.captured_format = pcm.format;
-                   [acc.buffers addObject:pcm];
+                   if (!incremental) {
+                     [acc.buffers addObject:pcm];
+                     return;
+                   }
+                   const std::size_t ch = pcm.format.channelCount;
+                   const auto sr =
+                       static_cast<std::size_t>(pcm.format.sampleRate);
+                   std::scoped_lock guard(stream->lock);
+                   if (stream->closed || ch < 1 || sr < 1)
+                     return;
+                   stream->scratch.clear();
+                   append_interleaved(stream->scratch, pcm, ch);
+                   stream->callback(stream->userdata, stream->scratch.data(),
+                                    stream->scratch.size(), ch, sr);
                  }];
       });
-      wait_for_semaphore_pumping_main(acc.done_sema, 60.0 * 5.0);
-      if (acc.buffers.count == 0 || acc.captured_format == nil)
+      const bool finished = wait_for_synthesis(acc.done_sema, options.cancel);
+      {
+        std::scoped_lock guard(stream->lock);
+        stream->closed = true;
+      }
+      if (!finished) {
+        sync_on_main(^{
+          [memory_synthesizer stopSpeakingAtBoundary:AVSpeechBoundaryImmediate];
+        });
+        return std::unexpected(BackendError::Cancelled);
+      }
+      if (incremental || acc.buffers.count == 0 || acc.captured_format == nil)
         return {};
       const std::uint64_t channels = acc.captured_format.channelCount;
       const auto sample_rate =
@@ -339,21 +430,8 @@ public:
         total_frames += b.frameLength;
       std::vector<float> audio_data;
       audio_data.reserve(total_frames * channels);
-      for (AVAudioPCMBuffer *b in acc.buffers) {
-        auto *const *fd = b.floatChannelData;
-        if (fd == nullptr)
-          continue;
-        const auto frames = b.frameLength;
-        if (channels == 1) {
-          audio_data.insert(audio_data.end(), fd[0], fd[0] + frames);
-        } else {
-          const auto base = audio_data.size();
-          audio_data.resize(base + (frames * channels));
-          for (std::size_t f = 0; f < frames; ++f)
-            for (std::size_t ch = 0; ch < channels; ++ch)
-              audio_data[base + (f * channels) + ch] = fd[ch][f];
-        }
-      }
+      for (AVAudioPCMBuffer *b in acc.buffers)
+        append_interleaved(audio_data, b, channels);
       auto const tv = trim_silence_rms_gate_inplace(
           std::span<float>(audio_data), channels, sample_rate);
       callback(userdata, tv.view.data(), tv.view.size(), channels, sample_rate);
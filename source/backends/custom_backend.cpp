@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 
 #include "../backend_catalog.h"
+#include "../latency_stats.h"
 #include "../logging.h"
 #include "prism.h"
 #include <algorithm>
@@ -10,6 +11,7 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -69,7 +71,11 @@ bool vtable_consistent(std::uint64_t features,
        .present = vtable.get_sample_rate != nullptr},
       {.feature = SUPPORTS_GET_BIT_DEPTH,
        .present = vtable.get_bit_depth != nullptr},
+      {.feature = SUPPORTS_SPEAK_SSML, .present = vtable.speak_ssml != nullptr},
   });
+  // speak_batch has no feature bit of its own; it refines speak.
+  if (vtable.speak_batch != nullptr && vtable.speak == nullptr)
+    return false;
   return std::ranges::all_of(slots, [features](const FeatureSlot &slot) {
     return ((features & slot.feature) != 0) == slot.present;
   });
@@ -82,11 +88,13 @@ struct CustomRegistration {
   std::shared_ptr<void> owner;
   std::bitset<64> features;
   std::string name;
+  BackendId id;
   CustomRegistration(const PrismBackendVTable &vtable, void *userdata,
                      void (*userdata_free)(void *), std::shared_ptr<void> owner,
                      std::uint64_t features, std::string name)
       : vtable(vtable), userdata(userdata), userdata_free(userdata_free),
-        owner(std::move(owner)), features(features), name(std::move(name)) {}
+        owner(std::move(owner)), features(features), name(std::move(name)),
+        id(make_backend_id(this->name)) {}
   ~CustomRegistration() {
     if (userdata_free != nullptr)
       userdata_free(userdata);
@@ -120,6 +128,12 @@ private:
   void *instance;
   bool initialized = false;
   bool paused = false;
+  std::vector<PrismUtterance> batch;
+
+  // Times the backend's own callback, apart from what Prism adds around it.
+  [[nodiscard]] LatencyScope timed(StatsOperation op) const noexcept {
+    return {registration->id, op, StatsLayer::Engine};
+  }
 
   template <typename Slot> BackendResult<> check(Slot slot) const {
     if (!initialized)
@@ -135,6 +149,7 @@ private:
       return std::unexpected(BackendError::RangeOutOfBounds);
     if (const auto ready = check(slot); !ready)
       return std::unexpected(ready.error());
+    const auto timing = timed(StatsOperation::SetParameter);
     return to_result(slot(instance, value));
   }
 
@@ -142,6 +157,7 @@ private:
     if (const auto ready = check(slot); !ready)
       return std::unexpected(ready.error());
     float value = 0.0F;
+    const auto timing = timed(StatsOperation::GetParameter);
     if (const auto error = slot(instance, &value); error != PRISM_OK)
       return std::unexpected(from_prism_error(error));
     if (!std::isfinite(value))
@@ -149,10 +165,12 @@ private:
     return std::clamp(value, 0.0F, 1.0F);
   }
 
-  template <typename Slot> BackendResult<std::size_t> get_size(Slot slot) {
+  template <typename Slot>
+  BackendResult<std::size_t> get_size(Slot slot, StatsOperation op) {
     if (const auto ready = check(slot); !ready)
       return std::unexpected(ready.error());
     std::size_t value = 0;
+    const auto timing = timed(op);
     if (const auto error = slot(instance, &value); error != PRISM_OK)
       return std::unexpected(from_prism_error(error));
     return value;
@@ -163,6 +181,7 @@ private:
     if (const auto ready = check(slot); !ready)
       return std::unexpected(ready.error());
     const char *value = nullptr;
+    const auto timing = timed(StatsOperation::Voices);
     if (const auto error = slot(instance, id, &value); error != PRISM_OK)
       return std::unexpected(from_prism_error(error));
     if (value == nullptr)
@@ -189,6 +208,7 @@ public:
     using namespace BackendFeature;
     auto bits = std::bitset<64>{registration->features};
     if (registration->vtable.is_supported != nullptr) {
+      const auto timing = timed(StatsOperation::Probe);
       if (registration->vtable.is_supported(instance))
         bits |= IS_SUPPORTED_AT_RUNTIME;
       else
@@ -197,6 +217,10 @@ public:
     return bits;
   }
 
+  // The host or plugin behind the vtable may change its parameters without
+  // telling Prism.
+  [[nodiscard]] bool owns_params() const override { return false; }
+
   BackendResult<> initialize() override {
     if (initialized)
       return std::unexpected(BackendError::AlreadyInitialized);
@@ -204,6 +228,7 @@ public:
       initialized = true;
       return {};
     }
+    const auto timing = timed(StatsOperation::Initialize);
     const auto result = to_result(registration->vtable.initialize(instance));
     if (result)
       initialized = true;
@@ -213,41 +238,67 @@ public:
   BackendResult<> speak(std::string_view text, bool interrupt) override {
     if (const auto ready = check(registration->vtable.speak); !ready)
       return std::unexpected(ready.error());
-    const std::string owned{text};
+    const auto timing = timed(StatsOperation::Speak);
     return to_result(
-        registration->vtable.speak(instance, owned.c_str(), interrupt));
+        registration->vtable.speak(instance, text.data(), interrupt));
+  }
+
+  BackendResult<> speak_ssml(std::string_view ssml, bool interrupt) override {
+    if (const auto ready = check(registration->vtable.speak_ssml); !ready)
+      return std::unexpected(ready.error());
+    const auto timing = timed(StatsOperation::Speak);
+    return to_result(
+        registration->vtable.speak_ssml(instance, ssml.data(), interrupt));
+  }
+
+  BackendResult<> speak_batch(std::span<const Utterance> items) override {
+    if (registration->vtable.speak_batch == nullptr)
+      return TextToSpeechBackend::speak_batch(items);
+    if (const auto ready = check(registration->vtable.speak_batch); !ready)
+      return std::unexpected(ready.error());
+    batch.clear();
+    for (const auto &item : items)
+      batch.push_back({.text = item.text.data(),
+                       .length = item.text.size(),
+                       .flags = PRISM_TEXT_PREVALIDATED |
+                                PRISM_TEXT_NUL_TERMINATED,
+                       .interrupt = item.interrupt});
+    const auto timing = timed(StatsOperation::Speak);
+    return to_result(registration->vtable.speak_batch(instance, batch.data(),
+                                                      batch.size()));
   }
 
   BackendResult<> speak_to_memory(std::string_view text, AudioCallback callback,
                                   void *userdata) override {
     if (const auto ready = check(registration->vtable.speak_to_memory); !ready)
       return std::unexpected(ready.error());
-    const std::string owned{text};
     MemoryBridge bridge{
         .callback = &callback, .userdata = userdata, .scratch = {}};
+    const auto timing = timed(StatsOperation::SpeakToMemory);
     return to_result(registration->vtable.speak_to_memory(
-        instance, owned.c_str(), &memory_trampoline, &bridge));
+        instance, text.data(), &memory_trampoline, &bridge));
   }
 
   BackendResult<> braille(std::string_view text) override {
     if (const auto ready = check(registration->vtable.braille); !ready)
       return std::unexpected(ready.error());
-    const std::string owned{text};
-    return to_result(registration->vtable.braille(instance, owned.c_str()));
+    const auto timing = timed(StatsOperation::Braille);
+    return to_result(registration->vtable.braille(instance, text.data()));
   }
 
   BackendResult<> output(std::string_view text, bool interrupt) override {
     if (const auto ready = check(registration->vtable.output); !ready)
       return std::unexpected(ready.error());
-    const std::string owned{text};
+    const auto timing = timed(StatsOperation::Output);
     return to_result(
-        registration->vtable.output(instance, owned.c_str(), interrupt));
+        registration->vtable.output(instance, text.data(), interrupt));
   }
 
   BackendResult<bool> is_speaking() override {
     if (const auto ready = check(registration->vtable.is_speaking); !ready)
       return std::unexpected(ready.error());
     bool speaking = false;
+    const auto timing = timed(StatsOperation::IsSpeaking);
     if (const auto error =
             registration->vtable.is_speaking(instance, &speaking);
         error != PRISM_OK)
@@ -258,6 +309,7 @@ public:
   BackendResult<> stop() override {
     if (const auto ready = check(registration->vtable.stop); !ready)
       return std::unexpected(ready.error());
+    const auto timing = timed(StatsOperation::Stop);
     const auto result = to_result(registration->vtable.stop(instance));
     if (result)
       paused = false;
@@ -269,6 +321,7 @@ public:
       return std::unexpected(ready.error());
     if (paused)
       return std::unexpected(BackendError::AlreadyPaused);
+    const auto timing = timed(StatsOperation::Pause);
     const auto result = to_result(registration->vtable.pause(instance));
     if (result)
       paused = true;
@@ -280,6 +333,7 @@ public:
       return std::unexpected(ready.error());
     if (!paused)
       return std::unexpected(BackendError::NotPaused);
+    const auto timing = timed(StatsOperation::Resume);
     const auto result = to_result(registration->vtable.resume(instance));
     if (result)
       paused = false;
@@ -313,11 +367,12 @@ public:
   BackendResult<> refresh_voices() override {
     if (const auto ready = check(registration->vtable.refresh_voices); !ready)
       return std::unexpected(ready.error());
+    const auto timing = timed(StatsOperation::Voices);
     return to_result(registration->vtable.refresh_voices(instance));
   }
 
   BackendResult<std::size_t> count_voices() override {
-    return get_size(registration->vtable.count_voices);
+    return get_size(registration->vtable.count_voices, StatsOperation::Voices);
   }
 
   BackendResult<std::string> get_voice_name(std::size_t id) override {
@@ -331,23 +386,27 @@ public:
   BackendResult<> set_voice(std::size_t id) override {
     if (const auto ready = check(registration->vtable.set_voice); !ready)
       return std::unexpected(ready.error());
+    const auto timing = timed(StatsOperation::Voices);
     return to_result(registration->vtable.set_voice(instance, id));
   }
 
   BackendResult<std::size_t> get_voice() override {
-    return get_size(registration->vtable.get_voice);
+    return get_size(registration->vtable.get_voice, StatsOperation::Voices);
   }
 
   BackendResult<std::size_t> get_channels() override {
-    return get_size(registration->vtable.get_channels);
+    return get_size(registration->vtable.get_channels,
+                    StatsOperation::GetParameter);
   }
 
   BackendResult<std::size_t> get_sample_rate() override {
-    return get_size(registration->vtable.get_sample_rate);
+    return get_size(registration->vtable.get_sample_rate,
+                    StatsOperation::GetParameter);
   }
 
   BackendResult<std::size_t> get_bit_depth() override {
-    return get_size(registration->vtable.get_bit_depth);
+    return get_size(registration->vtable.get_bit_depth,
+                    StatsOperation::GetParameter);
   }
 };
 
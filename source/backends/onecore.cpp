@@ -17,6 +17,7 @@
 #include <optional>
 #include <simdutf.h>
 #include <span>
+#include <stop_token>
 #include <tchar.h>
 #include <type_traits>
 #include <utility>
@@ -213,12 +214,26 @@ public:
   }
 
   BackendResult<> speak_to_memory(std::string_view text, AudioCallback callback,
-                                  void *userdata) override try {
+                                  void *userdata) override {
+    return speak_to_memory_ex(text, std::move(callback), userdata, {});
+  }
+
+  [[nodiscard]] bool cancels_memory_synthesis() const override {
+    return true;
+  }
+
+  BackendResult<> speak_to_memory_ex(std::string_view text,
+                                     AudioCallback callback, void *userdata,
+                                     const MemoryOptions &options)
+      override try {
     if (!synth)
       return std::unexpected(BackendError::NotInitialized);
     const auto wtext = to_hstring(text);
-    const auto stream = run_on_mta(
-        [&] { return synth.SynthesizeTextToStreamAsync(wtext).get(); });
+    const auto stream = run_on_mta([&] {
+      const auto op = synth.SynthesizeTextToStreamAsync(wtext);
+      std::stop_callback abort(options.cancel, [&op] { op.Cancel(); });
+      return op.get();
+    });
     if (stream.ContentType() != _T("audio/wav"))
       return std::unexpected(BackendError::NotImplemented);
     const auto size64 = stream.Size();
@@ -253,6 +268,8 @@ public:
              wav.channels, wav.sampleRate);
     drwav_uninit(&wav);
     return {};
+  } catch (const winrt::hresult_canceled &) {
+    return std::unexpected(BackendError::Cancelled);
   } catch (const std::exception &e) {
     logger.error(
         "speak_to_memory failed  with text of size {} and userdata {}: {}",
@@ -429,6 +446,19 @@ public:
     return std::unexpected(BackendError::Unknown);
   }
 
+  BackendResult<> get_voices(VoiceList &out) override try {
+    if (!synth || !player)
+      return std::unexpected(BackendError::NotInitialized);
+    const auto voices = SpeechSynthesizer::AllVoices();
+    out.reserve(voices.Size());
+    for (const auto &voice : voices)
+      out.add(to_string(voice.DisplayName()), to_string(voice.Language()));
+    return {};
+  } catch (const winrt::hresult_error &e) {
+    logger.error("get_voices failed: {}", e.message());
+    return std::unexpected(BackendError::Unknown);
+  }
+
   BackendResult<> set_voice(std::size_t id) override try {
     if (!synth || !player)
       return std::unexpected(BackendError::NotInitialized);
@@ -12,6 +12,7 @@
 #include <functional>
 #include <giomm/dbusconnection.h>
 #include <giomm/dbuserror.h>
+#include <giomm/dbusmessage.h>
 #include <glibmm/error.h>
 #include <glibmm/variant.h>
 #include <optional>
@@ -129,6 +130,29 @@ private:
     return std::nullopt;
   }
 
+  static Glib::VariantContainerBase message_params(std::string_view text) {
+    return Glib::VariantContainerBase::create_tuple(
+        Glib::Variant<Glib::ustring>::create(
+            Glib::ustring(std::string(text.data(), text.size()))));
+  }
+
+  BackendResult<> present_message(std::string_view text) {
+    try {
+      const auto reply =
+          conn->call_sync(dialect->service_path, dialect->service_iface,
+                          "PresentMessage", message_params(text),
+                          dialect->bus_name);
+      const auto ok = Glib::VariantBase::cast_dynamic<Glib::Variant<bool>>(
+          reply.get_child(0));
+      if (!ok.get()) {
+        return std::unexpected(BackendError::SpeakFailure);
+      }
+    } catch (const Glib::Error &) {
+      return std::unexpected(BackendError::SpeakFailure);
+    }
+    return {};
+  }
+
 public:
   ~OrcaBackend() override = default;
 
@@ -181,22 +205,40 @@ public:
         return res;
       }
     }
-    try {
-      const auto params = Glib::VariantContainerBase::create_tuple(
-          Glib::Variant<Glib::ustring>::create(
-              Glib::ustring(std::string(text.data(), text.size()))));
-      const auto reply =
-          conn->call_sync(dialect->service_path, dialect->service_iface,
-                          "PresentMessage", params, dialect->bus_name);
-      const auto ok = Glib::VariantBase::cast_dynamic<Glib::Variant<bool>>(
-          reply.get_child(0));
-      if (!ok.get()) {
+    return present_message(text);
+  }
+
+  BackendResult<> speak_batch(std::span<const Utterance> items) override {
+    if (!conn || dialect == nullptr) {
+      return std::unexpected(BackendError::NotInitialized);
+    }
+    if (items.empty()) {
+      return {};
+    }
+    // The bus delivers messages from one connection in order, so everything
+    // but the last item is sent without waiting for a reply and the final
+    // round trip covers the whole batch.
+    for (const auto &item : items) {
+      if (item.interrupt) {
+        if (const auto res = stop(); !res) {
+          return res;
+        }
+      }
+      if (&item == &items.back()) {
+        break;
+      }
+      try {
+        auto message = Gio::DBus::Message::create_method_call(
+            dialect->bus_name, dialect->service_path, dialect->service_iface,
+            "PresentMessage");
+        message->set_body(message_params(item.text));
+        message->set_flags(Gio::DBus::MessageFlags::NO_REPLY_EXPECTED);
+        conn->send_message(message);
+      } catch (const Glib::Error &) {
         return std::unexpected(BackendError::SpeakFailure);
       }
-    } catch (const Glib::Error &) {
-      return std::unexpected(BackendError::SpeakFailure);
     }
-    return {};
+    return present_message(items.back().text);
   }
 
   BackendResult<> output(std::string_view text, bool interrupt) override {
@@ -34,6 +34,7 @@
 #include <stop_token>
 #include <tchar.h>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <version>
 #include <windows.h>
@@ -151,6 +152,7 @@ private:
   std::optional<bool> ready = std::nullopt;
   std::recursive_mutex voice_lock;
   LogSource logger{"SAPI"};
+  static constexpr ULONG cancel_poll_ms = 20;
   static constexpr auto VOICE_CATEGORIES = std::to_array<LPCWSTR>({
       SPCAT_VOICES,
       _T("HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Speech ")
@@ -211,8 +213,11 @@ private:
     return {};
   }
 
+  // SSML goes to the voice as it is; SAPI 5.3 recognizes it by its <speak>
+  // root. The pitch cannot be wrapped around it, so SSML carries its own.
   BackendResult<SapiSpeakParams> make_speak_args(std::string_view text,
-                                                 DWORD base_flags = 0) const {
+                                                 DWORD base_flags = 0,
+                                                 bool ssml = false) const {
     if (text.size() >= std::numeric_limits<int>::max())
       return std::unexpected(BackendError::RangeOutOfBounds);
     std::wstring wtext(
@@ -223,7 +228,9 @@ private:
       return std::unexpected(BackendError::InvalidUtf8);
     DWORD flags = base_flags;
     const auto p = pitch.load(std::memory_order_acquire);
-    if (p != 0) {
+    if (ssml) {
+      flags |= SPF_IS_XML;
+    } else if (p != 0) {
       CComPtr<IStream> stream;
       stream.Attach(SHCreateMemStream(nullptr, 0));
       if (!stream)
@@ -284,6 +291,27 @@ private:
     return SapiSpeakParams{.text = std::move(wtext), .flags = flags};
   }
 
+  BackendResult<> speak_args(const BackendResult<SapiSpeakParams> &args,
+                             bool interrupt) {
+    if (!args)
+      return std::unexpected(args.error());
+    const auto &wtext = args->text;
+    DWORD flags = args->flags;
+    std::unique_lock vl(voice_lock);
+    if (auto const r = require_ready_locked(); !r)
+      return r;
+    const bool old_paused = paused;
+    paused = false;
+    if (interrupt)
+      if (FAILED(voice->Speak(nullptr, SPF_PURGEBEFORESPEAK, nullptr))) {
+        paused = old_paused;
+        return std::unexpected(BackendError::SpeakFailure);
+      }
+    if (FAILED(voice->Speak(wtext.c_str(), flags, nullptr)))
+      return std::unexpected(BackendError::SpeakFailure);
+    return {};
+  }
+
   BackendResult<> refresh_cached_output_params_locked() {
     if (voice == nullptr)
       return std::unexpected(BackendError::NotInitialized);
@@ -352,7 +380,8 @@ public:
                 SUPPORTS_GET_VOICE_LANGUAGE | SUPPORTS_GET_VOICE |
                 SUPPORTS_SET_VOICE | SUPPORTS_GET_CHANNELS |
                 SUPPORTS_GET_SAMPLE_RATE | SUPPORTS_GET_BIT_DEPTH |
-                PERFORMS_SILENCE_TRIMMING_ON_SPEAK_TO_MEMORY;
+                PERFORMS_SILENCE_TRIMMING_ON_SPEAK_TO_MEMORY |
+                SUPPORTS_SPEAK_SSML;
     return features;
   }
 
@@ -411,29 +440,30 @@ public:
   }
 
   BackendResult<> speak(std::string_view text, bool interrupt) override {
-    auto const args = make_speak_args(text, SPF_ASYNC);
-    if (!args)
-      return std::unexpected(args.error());
-    const auto &wtext = args->text;
-    DWORD flags = args->flags;
-    std::unique_lock vl(voice_lock);
-    if (auto const r = require_ready_locked(); !r)
-      return r;
-    const bool old_paused = paused;
-    paused = false;
-    if (interrupt)
-      if (FAILED(voice->Speak(nullptr, SPF_PURGEBEFORESPEAK, nullptr))) {
-        paused = old_paused;
-        return std::unexpected(BackendError::SpeakFailure);
-      }
-    if (FAILED(voice->Speak(wtext.c_str(), flags, nullptr)))
-      return std::unexpected(BackendError::SpeakFailure);
-    return {};
+    return speak_args(make_speak_args(text, SPF_ASYNC), interrupt);
+  }
+
+  BackendResult<> speak_ssml(std::string_view ssml, bool interrupt) override {
+    return speak_args(make_speak_args(ssml, SPF_ASYNC, true), interrupt);
   }
 
   BackendResult<> speak_to_memory(std::string_view text, AudioCallback callback,
                                   void *userdata) override {
-    auto const args = make_speak_args(text, SPF_DEFAULT);
+    return speak_to_memory_ex(text, std::move(callback), userdata, {});
+  }
+
+  [[nodiscard]] bool cancels_memory_synthesis() const override {
+    return true;
+  }
+
+  BackendResult<> speak_to_memory_ex(std::string_view text,
+                                     AudioCallback callback, void *userdata,
+                                     const MemoryOptions &options) override {
+    // With a cancel token the voice renders asynchronously so that it can be
+    // purged part way through; otherwise there is nothing to poll for.
+    const bool cancellable = options.cancel.stop_possible();
+    auto const args =
+        make_speak_args(text, cancellable ? SPF_ASYNC : SPF_DEFAULT);
     if (!args)
       return std::unexpected(args.error());
     const auto &wtext = args->text;
@@ -495,6 +525,14 @@ public:
       paused = false;
       if (FAILED(voice->Speak(wtext.c_str(), flags, nullptr)))
         return std::unexpected(BackendError::SpeakFailure);
+      if (cancellable) {
+        while (voice->WaitUntilDone(cancel_poll_ms) == S_FALSE) {
+          if (options.cancel.stop_requested()) {
+            (void)voice->Speak(nullptr, SPF_PURGEBEFORESPEAK, nullptr);
+            return std::unexpected(BackendError::Cancelled);
+          }
+        }
+      }
     }
     if (bit_depth == 0 || bit_depth % 8 != 0)
       return std::unexpected(BackendError::InternalBackendError);
@@ -828,6 +866,16 @@ public:
     return voices[id].language;
   }
 
+  BackendResult<> get_voices(VoiceList &out) override {
+    if (!initialized.test())
+      return std::unexpected(BackendError::NotInitialized);
+    std::shared_lock sl(voices_lock);
+    out.reserve(voices.size());
+    for (const auto &voice : voices)
+      out.add(voice.name, voice.language);
+    return {};
+  }
+
   BackendResult<> set_voice(std::size_t id) override {
     std::scoped_lock lock(voice_lock, voices_lock);
     CComPtr<ISpObjectToken> new_token;
@@ -40,6 +40,22 @@ struct ModulesGuard {
       free_spd_modules(m);
   }
 };
+
+constexpr SPDPriority to_spd_priority(SpeechPriority priority) noexcept {
+  switch (priority) {
+  case SpeechPriority::Important:
+    return SPD_IMPORTANT;
+  case SpeechPriority::Message:
+    return SPD_MESSAGE;
+  case SpeechPriority::Text:
+    return SPD_TEXT;
+  case SpeechPriority::Notification:
+    return SPD_NOTIFICATION;
+  case SpeechPriority::Progress:
+    return SPD_PROGRESS;
+  }
+  return SPD_MESSAGE;
+}
 } // namespace
 
 class SpeechDispatcherBackend final : public TextToSpeechBackend {
@@ -121,7 +137,7 @@ public:
                 SUPPORTS_REFRESH_VOICES | SUPPORTS_COUNT_VOICES |
                 SUPPORTS_GET_VOICE_NAME | SUPPORTS_GET_VOICE_LANGUAGE |
                 SUPPORTS_GET_VOICE | SUPPORTS_SET_VOICE | SUPPORTS_PAUSE |
-                SUPPORTS_RESUME;
+                SUPPORTS_RESUME | SUPPORTS_SPEAK_SSML;
     return features;
   }
 
@@ -152,6 +168,14 @@ public:
   }
 
   BackendResult<> speak(std::string_view text, bool interrupt) override {
+    return speak_with_priority(text, SpeechPriority::Message, interrupt);
+  }
+
+  [[nodiscard]] bool has_native_priorities() const override { return true; }
+
+  BackendResult<> speak_with_priority(std::string_view text,
+                                      SpeechPriority priority,
+                                      bool interrupt) override {
     if (!initialized.test() || conn == nullptr)
       return std::unexpected(BackendError::NotInitialized);
     std::shared_lock sl(state_lock);
@@ -160,12 +184,50 @@ public:
         return std::unexpected(BackendError::InternalBackendError);
       paused.clear();
     }
-    if (const auto res = spd_say(conn, SPD_MESSAGE, text.data()); res < 0) {
+    if (const auto res = spd_say(conn, to_spd_priority(priority), text.data());
+        res < 0) {
       return std::unexpected(BackendError::SpeakFailure);
     }
     return {};
   }
 
+  // The data mode belongs to the connection, so nothing else may speak while
+  // it is switched to SSML.
+  BackendResult<> speak_ssml(std::string_view ssml, bool interrupt) override {
+    if (!initialized.test() || conn == nullptr)
+      return std::unexpected(BackendError::NotInitialized);
+    std::unique_lock ul(state_lock);
+    if (interrupt) {
+      if (spd_stop(conn) != 0)
+        return std::unexpected(BackendError::InternalBackendError);
+      paused.clear();
+    }
+    if (spd_set_data_mode(conn, SPD_DATA_SSML) != 0)
+      return std::unexpected(BackendError::InternalBackendError);
+    const auto res = spd_say(conn, SPD_MESSAGE, ssml.data());
+    if (spd_set_data_mode(conn, SPD_DATA_TEXT) != 0)
+      return std::unexpected(BackendError::BackendEnteredUndefinedState);
+    if (res < 0)
+      return std::unexpected(BackendError::SpeakFailure);
+    return {};
+  }
+
+  BackendResult<> speak_batch(std::span<const Utterance> items) override {
+    if (!initialized.test() || conn == nullptr)
+      return std::unexpected(BackendError::NotInitialized);
+    std::shared_lock sl(state_lock);
+    for (const auto &item : items) {
+      if (item.interrupt) {
+        if (spd_stop(conn) != 0)
+          return std::unexpected(BackendError::InternalBackendError);
+        paused.clear();
+      }
+      if (spd_say(conn, SPD_MESSAGE, item.text.data()) < 0)
+        return std::unexpected(BackendError::SpeakFailure);
+    }
+    return {};
+  }
+
   BackendResult<> output(std::string_view text, bool interrupt) override {
     return speak(text, interrupt);
   }
@@ -283,6 +345,40 @@ public:
     return static_cast<float>(range_convert(raw, -100.0, 100.0, 0.0, 1.0));
   }
 
+  // SSIP has no command setting several parameters, but checking every value
+  // first means a bad one no longer leaves the others half applied.
+  BackendResult<> set_params(const VoiceParams &params) override {
+    if (!initialized.test() || conn == nullptr)
+      return std::unexpected(BackendError::NotInitialized);
+    const auto scale = [](float value) -> std::optional<std::int32_t> {
+      if (value < 0.0F || value > 1.0F ||
+          (!std::isnormal(value) && std::fpclassify(value) != FP_ZERO))
+        return std::nullopt;
+      return static_cast<std::int32_t>(std::round(range_convert(
+          static_cast<double>(value), 0.0, 1.0, -100.0, 100.0)));
+    };
+    std::optional<std::int32_t> volume, rate, pitch;
+    for (auto [in, out] : {std::pair{&params.volume, &volume},
+                           std::pair{&params.rate, &rate},
+                           std::pair{&params.pitch, &pitch}}) {
+      if (!*in)
+        continue;
+      *out = scale(**in);
+      if (!*out)
+        return std::unexpected(BackendError::RangeOutOfBounds);
+    }
+    if (params.voice) {
+      if (const auto r = set_voice(*params.voice); !r)
+        return r;
+    }
+    std::shared_lock sl(state_lock);
+    if ((volume && spd_set_volume(conn, *volume) != 0) ||
+        (rate && spd_set_voice_rate(conn, *rate) != 0) ||
+        (pitch && spd_set_voice_pitch(conn, *pitch) != 0))
+      return std::unexpected(BackendError::InternalBackendError);
+    return {};
+  }
+
   BackendResult<> refresh_voices() override {
     if (conn == nullptr)
       return std::unexpected(BackendError::NotInitialized);
@@ -374,6 +470,16 @@ public:
     return voices[id].language;
   }
 
+  BackendResult<> get_voices(VoiceList &out) override {
+    if (!initialized.test() || conn == nullptr)
+      return std::unexpected(BackendError::NotInitialized);
+    std::shared_lock sl(state_lock);
+    out.reserve(voices.size());
+    for (const auto &voice : voices)
+      out.add({voice.name, " (", voice.module, ")"}, voice.language);
+    return {};
+  }
+
   BackendResult<> set_voice(std::size_t id) override {
     if (!initialized.test() || conn == nullptr)
       return std::unexpected(BackendError::NotInitialized);
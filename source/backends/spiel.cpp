@@ -37,8 +37,8 @@ struct VoiceInfo {
   std::string language;
 };
 
-using VoiceList = std::vector<VoiceInfo>;
-using VoiceListPtr = std::shared_ptr<const VoiceList>;
+using Voices = std::vector<VoiceInfo>;
+using VoiceListPtr = std::shared_ptr<const Voices>;
 
 struct SpeakCommand {
   std::string text;
@@ -163,7 +163,7 @@ private:
   void rebuild_voice_snapshot() {
     if (speaker == nullptr)
       return;
-    auto new_list = std::make_shared<VoiceList>();
+    auto new_list = std::make_shared<Voices>();
     GListModel *model = spiel_speaker_get_voices(speaker);
     const guint n = g_list_model_get_n_items(model);
     for (guint i = 0; i < n; ++i) {
@@ -185,7 +185,7 @@ private:
         preserve.emplace((*old)[i].id, (*old)[i].language);
     }
     VoiceListPtr new_ptr =
-        std::shared_ptr<const VoiceList>(std::move(new_list));
+        std::shared_ptr<const Voices>(std::move(new_list));
     voices_snapshot.store(new_ptr);
     if (preserve.has_value()) {
       for (size_t i = 0; i < new_ptr->size(); ++i) {
@@ -222,7 +222,11 @@ private:
                                       [[maybe_unused]] guint removed,
                                       [[maybe_unused]] guint added,
                                       gpointer ud) {
-    static_cast<SpielBackend *>(ud)->rebuild_voice_snapshot();
+    auto *self = static_cast<SpielBackend *>(ud);
+    self->rebuild_voice_snapshot();
+    // A provider coming or going renumbers the voices.
+    self->voices_changed();
+    self->param_shadow().forget();
   }
 
   static void on_speaker_ready([[maybe_unused]] GObject *obj,
@@ -514,6 +518,18 @@ public:
     return (*snap)[id].language;
   }
 
+  BackendResult<> get_voices(VoiceList &out) override {
+    if (!initialized.test(std::memory_order_acquire))
+      return std::unexpected(BackendError::NotInitialized);
+    const auto snap = voices_snapshot.load(std::memory_order_acquire);
+    if (snap == nullptr)
+      return {};
+    out.reserve(snap->size());
+    for (const auto &voice : *snap)
+      out.add(voice.name, voice.language);
+    return {};
+  }
+
   BackendResult<> set_voice(std::size_t id) override {
     if (!initialized.test(std::memory_order_acquire))
       return std::unexpected(BackendError::NotInitialized);
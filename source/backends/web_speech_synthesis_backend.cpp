@@ -39,6 +39,9 @@ public:
 
   std::string_view get_name() const override { return "Web Speech Synthesis"; }
 
+  // Browsers reject utterances over 32767 characters.
+  [[nodiscard]] std::size_t max_text_bytes() const override { return 32767; }
+
   [[nodiscard]] std::bitset<64> get_features() const override {
     using namespace BackendFeature;
     std::bitset<64> features;
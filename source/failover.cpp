@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "failover.h"
+#include <algorithm>
+#include <condition_variable>
+#include <new>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace {
+// Weight of the newest sample; about the last ten calls matter.
+constexpr float ewma_alpha = 0.2F;
+
+// Errors that say the backend itself is in trouble. Anything else, such as
+// an engine without braille support, moves on to the next member without
+// counting against this one.
+constexpr bool is_fault(BackendError error) noexcept {
+  using enum BackendError;
+  switch (error) {
+  case NotInitialized:
+  case SpeakFailure:
+  case InternalBackendError:
+  case BackendNotAvailable:
+  case Unknown:
+  case BackendEnteredUndefinedState:
+  case TimedOut:
+    return true;
+  default:
+    return false;
+  }
+}
+
+struct Attempt {
+  std::size_t member;
+  UtteranceId id = 0;
+  std::chrono::steady_clock::time_point started;
+  BackendError error = BackendError::TimedOut;
+  bool finished = false;
+  // Given up on at the deadline and already counted as a timeout.
+  bool abandoned = false;
+};
+
+struct Race {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<Attempt> attempts;
+  std::optional<std::size_t> winner;
+};
+} // namespace
+
+Failover::Failover(const std::vector<UtteranceWorker *> &workers,
+                   Options options)
+    : shared(std::make_shared<Shared>()) {
+  shared->options = options;
+  shared->members.reserve(workers.size());
+  for (auto *worker : workers)
+    shared->members.push_back(
+        {.worker = worker, .health = {}, .opened_at = {}});
+}
+
+std::size_t Failover::size() const noexcept { return shared->members.size(); }
+
+Failover::Health Failover::health(std::size_t index) {
+  std::scoped_lock lock(shared->mutex);
+  return shared->members[index].health;
+}
+
+void Failover::record(Shared &shared, std::size_t index, BackendError error,
+                      Clock::duration latency) {
+  const bool fault = is_fault(error);
+  if (!fault && error != BackendError::Ok)
+    return;
+  const auto ms = std::chrono::duration<float, std::milli>(latency).count();
+  std::scoped_lock lock(shared.mutex);
+  auto &member = shared.members[index];
+  auto &h = member.health;
+  const bool first = h.successes + h.failures == 0;
+  ++(fault ? h.failures : h.successes);
+  if (h.open && !fault) {
+    // A member that answers again starts over instead of working off the
+    // history that got it shut out.
+    h = {.error_rate = 0.0F,
+         .latency_ms = ms,
+         .successes = h.successes,
+         .failures = h.failures,
+         .open = false};
+    shared.logger.info("Member {} recovered", index);
+  } else {
+    h.error_rate += ewma_alpha * ((fault ? 1.0F : 0.0F) - h.error_rate);
+    h.latency_ms += first ? ms : ewma_alpha * (ms - h.latency_ms);
+  }
+  const auto &options = shared.options;
+  const bool degraded =
+      h.error_rate >= options.error_threshold ||
+      h.latency_ms >=
+          std::chrono::duration<float, std::milli>(options.latency_threshold)
+              .count();
+  if (!degraded)
+    return;
+  if (!h.open)
+    shared.logger.warn(
+        "Member {} degraded (error rate {:.2f}, latency {:.0f} ms)", index,
+        h.error_rate, h.latency_ms);
+  h.open = true;
+  member.opened_at = Clock::now();
+}
+
+std::vector<std::size_t> Failover::plan() {
+  std::vector<std::size_t> order;
+  std::vector<std::size_t> shut_out;
+  order.reserve(size());
+  const auto now = Clock::now();
+  std::scoped_lock lock(shared->mutex);
+  for (std::size_t i = 0; i < shared->members.size(); ++i) {
+    const auto &member = shared->members[i];
+    if (!member.health.open ||
+        now - member.opened_at >= shared->options.cooldown)
+      order.push_back(i);
+    else
+      shut_out.push_back(i);
+  }
+  // When every circuit is open, a degraded backend still beats silence.
+  order.insert(order.end(), shut_out.begin(), shut_out.end());
+  return order;
+}
+
+BackendResult<std::size_t>
+Failover::submit(std::span<const std::optional<std::string_view>> texts,
+                 bool interrupt, UtteranceWorker::Kind kind) try {
+  const auto order = plan();
+  const auto race = std::make_shared<Race>();
+  race->attempts.resize(order.size());
+  const auto &options = shared->options;
+  std::vector<Attempt> timed_out;
+  std::size_t next = 0;
+  std::unique_lock lock(race->mutex);
+  for (;;) {
+    if (race->winner) {
+      // Whatever is still racing would only say the text a second time.
+      std::vector<Attempt> losers;
+      for (const auto &attempt : std::span(race->attempts).first(next))
+        if (!attempt.finished && attempt.id != 0)
+          losers.push_back(attempt);
+      const auto member = race->attempts[*race->winner].member;
+      lock.unlock();
+      for (const auto &loser : losers)
+        shared->members[loser.member].worker->cancel(loser.id);
+      return member;
+    }
+    const auto now = Clock::now();
+    std::size_t live = 0;
+    auto wake = Clock::time_point::max();
+    Clock::time_point live_since;
+    for (auto &attempt : std::span(race->attempts).first(next)) {
+      if (attempt.finished || attempt.abandoned)
+        continue;
+      if (now - attempt.started >= options.timeout) {
+        attempt.abandoned = true;
+        timed_out.push_back(attempt);
+        continue;
+      }
+      ++live;
+      live_since = attempt.started;
+      wake = std::min(wake, attempt.started + options.timeout);
+    }
+    if (!timed_out.empty()) {
+      lock.unlock();
+      // The next member gets the utterance instead, so this one must not
+      // speak it once it recovers.
+      for (const auto &attempt : timed_out) {
+        shared->members[attempt.member].worker->cancel(attempt.id);
+        record(*shared, attempt.member, BackendError::TimedOut,
+               options.timeout);
+      }
+      timed_out.clear();
+      lock.lock();
+      continue;
+    }
+    const bool hedging = options.hedge.count() > 0 && live == 1 &&
+                         next < order.size();
+    if (next < order.size() &&
+        (live == 0 || (hedging && now - live_since >= options.hedge))) {
+      const auto k = next++;
+      auto &attempt = race->attempts[k];
+      attempt.member = order[k];
+      attempt.started = now;
+      if (!texts[order[k]]) {
+        // Nothing is left to say once this member's filters are done.
+        attempt.finished = true;
+        attempt.error = BackendError::Ok;
+        race->winner = k;
+        continue;
+      }
+      lock.unlock();
+      const auto id = shared->members[order[k]].worker->submit(
+          *texts[order[k]], interrupt, kind,
+          [shared = shared, race, k](UtteranceId, BackendError error) {
+            {
+              // Recorded before the caller can see the result, so the
+              // health it reads afterwards includes this attempt.
+              std::scoped_lock lock(race->mutex);
+              auto &a = race->attempts[k];
+              a.finished = true;
+              a.error = error;
+              if (error == BackendError::Ok && !race->winner)
+                race->winner = k;
+              if (!a.abandoned)
+                record(*shared, a.member, error, Clock::now() - a.started);
+            }
+            race->cv.notify_all();
+          });
+      lock.lock();
+      if (id) {
+        attempt.id = *id;
+      } else {
+        attempt.finished = true;
+        attempt.error = id.error();
+      }
+      continue;
+    }
+    if (live == 0)
+      return std::unexpected(race->attempts.front().error);
+    if (hedging)
+      wake = std::min(wake, live_since + options.hedge);
+    if (wake == Clock::time_point::max())
+      race->cv.wait(lock);
+    else
+      race->cv.wait_until(lock, wake);
+  }
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+}
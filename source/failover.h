@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "utterance_worker.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Sends each utterance to the first healthy backend of a preference list and
+// moves on to the next one when it fails or stalls. Every member keeps an
+// exponentially weighted error rate and latency; once either crosses its
+// threshold the member's circuit opens and it is skipped until a cooldown
+// has passed, after which the next utterance probes it again. With hedging
+// enabled, a member that has not answered within the hedge delay gets a
+// second member racing it.
+class Failover {
+public:
+  struct Options {
+    std::chrono::milliseconds timeout{1000};
+    std::chrono::milliseconds hedge{0};
+    std::chrono::milliseconds latency_threshold{500};
+    std::chrono::milliseconds cooldown{5000};
+    float error_threshold = 0.5F;
+  };
+  struct Health {
+    float error_rate;
+    float latency_ms;
+    std::uint64_t successes;
+    std::uint64_t failures;
+    bool open;
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+  struct Member {
+    UtteranceWorker *worker;
+    Health health{};
+    Clock::time_point opened_at;
+  };
+  // Completions can arrive after the failover is gone, so they hold on to
+  // this rather than to the failover itself.
+  struct Shared {
+    std::mutex mutex;
+    std::vector<Member> members;
+    Options options;
+    LogSource logger{"Failover"};
+  };
+  std::shared_ptr<Shared> shared;
+
+  static void record(Shared &shared, std::size_t index, BackendError error,
+                     Clock::duration latency);
+  [[nodiscard]] std::vector<std::size_t> plan();
+
+public:
+  Failover(const std::vector<UtteranceWorker *> &workers, Options options);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // Returns the index of the member that took the utterance. `texts` holds
+  // the text as each member would speak it, by member index; a member whose
+  // entry is empty takes the utterance without saying anything.
+  BackendResult<std::size_t>
+  submit(std::span<const std::optional<std::string_view>> texts,
+         bool interrupt, UtteranceWorker::Kind kind);
+  [[nodiscard]] Health health(std::size_t index);
+};
@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: MPL-2.0
 
 #include "frozen_registry.h"
+#include "trace.h"
 #include <algorithm>
+#include <bit>
 #include <version>
 #ifdef __cpp_lib_flat_set
 #include <flat_set>
@@ -11,6 +13,41 @@
 #include <ranges>
 #include <simdutf.h>
 
+bool SlotIndex::build(std::span<const std::uint64_t> keys) {
+  slots.clear();
+  if (keys.empty())
+    return true;
+  std::vector<std::uint64_t> sorted(keys.begin(), keys.end());
+  std::ranges::sort(sorted);
+  if (std::ranges::adjacent_find(sorted) != sorted.end())
+    return false;
+  // Half full to start with, which a few seeds nearly always manage; each
+  // doubling makes a clash-free seed easier still to find.
+  constexpr std::size_t largest = std::size_t{1} << 24;
+  constexpr int seeds_per_size = 64;
+  std::vector<std::uint32_t> table;
+  for (auto size = std::bit_ceil(std::max<std::size_t>(keys.size() * 2, 2));
+       size <= largest; size *= 2) {
+    table.assign(size, none);
+    shift = static_cast<unsigned>(64 - std::countr_zero(size));
+    for (int attempt = 0; attempt < seeds_per_size; ++attempt) {
+      seed = (static_cast<std::uint64_t>(attempt) + 1) * 0x9E3779B97F4A7C15;
+      std::ranges::fill(table, none);
+      bool clash = false;
+      for (std::uint32_t i = 0; i < keys.size() && !clash; ++i) {
+        auto &slot_ref = table[slot(keys[i])];
+        clash = slot_ref != none;
+        slot_ref = i;
+      }
+      if (!clash) {
+        slots = std::move(table);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 FrozenRegistry::FrozenRegistry(std::vector<Registration> registrations)
     : refcount(1) {
 #ifdef __cpp_lib_flat_set
@@ -23,10 +60,26 @@ FrozenRegistry::FrozenRegistry(std::vector<Registration> registrations)
     if (!seen.emplace(static_cast<std::uint64_t>(reg.id)).second) {
       continue;
     }
-    entries.push_back(Entry{.reg = std::move(reg), .cached = {}});
+    entries.push_back(Entry{.reg = std::move(reg)});
   }
   std::ranges::stable_sort(entries, std::ranges::greater{},
                            [](const Entry &e) { return e.reg.priority; });
+  std::vector<std::uint64_t> keys;
+  keys.reserve(entries.size());
+  for (const auto &e : entries)
+    keys.push_back(static_cast<std::uint64_t>(e.reg.id));
+  indexed = by_id.build(keys);
+  keys.clear();
+  for (const auto &e : entries)
+    keys.push_back(static_cast<std::uint64_t>(make_backend_id(e.reg.name)));
+  indexed = by_name.build(keys) && indexed;
+  if (!indexed) {
+    static const LogSource log{"Frozen Registry"};
+    log.warn("No collision-free index for {} backends, using linear lookups",
+             entries.size());
+  }
+  empty_cache = std::make_shared<const Cache>(entries.size());
+  cache = empty_cache;
 }
 
 FrozenRegistry *
@@ -49,44 +102,50 @@ void FrozenRegistry::release() noexcept {
     delete this;
 }
 
-FrozenRegistry::Entry *FrozenRegistry::find(BackendId id) noexcept {
-  for (auto &e : entries)
-    if (e.reg.id == id)
-      return &e;
-  return nullptr;
+const FrozenRegistry::Entry *
+FrozenRegistry::find(BackendId id) const noexcept {
+  if (!indexed) {
+    const auto it = std::ranges::find(
+        entries, id, [](const Entry &e) { return e.reg.id; });
+    return it != entries.end() ? &*it : nullptr;
+  }
+  const auto i = by_id.find(static_cast<std::uint64_t>(id));
+  return i != SlotIndex::none && entries[i].reg.id == id ? &entries[i]
+                                                          : nullptr;
 }
 
-FrozenRegistry::Entry *FrozenRegistry::find(std::string_view name) noexcept {
-  for (auto &e : entries)
-    if (e.reg.name == name)
-      return &e;
-  return nullptr;
+const FrozenRegistry::Entry *
+FrozenRegistry::find(std::string_view name) const noexcept {
+  if (!indexed) {
+    const auto it = std::ranges::find(
+        entries, name, [](const Entry &e) -> std::string_view {
+          return e.reg.name;
+        });
+    return it != entries.end() ? &*it : nullptr;
+  }
+  const auto i = by_name.find(static_cast<std::uint64_t>(make_backend_id(name)));
+  return i != SlotIndex::none && entries[i].reg.name == name ? &entries[i]
+                                                              : nullptr;
 }
 
 std::size_t FrozenRegistry::count() const noexcept { return entries.size(); }
 
 bool FrozenRegistry::has(BackendId id) const noexcept {
-  return std::ranges::any_of(entries,
-                             [id](const Entry &e) { return e.reg.id == id; });
+  return find(id) != nullptr;
 }
 
 bool FrozenRegistry::has(std::string_view name) const noexcept {
-  return std::ranges::any_of(
-      entries, [name](const Entry &e) { return e.reg.name == name; });
+  return find(name) != nullptr;
 }
 
 std::string_view FrozenRegistry::name(BackendId id) const noexcept {
-  for (const auto &e : entries)
-    if (e.reg.id == id)
-      return e.reg.name;
-  return {};
+  const auto *e = find(id);
+  return e != nullptr ? std::string_view{e->reg.name} : std::string_view{};
 }
 
 BackendId FrozenRegistry::id(std::string_view name) const noexcept {
-  for (const auto &e : entries)
-    if (e.reg.name == name)
-      return e.reg.id;
-  return BackendId{0};
+  const auto *e = find(name);
+  return e != nullptr ? e->reg.id : BackendId{0};
 }
 
 BackendId FrozenRegistry::id_at(std::size_t index) const noexcept {
@@ -105,76 +164,111 @@ const char *FrozenRegistry::name_at(std::size_t index) const noexcept {
   return index < entries.size() ? entries[index].reg.name.c_str() : nullptr;
 }
 
+bool FrozenRegistry::initialize_at(std::size_t index,
+                                   TextToSpeechBackend &backend) const {
+  const TraceScope trace("initialize", "selection", entries[index].reg.id);
+  return backend.initialize().has_value();
+}
+
 int FrozenRegistry::priority(BackendId id) const noexcept {
-  for (const auto &e : entries)
-    if (e.reg.id == id)
-      return e.reg.priority;
-  return -1;
+  const auto *e = find(id);
+  return e != nullptr ? e->reg.priority : -1;
 }
 
-std::vector<BackendId> FrozenRegistry::list() const {
-  std::vector<BackendId> result;
-  result.reserve(entries.size());
-  for (const auto &e : entries)
-    result.push_back(e.reg.id);
-  return result;
+FrozenRegistry::CachePtr FrozenRegistry::load_cache() const noexcept {
+#ifdef __cpp_lib_atomic_shared_ptr
+  return cache.load(std::memory_order_acquire);
+#else
+  return std::atomic_load_explicit(&cache, std::memory_order_acquire);
+#endif
+}
+
+void FrozenRegistry::store_cache(CachePtr next) noexcept {
+#ifdef __cpp_lib_atomic_shared_ptr
+  cache.store(std::move(next), std::memory_order_release);
+#else
+  std::atomic_store_explicit(&cache, std::move(next),
+                             std::memory_order_release);
+#endif
+}
+
+// Must hold cache_write_mutex. Out of memory, the backend is still handed
+// out, just not shared with later callers.
+void FrozenRegistry::cache_at(
+    std::size_t index, const std::shared_ptr<TextToSpeechBackend> &backend,
+    bool initialized) noexcept try {
+  auto next = std::make_shared<Cache>(*load_cache());
+  (*next)[index] = Cached{.backend = backend, .initialized = initialized};
+  store_cache(std::move(next));
+} catch (const std::bad_alloc &) {
+  static const LogSource log{"Frozen Registry"};
+  log.warn("Out of memory caching backend {}", entries[index].reg.name);
 }
 
 std::shared_ptr<TextToSpeechBackend> FrozenRegistry::get(BackendId id) {
-  std::shared_lock lock(cache_mutex);
-  if (auto *e = find(id))
-    return e->cached.lock();
+  if (const auto *e = find(id))
+    return (*load_cache())[index_of(*e)].backend.lock();
   return nullptr;
 }
 
 std::shared_ptr<TextToSpeechBackend>
 FrozenRegistry::get(std::string_view name) {
-  std::shared_lock lock(cache_mutex);
-  if (auto *e = find(name))
-    return e->cached.lock();
+  if (const auto *e = find(name))
+    return (*load_cache())[index_of(*e)].backend.lock();
   return nullptr;
 }
 
 std::shared_ptr<TextToSpeechBackend> FrozenRegistry::create(BackendId id) {
-  auto *e = find(id);
+  const auto *e = find(id);
   return e != nullptr && e->reg.factory != nullptr ? e->reg.factory() : nullptr;
 }
 
 std::shared_ptr<TextToSpeechBackend>
 FrozenRegistry::create(std::string_view name) {
-  auto *e = find(name);
+  const auto *e = find(name);
   return e != nullptr && e->reg.factory != nullptr ? e->reg.factory() : nullptr;
 }
 
-std::shared_ptr<TextToSpeechBackend> FrozenRegistry::create_best() {
-  for (auto &e : entries) {
-    if (!e.reg.factory)
+std::vector<std::size_t>
+FrozenRegistry::selection_order(const Defer &defer) const {
+  std::vector<std::size_t> order;
+  std::vector<std::size_t> deferred;
+  order.reserve(entries.size());
+  for (std::size_t index = 0; index < entries.size(); ++index) {
+    if (!entries[index].reg.factory)
       continue;
-    if (auto b = e.reg.factory(); b && b->initialize()) {
+    (defer && defer(index) ? deferred : order).push_back(index);
+  }
+  order.insert(order.end(), deferred.begin(), deferred.end());
+  return order;
+}
+
+std::shared_ptr<TextToSpeechBackend>
+FrozenRegistry::create_best(const Defer &defer) {
+  for (const auto index : selection_order(defer)) {
+    if (auto b = entries[index].reg.factory(); b && initialize_at(index, *b)) {
       return b;
     }
   }
   return nullptr;
 }
 
-std::shared_ptr<TextToSpeechBackend> FrozenRegistry::acquire_entry(Entry *e) {
+std::shared_ptr<TextToSpeechBackend>
+FrozenRegistry::acquire_entry(const Entry *e) {
   if (e == nullptr)
     return nullptr;
-  {
-    std::shared_lock lock(cache_mutex);
-    if (auto cached = e->cached.lock(); cached != nullptr)
-      return cached;
-  }
+  const auto index = index_of(*e);
+  if (auto cached = (*load_cache())[index].backend.lock(); cached != nullptr)
+    return cached;
   if (!e->reg.factory)
     return nullptr;
   auto backend = e->reg.factory();
   if (backend == nullptr)
     return nullptr;
-  std::unique_lock lock(cache_mutex);
-  if (auto cached = e->cached.lock(); cached != nullptr)
+  std::scoped_lock lock(cache_write_mutex);
+  if (auto cached = (*load_cache())[index].backend.lock(); cached != nullptr)
     return cached;
-  e->cached = backend;
-  e->initialized = false;
+  cache_at(index, backend, false);
   return backend;
 }
 
@@ -187,38 +281,44 @@ FrozenRegistry::acquire(std::string_view name) {
   return acquire_entry(find(name));
 }
 
-std::shared_ptr<TextToSpeechBackend> FrozenRegistry::acquire_best() {
-  {
-    std::shared_lock lock(cache_mutex);
-    for (const auto &e : entries) {
-      if (auto cached = e.cached.lock(); cached != nullptr && e.initialized) {
-        return cached;
-      }
+std::shared_ptr<TextToSpeechBackend> FrozenRegistry::cached_best() {
+  for (const auto &c : *load_cache()) {
+    if (auto cached = c.backend.lock(); cached != nullptr && c.initialized) {
+      return cached;
     }
   }
-  for (auto &e : entries) {
-    if (!e.reg.factory)
-      continue;
-    auto backend = e.reg.factory();
-    if (backend == nullptr || !backend->initialize())
+  return nullptr;
+}
+
+std::shared_ptr<TextToSpeechBackend>
+FrozenRegistry::install_best(std::size_t index,
+                             std::shared_ptr<TextToSpeechBackend> backend) {
+  std::scoped_lock lock(cache_write_mutex);
+  const auto current = load_cache();
+  const auto &c = (*current)[index];
+  if (auto cached = c.backend.lock(); cached != nullptr && c.initialized) {
+    return cached;
+  }
+  cache_at(index, backend, true);
+  return backend;
+}
+
+std::shared_ptr<TextToSpeechBackend>
+FrozenRegistry::acquire_best(const Defer &defer) {
+  if (auto cached = cached_best(); cached != nullptr)
+    return cached;
+  for (const auto index : selection_order(defer)) {
+    auto backend = entries[index].reg.factory();
+    if (backend == nullptr || !initialize_at(index, *backend))
       continue;
-    std::unique_lock lock(cache_mutex);
-    if (auto cached = e.cached.lock(); cached != nullptr && e.initialized) {
-      return cached;
-    }
-    e.cached = backend;
-    e.initialized = true;
-    return backend;
+    return install_best(index, std::move(backend));
   }
   return nullptr;
 }
 
 void FrozenRegistry::clear_cache() {
-  std::unique_lock lock(cache_mutex);
-  for (auto &e : entries) {
-    e.cached.reset();
-    e.initialized = false;
-  }
+  std::scoped_lock lock(cache_write_mutex);
+  store_cache(empty_cache);
 }
 
 RegistryBuilder::RegistryBuilder()
@@ -5,13 +5,47 @@
 #include "logging.h"
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <shared_mutex>
+#include <mutex>
+#include <span>
 #include <string_view>
 #include <vector>
 
+// Maps distinct 64-bit keys to small indices with a single probe. build()
+// searches for a seed under which every key gets a slot of its own, so a
+// lookup hashes once and compares once. The caller confirms the entry it
+// gets back, since keys that were never added land on arbitrary slots.
+class SlotIndex {
+  std::vector<std::uint32_t> slots;
+  std::uint64_t seed = 0;
+  unsigned shift = 63;
+
+  [[nodiscard]] std::size_t slot(std::uint64_t key) const noexcept {
+    // The splitmix64 finalizer; a bijection, so distinct keys stay distinct.
+    key ^= seed;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EB;
+    return static_cast<std::size_t>((key ^ (key >> 31)) >> shift);
+  }
+
+public:
+  static constexpr auto none = static_cast<std::uint32_t>(-1);
+  // False if the keys repeat or no seed separated them, leaving every lookup
+  // a miss.
+  bool build(std::span<const std::uint64_t> keys);
+  [[nodiscard]] std::uint32_t find(std::uint64_t key) const noexcept {
+    return slots.empty() ? none : slots[slot(key)];
+  }
+};
+
 class FrozenRegistry {
 public:
+  // Picks out entries that best-backend selection should try only once all
+  // the others have failed, such as those known not to be running.
+  using Defer = std::function<bool(std::size_t index)>;
+
   [[nodiscard]] static FrozenRegistry *
   create(std::vector<Registration> registrations);
   [[nodiscard]] static FrozenRegistry *global();
@@ -26,36 +60,81 @@ public:
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
   create_at(std::size_t index);
   [[nodiscard]] const char *name_at(std::size_t index) const noexcept;
+  // Initializes a best-backend candidate made for entry `index`, traced.
+  [[nodiscard]] bool initialize_at(std::size_t index,
+                                   TextToSpeechBackend &backend) const;
   [[nodiscard]] int priority(BackendId id) const noexcept;
-  [[nodiscard]] std::vector<BackendId> list() const;
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend> get(BackendId id);
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend> get(std::string_view name);
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend> create(BackendId id);
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
   create(std::string_view name);
-  [[nodiscard]] std::shared_ptr<TextToSpeechBackend> create_best();
+  // Indices of the entries that have a factory, in the order best-backend
+  // selection tries them: by priority, except that entries `defer` picks out
+  // come after all the rest.
+  [[nodiscard]] std::vector<std::size_t>
+  selection_order(const Defer &defer = nullptr) const;
+  [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
+  create_best(const Defer &defer = nullptr);
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend> acquire(BackendId id);
   [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
   acquire(std::string_view name);
-  [[nodiscard]] std::shared_ptr<TextToSpeechBackend> acquire_best();
+  [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
+  acquire_best(const Defer &defer = nullptr);
+  // The two halves of acquire_best() around initializing candidates, for
+  // callers that initialize them some other way: the highest-priority cached
+  // instance that is initialized, if any, and the instance to hand out once
+  // entry `index` has initialized `backend`, which is `backend` unless
+  // another caller cached one first.
+  [[nodiscard]] std::shared_ptr<TextToSpeechBackend> cached_best();
+  [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
+  install_best(std::size_t index, std::shared_ptr<TextToSpeechBackend> backend);
   void clear_cache();
 
 private:
   struct Entry {
     Registration reg;
-    std::weak_ptr<TextToSpeechBackend> cached;
+  };
+  // Instances handed out by acquire(), by entry index.
+  struct Cached {
+    std::weak_ptr<TextToSpeechBackend> backend;
     bool initialized = false;
   };
+  using Cache = std::vector<Cached>;
+  using CachePtr = std::shared_ptr<const Cache>;
   explicit FrozenRegistry(std::vector<Registration> registrations);
   ~FrozenRegistry() = default;
   FrozenRegistry(const FrozenRegistry &) = delete;
   FrozenRegistry &operator=(const FrozenRegistry &) = delete;
-  [[nodiscard]] Entry *find(BackendId id) noexcept;
-  [[nodiscard]] Entry *find(std::string_view name) noexcept;
-  [[nodiscard]] std::shared_ptr<TextToSpeechBackend> acquire_entry(Entry *e);
+  [[nodiscard]] const Entry *find(BackendId id) const noexcept;
+  [[nodiscard]] const Entry *find(std::string_view name) const noexcept;
+  [[nodiscard]] std::size_t index_of(const Entry &e) const noexcept {
+    return static_cast<std::size_t>(&e - entries.data());
+  }
+  [[nodiscard]] CachePtr load_cache() const noexcept;
+  void store_cache(CachePtr next) noexcept;
+  void cache_at(std::size_t index,
+                const std::shared_ptr<TextToSpeechBackend> &backend,
+                bool initialized) noexcept;
+  [[nodiscard]] std::shared_ptr<TextToSpeechBackend>
+  acquire_entry(const Entry *e);
   std::atomic_unsigned_lock_free refcount;
   std::vector<Entry> entries;
-  mutable std::shared_mutex cache_mutex;
+  // By id and by make_backend_id() of the name. Should either fail to build,
+  // lookups scan `entries` instead.
+  SlotIndex by_id;
+  SlotIndex by_name;
+  bool indexed = false;
+  // Readers take the current snapshot without locking; writers copy it,
+  // change the copy and publish it, one at a time under cache_write_mutex.
+  // Clearing publishes `empty_cache`, made up front so it cannot fail.
+#ifdef __cpp_lib_atomic_shared_ptr
+  std::atomic<CachePtr> cache;
+#else
+  CachePtr cache;
+#endif
+  CachePtr empty_cache;
+  std::mutex cache_write_mutex;
 };
 
 enum class BuilderResult {
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "latency_stats.h"
+#include "prism.h"
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <utility>
+
+static_assert(stats_operation_count == PRISM_STATS_OPERATION_COUNT);
+static_assert(stats_layer_count == PRISM_STATS_LAYER_COUNT);
+static_assert(stats_bucket_count == PRISM_STATS_BUCKET_COUNT);
+
+const char *stats_operation_name(StatsOperation op) noexcept {
+  constexpr auto names = std::to_array<const char *>(
+      {"initialize", "speak", "speak_to_memory", "braille", "output", "stop",
+       "pause", "resume", "is_speaking", "set_parameter", "get_parameter",
+       "voices", "probe"});
+  static_assert(names.size() == stats_operation_count);
+  return names[std::to_underlying(op)];
+}
+
+const char *stats_layer_name(StatsLayer layer) noexcept {
+  return layer == StatsLayer::Api ? "api" : "engine";
+}
+
+std::size_t stats_bucket_index(std::uint64_t us) noexcept {
+  if (us < stats_linear_buckets)
+    return us;
+  const auto exponent = static_cast<std::size_t>(std::bit_width(us) - 1);
+  if (exponent >= 32)
+    return stats_bucket_count - 1;
+  const auto sub = (us >> (exponent - 2)) & (stats_sub_buckets - 1);
+  return stats_linear_buckets + ((exponent - 3) * stats_sub_buckets) + sub;
+}
+
+std::uint64_t stats_bucket_floor(std::size_t index) noexcept {
+  if (index < stats_linear_buckets)
+    return index;
+  const auto offset = index - stats_linear_buckets;
+  const auto exponent = 3 + (offset / stats_sub_buckets);
+  const auto sub = offset % stats_sub_buckets;
+  return std::uint64_t{stats_sub_buckets + sub} << (exponent - 2);
+}
+
+LatencyStats::Shard::~Shard() {
+  for (auto &series : series)
+    delete series.load(std::memory_order_relaxed);
+}
+
+// Hands the shard back when its thread exits.
+struct LatencyStats::ThreadShard {
+  Shard *shard = nullptr;
+  ThreadShard() = default;
+  ThreadShard(const ThreadShard &) = delete;
+  ThreadShard &operator=(const ThreadShard &) = delete;
+  ThreadShard(ThreadShard &&) = delete;
+  ThreadShard &operator=(ThreadShard &&) = delete;
+  ~ThreadShard() {
+    // Shards only come from the statistics, so they exist here.
+    if (shard != nullptr)
+      latency_stats()->release(shard);
+  }
+};
+
+std::size_t LatencyStats::series_index(std::size_t slot, StatsOperation op,
+                                       StatsLayer layer) noexcept {
+  return (((slot * stats_operation_count) + std::to_underlying(op)) *
+          stats_layer_count) +
+         std::to_underlying(layer);
+}
+
+std::optional<std::size_t> LatencyStats::slot(BackendId backend,
+                                              bool insert) noexcept {
+  const auto id = std::to_underlying(backend);
+  if (id == 0)
+    return std::nullopt;
+  for (std::size_t probe = 0; probe < max_backends; ++probe) {
+    const auto i = (id + probe) % max_backends;
+    auto current = ids[i].load(std::memory_order_acquire);
+    if (current == 0) {
+      if (!insert)
+        return std::nullopt;
+      if (ids[i].compare_exchange_strong(current, id,
+                                         std::memory_order_acq_rel))
+        return i;
+    }
+    if (current == id)
+      return i;
+  }
+  return std::nullopt;
+}
+
+LatencyStats::Shard *LatencyStats::local_shard() noexcept {
+  thread_local ThreadShard local;
+  if (local.shard != nullptr)
+    return local.shard;
+  try {
+    std::scoped_lock lock(shards_mutex);
+    if (!idle.empty()) {
+      local.shard = idle.back();
+      idle.pop_back();
+    } else {
+      shards.push_back(std::make_unique<Shard>());
+      local.shard = shards.back().get();
+    }
+  } catch (...) {
+    return nullptr;
+  }
+  return local.shard;
+}
+
+void LatencyStats::release(Shard *shard) noexcept {
+  try {
+    std::scoped_lock lock(shards_mutex);
+    idle.push_back(shard);
+  } catch (...) {
+    // The shard is only lost for reuse; its counts are still read.
+  }
+}
+
+void LatencyStats::record(BackendId backend, StatsOperation op,
+                          StatsLayer layer,
+                          std::chrono::nanoseconds elapsed) noexcept {
+  const auto i = slot(backend, true);
+  if (!i)
+    return;
+  auto *shard = local_shard();
+  if (shard == nullptr)
+    return;
+  auto &entry = shard->series[series_index(*i, op, layer)];
+  auto *series = entry.load(std::memory_order_relaxed);
+  if (series == nullptr) {
+    series = new (std::nothrow) Series{};
+    if (series == nullptr)
+      return;
+    entry.store(series, std::memory_order_release);
+  }
+  const auto us = static_cast<std::uint64_t>(
+      std::max<std::int64_t>(elapsed.count() / 1000, 0));
+  // Only this thread writes to its shard, so there is no need for an atomic
+  // read-modify-write.
+  const auto bump = [](std::atomic<std::uint64_t> &value, std::uint64_t by) {
+    value.store(value.load(std::memory_order_relaxed) + by,
+                std::memory_order_relaxed);
+  };
+  bump(series->count, 1);
+  bump(series->sum_us, us);
+  bump(series->buckets[stats_bucket_index(us)], 1);
+}
+
+void LatencyStats::merge(std::size_t series, LatencyHistogram &out) {
+  for (const auto &shard : shards) {
+    const auto *s = shard->series[series].load(std::memory_order_acquire);
+    if (s == nullptr)
+      continue;
+    out.count += s->count.load(std::memory_order_relaxed);
+    out.sum_us += s->sum_us.load(std::memory_order_relaxed);
+    for (std::size_t b = 0; b < stats_bucket_count; ++b)
+      out.buckets[b] += s->buckets[b].load(std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram LatencyStats::snapshot(BackendId backend, StatsOperation op,
+                                        StatsLayer layer) {
+  LatencyHistogram out{};
+  const auto i = slot(backend, false);
+  if (!i)
+    return out;
+  const auto series = series_index(*i, op, layer);
+  std::scoped_lock lock(shards_mutex);
+  merge(series, out);
+  if (baseline.empty() || !baseline[series])
+    return out;
+  // Counters only grow, but a sample can land between the reads of its
+  // count and its bucket, so clamp rather than wrap.
+  const auto minus = [](std::uint64_t a, std::uint64_t b) {
+    return a > b ? a - b : 0;
+  };
+  const auto &base = *baseline[series];
+  out.count = minus(out.count, base.count);
+  out.sum_us = minus(out.sum_us, base.sum_us);
+  for (std::size_t b = 0; b < stats_bucket_count; ++b)
+    out.buckets[b] = minus(out.buckets[b], base.buckets[b]);
+  return out;
+}
+
+void LatencyStats::reset() {
+  std::scoped_lock lock(shards_mutex);
+  baseline.resize(series_count);
+  for (std::size_t series = 0; series < series_count; ++series) {
+    LatencyHistogram totals{};
+    merge(series, totals);
+    if (totals.count == 0 && !baseline[series])
+      continue;
+    if (!baseline[series])
+      baseline[series] = std::make_unique<LatencyHistogram>();
+    *baseline[series] = totals;
+  }
+}
+
+LatencyStats *latency_stats() noexcept {
+  // Never destroyed, since threads may still record during exit.
+  static auto *instance = new (std::nothrow) LatencyStats;
+  return instance;
+}
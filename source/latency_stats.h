@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend_catalog.h"
+#include "trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Kept in sync with PrismStatsOperation and PrismStatsLayer.
+enum class StatsOperation : std::uint8_t {
+  Initialize,
+  Speak,
+  SpeakToMemory,
+  Braille,
+  Output,
+  Stop,
+  Pause,
+  Resume,
+  IsSpeaking,
+  SetParameter,
+  GetParameter,
+  Voices,
+  Probe,
+};
+inline constexpr std::size_t stats_operation_count = 13;
+
+// Api is the whole call as the application sees it; Engine is the time spent
+// inside a custom or plugin backend's own callbacks.
+enum class StatsLayer : std::uint8_t { Api, Engine };
+inline constexpr std::size_t stats_layer_count = 2;
+
+// Log-linear latency buckets in microseconds: exact below 8, then four
+// buckets per power of two up to 2^32 us, so no bucket is wider than a
+// quarter of its lower bound.
+inline constexpr std::size_t stats_linear_buckets = 8;
+inline constexpr std::size_t stats_sub_buckets = 4;
+inline constexpr std::size_t stats_bucket_count =
+    stats_linear_buckets + (32 - 3) * stats_sub_buckets;
+
+[[nodiscard]] const char *stats_operation_name(StatsOperation op) noexcept;
+[[nodiscard]] const char *stats_layer_name(StatsLayer layer) noexcept;
+[[nodiscard]] std::size_t stats_bucket_index(std::uint64_t us) noexcept;
+[[nodiscard]] std::uint64_t stats_bucket_floor(std::size_t index) noexcept;
+
+struct LatencyHistogram {
+  std::uint64_t count;
+  std::uint64_t sum_us;
+  std::array<std::uint64_t, stats_bucket_count> buckets;
+};
+
+// Process-wide latency histograms per backend, operation, and layer. Every
+// thread records into a shard of its own with plain relaxed stores, so the
+// hot path never locks or contends; readers sum the shards. A reset does not
+// touch the shards either, it only moves the baseline that snapshots are
+// taken against.
+class LatencyStats {
+public:
+  static constexpr std::size_t max_backends = 64;
+
+private:
+  static constexpr std::size_t series_count =
+      max_backends * stats_operation_count * stats_layer_count;
+  struct Series {
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> sum_us;
+    std::array<std::atomic<std::uint64_t>, stats_bucket_count> buckets;
+  };
+  struct Shard {
+    // Allocated by the owning thread on first use and never freed, so
+    // readers only need the pointer to be published.
+    std::array<std::atomic<Series *>, series_count> series{};
+    ~Shard();
+  };
+  struct ThreadShard;
+
+  std::array<std::atomic<std::uint64_t>, max_backends> ids{};
+  std::mutex shards_mutex;
+  std::vector<std::unique_ptr<Shard>> shards;
+  // Shards of threads that have exited, handed to the next new thread. Their
+  // counts stay in place.
+  std::vector<Shard *> idle;
+  std::vector<std::unique_ptr<LatencyHistogram>> baseline;
+
+  [[nodiscard]] std::optional<std::size_t> slot(BackendId backend,
+                                                bool insert) noexcept;
+  [[nodiscard]] Shard *local_shard() noexcept;
+  void release(Shard *shard) noexcept;
+  void merge(std::size_t series, LatencyHistogram &out);
+  static std::size_t series_index(std::size_t slot, StatsOperation op,
+                                  StatsLayer layer) noexcept;
+
+public:
+  void record(BackendId backend, StatsOperation op, StatsLayer layer,
+              std::chrono::nanoseconds elapsed) noexcept;
+  [[nodiscard]] LatencyHistogram snapshot(BackendId backend, StatsOperation op,
+                                          StatsLayer layer);
+  void reset();
+};
+
+// Null if the statistics could not be allocated, in which case nothing is
+// recorded.
+LatencyStats *latency_stats() noexcept;
+
+// Records the lifetime of the scope, and traces it while tracing is on.
+class LatencyScope {
+  using Clock = std::chrono::steady_clock;
+  BackendId backend;
+  StatsOperation op;
+  StatsLayer layer;
+  Clock::time_point start = Clock::now();
+
+public:
+  LatencyScope(BackendId backend, StatsOperation op,
+               StatsLayer layer = StatsLayer::Api) noexcept
+      : backend(backend), op(op), layer(layer) {}
+  ~LatencyScope() {
+    const auto end = Clock::now();
+    if (auto *stats = latency_stats(); stats != nullptr)
+      stats->record(backend, op, layer, end - start);
+    if (tracing())
+      trace_event(stats_operation_name(op), stats_layer_name(layer), backend,
+                  start, end);
+  }
+  LatencyScope(const LatencyScope &) = delete;
+  LatencyScope &operator=(const LatencyScope &) = delete;
+  LatencyScope(LatencyScope &&) = delete;
+  LatencyScope &operator=(LatencyScope &&) = delete;
+};
@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "phrase_pack.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <simdutf.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr char pack_magic[8] = {'P', 'R', 'I', 'S', 'M', 'P', 'A', 'K'};
+constexpr std::uint32_t pack_version = 1;
+constexpr std::uint32_t pack_byte_order = 0x01020304;
+// Sample blocks start on a cache line so that the first read of a phrase
+// touches as few lines, and as few pages, as possible.
+constexpr std::uint64_t block_alignment = 64;
+
+static_assert(sizeof(PhrasePackHeader) == 32);
+static_assert(sizeof(PhrasePackEntry) == 48);
+
+std::uint64_t phrase_hash(std::string_view text) noexcept {
+  std::uint64_t hash = 0xCBF29CE484222325;
+  for (const char c : text) {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= 0x100000001B3;
+  }
+  return hash;
+}
+
+std::uint64_t align_up(std::uint64_t offset) noexcept {
+  return (offset + block_alignment - 1) & ~(block_alignment - 1);
+}
+
+std::string_view entry_text(const std::byte *base,
+                            const PhrasePackEntry &entry) noexcept {
+  return {reinterpret_cast<const char *>(base + entry.text_offset),
+          entry.text_length};
+}
+
+// Every offset is checked once at open, so lookups can trust the index.
+bool valid_entry(const PhrasePackEntry &entry, std::uint64_t size) noexcept {
+  if (entry.text_offset > size || entry.text_length > size - entry.text_offset)
+    return false;
+  if (entry.frames == 0)
+    return true;
+  if (entry.channels == 0 || entry.sample_rate == 0 ||
+      entry.samples_offset % alignof(float) != 0 ||
+      entry.samples_offset > size)
+    return false;
+  const auto room = (size - entry.samples_offset) / sizeof(float);
+  return entry.frames <= room / entry.channels;
+}
+
+bool entry_less(const std::byte *base, const PhrasePackEntry &a,
+                const PhrasePackEntry &b) noexcept {
+  if (a.hash != b.hash)
+    return a.hash < b.hash;
+  return entry_text(base, a) < entry_text(base, b);
+}
+
+#ifdef _WIN32
+std::pair<const std::byte *, std::size_t> map_file(std::string_view path) {
+  std::u16string wide(simdutf::utf16_length_from_utf8(path.data(), path.size()),
+                      u'\0');
+  if (simdutf::convert_utf8_to_utf16le(path.data(), path.size(), wide.data()) ==
+      0)
+    return {nullptr, 0};
+  const HANDLE file = CreateFileW(reinterpret_cast<LPCWSTR>(wide.c_str()),
+                                  GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return {nullptr, 0};
+  LARGE_INTEGER size{};
+  if (GetFileSizeEx(file, &size) == 0 || size.QuadPart <= 0 ||
+      static_cast<std::uint64_t>(size.QuadPart) >
+          std::numeric_limits<std::size_t>::max()) {
+    CloseHandle(file);
+    return {nullptr, 0};
+  }
+  const HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr)
+    return {nullptr, 0};
+  // The view keeps the mapping, and the mapping the file, alive.
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr)
+    return {nullptr, 0};
+  return {static_cast<const std::byte *>(view),
+          static_cast<std::size_t>(size.QuadPart)};
+}
+
+void unmap_file(const std::byte *base, std::size_t) {
+  UnmapViewOfFile(base);
+}
+
+std::filesystem::path native_path(std::string_view path) {
+  return std::filesystem::path(std::u8string_view(
+      reinterpret_cast<const char8_t *>(path.data()), path.size()));
+}
+#else
+std::pair<const std::byte *, std::size_t> map_file(std::string_view path) {
+  const std::string owned{path};
+  const int fd = ::open(owned.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return {nullptr, 0};
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return {nullptr, 0};
+  }
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void *view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return {nullptr, 0};
+  return {static_cast<const std::byte *>(view), size};
+}
+
+void unmap_file(const std::byte *base, std::size_t size) {
+  munmap(const_cast<std::byte *>(base), size);
+}
+
+std::filesystem::path native_path(std::string_view path) {
+  return std::filesystem::path(path);
+}
+#endif
+
+struct Rendered {
+  std::string_view text;
+  PhrasePackEntry entry;
+};
+
+BackendResult<> render_phrases(TextToSpeechBackend &backend,
+                               std::span<Rendered> phrases,
+                               std::ofstream &out) {
+  std::vector<float> samples;
+  std::string text;
+  std::uint64_t offset = sizeof(PhrasePackHeader);
+  for (auto &phrase : phrases) {
+    samples.clear();
+    std::size_t channels = 0;
+    std::size_t sample_rate = 0;
+    BackendError failure = BackendError::Ok;
+    // Backends rely on the text being followed by a NUL.
+    text.assign(phrase.text);
+    const auto r = backend.speak_to_memory(
+        text,
+        [&](void *, const float *data, std::size_t count, std::size_t ch,
+            std::size_t sr) {
+          if (channels == 0) {
+            channels = ch;
+            sample_rate = sr;
+          }
+          if (failure != BackendError::Ok)
+            return;
+          if (ch != channels || sr != sample_rate) {
+            failure = BackendError::InvalidAudioFormat;
+            return;
+          }
+          try {
+            samples.insert(samples.end(), data, data + count);
+          } catch (const std::bad_alloc &) {
+            failure = BackendError::MemoryFailure;
+          }
+        },
+        nullptr);
+    if (!r)
+      return r;
+    if (failure != BackendError::Ok)
+      return std::unexpected(failure);
+    auto &entry = phrase.entry;
+    entry.hash = phrase_hash(phrase.text);
+    entry.text_length = static_cast<std::uint32_t>(phrase.text.size());
+    if (channels == 0 || samples.size() < channels)
+      continue;
+    const auto trimmed =
+        trim_silence_rms_gate_inplace(samples, channels, sample_rate);
+    const auto view = trimmed.view.first(trimmed.view.size() / channels *
+                                         channels);
+    const auto start = align_up(offset);
+    static constexpr char padding[block_alignment]{};
+    out.write(padding, static_cast<std::streamsize>(start - offset));
+    out.write(reinterpret_cast<const char *>(view.data()),
+              static_cast<std::streamsize>(view.size_bytes()));
+    entry.samples_offset = start;
+    entry.frames = view.size() / channels;
+    entry.channels = static_cast<std::uint32_t>(channels);
+    entry.sample_rate = static_cast<std::uint32_t>(sample_rate);
+    offset = start + view.size_bytes();
+  }
+  return {};
+}
+} // namespace
+
+BackendResult<std::unique_ptr<PhrasePack>>
+PhrasePack::open(std::string_view path) {
+  const auto [base, size] = map_file(path);
+  if (base == nullptr)
+    return std::unexpected(BackendError::IoFailure);
+  const auto fail = [base, size](BackendError error) {
+    unmap_file(base, size);
+    return std::unexpected(error);
+  };
+  PhrasePackHeader header{};
+  if (size < sizeof(header))
+    return fail(BackendError::IoFailure);
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, pack_magic, sizeof(pack_magic)) != 0 ||
+      header.version != pack_version || header.byte_order != pack_byte_order ||
+      header.index_offset % alignof(PhrasePackEntry) != 0 ||
+      header.index_offset > size ||
+      header.count > (size - header.index_offset) / sizeof(PhrasePackEntry))
+    return fail(BackendError::IoFailure);
+  const std::span entries{
+      reinterpret_cast<const PhrasePackEntry *>(base + header.index_offset),
+      static_cast<std::size_t>(header.count)};
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (!valid_entry(entries[i], size))
+      return fail(BackendError::IoFailure);
+    if (i != 0 && !entry_less(base, entries[i - 1], entries[i]))
+      return fail(BackendError::IoFailure);
+  }
+  auto *pack = new (std::nothrow) PhrasePack(base, size, entries);
+  if (pack == nullptr)
+    return fail(BackendError::MemoryFailure);
+  return std::unique_ptr<PhrasePack>(pack);
+}
+
+PhrasePack::~PhrasePack() { unmap_file(base, size); }
+
+std::optional<PhraseAudio> PhrasePack::find(std::string_view text) const {
+  const auto hash = phrase_hash(text);
+  auto it = std::ranges::lower_bound(entries, hash, {},
+                                     &PhrasePackEntry::hash);
+  for (; it != entries.end() && it->hash == hash; ++it) {
+    if (entry_text(base, *it) != text)
+      continue;
+    const auto *samples =
+        reinterpret_cast<const float *>(base + it->samples_offset);
+    return PhraseAudio{
+        .samples = {samples, static_cast<std::size_t>(it->frames) *
+                                 it->channels},
+        .channels = it->channels,
+        .sample_rate = it->sample_rate};
+  }
+  return std::nullopt;
+}
+
+BackendResult<>
+write_phrase_pack(TextToSpeechBackend &backend, std::string_view path,
+                  std::span<const std::string_view> phrases) try {
+  std::vector<Rendered> rendered;
+  rendered.reserve(phrases.size());
+  for (const auto text : phrases) {
+    if (text.empty() || text.size() > std::numeric_limits<std::uint32_t>::max())
+      return std::unexpected(BackendError::InvalidParam);
+    rendered.push_back({.text = text, .entry = {}});
+  }
+  std::ranges::sort(rendered, {}, &Rendered::text);
+  const auto dupes = std::ranges::unique(rendered, {}, &Rendered::text);
+  rendered.erase(dupes.begin(), dupes.end());
+  const auto target = native_path(path);
+  auto staging = target;
+  staging += ".tmp";
+  std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+  if (!out)
+    return std::unexpected(BackendError::IoFailure);
+  const auto discard = [&](BackendError error) {
+    out.close();
+    std::error_code ec;
+    std::filesystem::remove(staging, ec);
+    return std::unexpected(error);
+  };
+  PhrasePackHeader header{};
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (const auto r = render_phrases(backend, rendered, out); !r)
+    return discard(r.error());
+  auto offset = static_cast<std::uint64_t>(out.tellp());
+  for (auto &phrase : rendered) {
+    phrase.entry.text_offset = offset;
+    out.write(phrase.text.data(),
+              static_cast<std::streamsize>(phrase.text.size()));
+    offset += phrase.text.size();
+  }
+  const auto index_offset = align_up(offset);
+  static constexpr char padding[block_alignment]{};
+  out.write(padding, static_cast<std::streamsize>(index_offset - offset));
+  // Sorted the way lookups search: by hash, then by text.
+  std::ranges::sort(rendered, [](const Rendered &a, const Rendered &b) {
+    if (a.entry.hash != b.entry.hash)
+      return a.entry.hash < b.entry.hash;
+    return a.text < b.text;
+  });
+  for (const auto &phrase : rendered)
+    out.write(reinterpret_cast<const char *>(&phrase.entry),
+              sizeof(phrase.entry));
+  std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+  header.version = pack_version;
+  header.byte_order = pack_byte_order;
+  header.count = rendered.size();
+  header.index_offset = index_offset;
+  out.seekp(0);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.close();
+  if (!out)
+    return discard(BackendError::IoFailure);
+  std::error_code ec;
+  std::filesystem::rename(staging, target, ec);
+  if (ec)
+    return discard(BackendError::IoFailure);
+  return {};
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+} catch (const std::filesystem::filesystem_error &) {
+  return std::unexpected(BackendError::IoFailure);
+}
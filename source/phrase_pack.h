@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+// On-disk layout, in native byte order: the header, the sample blocks, the
+// phrase texts, then the index sorted by hash and text. Sample blocks and the
+// index are aligned so that both can be used in place from the mapping.
+struct PhrasePackHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint64_t count;
+  std::uint64_t index_offset;
+};
+
+struct PhrasePackEntry {
+  std::uint64_t hash;
+  std::uint64_t text_offset;
+  std::uint64_t samples_offset;
+  std::uint64_t frames;
+  std::uint32_t text_length;
+  std::uint32_t channels;
+  std::uint32_t sample_rate;
+  std::uint32_t reserved;
+};
+
+struct PhraseAudio {
+  std::span<const float> samples;
+  std::size_t channels;
+  std::size_t sample_rate;
+};
+
+// A phrase pack mapped read-only into memory. Lookups return spans into the
+// mapping, so they stay valid for as long as the pack is open.
+class PhrasePack {
+  const std::byte *base;
+  std::size_t size;
+  std::span<const PhrasePackEntry> entries;
+
+  PhrasePack(const std::byte *base, std::size_t size,
+             std::span<const PhrasePackEntry> entries)
+      : base(base), size(size), entries(entries) {}
+
+public:
+  static BackendResult<std::unique_ptr<PhrasePack>> open(std::string_view path);
+  ~PhrasePack();
+  PhrasePack(const PhrasePack &) = delete;
+  PhrasePack &operator=(const PhrasePack &) = delete;
+  PhrasePack(PhrasePack &&) = delete;
+  PhrasePack &operator=(PhrasePack &&) = delete;
+  [[nodiscard]] std::optional<PhraseAudio> find(std::string_view text) const;
+  [[nodiscard]] std::size_t count() const noexcept { return entries.size(); }
+};
+
+// Renders every phrase through the backend's memory synthesis, trims it, and
+// replaces the file at `path` with the resulting pack.
+BackendResult<> write_phrase_pack(TextToSpeechBackend &backend,
+                                  std::string_view path,
+                                  std::span<const std::string_view> phrases);
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "prerenderer.h"
+#include "logging.h"
+#include <algorithm>
+#include <utility>
+#ifdef _WIN32
+#include <objbase.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+// Speculative work only gets cores nothing else wants. Engines that
+// synthesize on threads of their own, or in another process, are not
+// affected by this.
+bool lower_thread_priority() noexcept {
+#ifdef _WIN32
+  return SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) !=
+             0 ||
+         SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE) != 0;
+#elif defined(__APPLE__)
+  return pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0) == 0;
+#elif defined(__linux__)
+  const sched_param param{};
+  return pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) == 0;
+#else
+  return false;
+#endif
+}
+} // namespace
+
+Prerenderer::Prerenderer(UtteranceWorker &worker, Render render,
+                         bool background)
+    : worker(worker), render(std::move(render)), background(background) {
+  thread = std::jthread([this](const std::stop_token &stop) { run(stop); });
+  hook = worker.add_contention_hook([this] { yield(); });
+}
+
+Prerenderer::~Prerenderer() {
+  worker.remove_contention_hook(hook);
+  thread.request_stop();
+  {
+    std::scoped_lock lock(mutex);
+    current.request_stop();
+  }
+  if (thread.joinable())
+    thread.join();
+}
+
+bool Prerenderer::has_work() const noexcept {
+  return std::ranges::any_of(queued, [](const auto &q) { return !q.empty(); });
+}
+
+bool Prerenderer::take(Item &item) {
+  for (std::size_t i = 0; i < queued.size(); ++i) {
+    if (!queued[i].empty()) {
+      item = {.text = std::move(queued[i].front()), .queue = i};
+      queued[i].pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void Prerenderer::run(const std::stop_token &stop) {
+  if (background && !lower_thread_priority())
+    logger.debug("Running at normal thread priority");
+#ifdef _WIN32
+  const bool com_ok = SUCCEEDED(
+      CoInitializeEx(nullptr, COINIT_MULTITHREADED | COINIT_SPEED_OVER_MEMORY));
+#endif
+  std::unique_lock lock(mutex);
+  while (cv.wait(lock, stop, [this] { return has_work(); })) {
+    const auto resume = last_yield + quiet_period;
+    if (Clock::now() < resume) {
+      cv.wait_until(lock, stop, resume, [] { return false; });
+      continue;
+    }
+    Item item;
+    if (!take(item))
+      continue;
+    current = std::stop_source{};
+    current_is_hint = item.queue == hint_queue;
+    const auto token = current.get_token();
+    lock.unlock();
+    bool started = false;
+    BackendResult<> r;
+    if (!worker.busy()) {
+      if (auto guard = worker.try_lock_backend(); guard.owns_lock()) {
+        started = true;
+        r = render(item.text, token);
+      }
+    }
+    lock.lock();
+    // cancel_hints clears the flag when it drops the hint in flight.
+    const bool dropped = item.queue == hint_queue && !current_is_hint;
+    current_is_hint = false;
+    if (!started)
+      last_yield = Clock::now();
+    if (!started || token.stop_requested()) {
+      if (!dropped && !stop.stop_requested())
+        queued[item.queue].push_front(std::move(item.text));
+      continue;
+    }
+    if (!r)
+      logger.debug("Prerendering failed with error {}",
+                   std::to_underlying(r.error()));
+  }
+  lock.unlock();
+#ifdef _WIN32
+  if (com_ok)
+    CoUninitialize();
+#endif
+}
+
+void Prerenderer::prerender(std::span<const std::string_view> texts,
+                            SpeechPriority priority) {
+  auto &queue = queued[std::to_underlying(priority)];
+  {
+    std::scoped_lock lock(mutex);
+    for (const auto text : texts)
+      queue.emplace_back(text);
+  }
+  cv.notify_one();
+}
+
+void Prerenderer::hint(std::string_view text) {
+  {
+    std::scoped_lock lock(mutex);
+    // Hints describe where the user might go next; once there are more of
+    // them than could ever be rendered in time, the oldest are stale.
+    auto &hints = queued[hint_queue];
+    if (hints.size() == max_hints)
+      hints.pop_front();
+    hints.emplace_back(text);
+  }
+  cv.notify_one();
+}
+
+void Prerenderer::cancel_hints() {
+  std::scoped_lock lock(mutex);
+  queued[hint_queue].clear();
+  if (current_is_hint) {
+    current_is_hint = false;
+    current.request_stop();
+  }
+}
+
+void Prerenderer::yield() {
+  {
+    std::scoped_lock lock(mutex);
+    last_yield = Clock::now();
+    current.request_stop();
+  }
+  cv.notify_one();
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "utterance_worker.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Renders texts into the audio cache ahead of time on a low-priority thread.
+// It only takes the backend while nothing else wants it: it hooks the
+// worker so that everything about to wait for the backend, queued speech
+// included, yields first, which aborts the render in progress and holds off
+// the next one for a quiet period. Aborted texts go back to the front of their
+// queue.
+//
+// The thread only drops to background priority for backends that abort a
+// render when asked. With any other backend it could hold the backend for a
+// whole render while starved of CPU, so it renders at normal priority.
+class Prerenderer {
+public:
+  using Render =
+      std::function<BackendResult<>(std::string_view, const std::stop_token &)>;
+
+private:
+  struct Item {
+    std::string text;
+    std::size_t queue;
+  };
+  static constexpr auto quiet_period = std::chrono::milliseconds(50);
+  static constexpr std::size_t max_hints = 16;
+  // One queue per priority class, then the hints below all of them.
+  static constexpr std::size_t hint_queue = speech_priority_count;
+  using Clock = std::chrono::steady_clock;
+
+  UtteranceWorker &worker;
+  UtteranceWorker::HookId hook = 0;
+  Render render;
+  bool background;
+  std::mutex mutex;
+  std::condition_variable_any cv;
+  std::array<std::deque<std::string>, hint_queue + 1> queued;
+  Clock::time_point last_yield;
+  std::stop_source current;
+  bool current_is_hint = false;
+  std::jthread thread;
+  LogSource logger{"Prerenderer"};
+
+  void run(const std::stop_token &stop);
+  [[nodiscard]] bool has_work() const noexcept;
+  [[nodiscard]] bool take(Item &item);
+
+public:
+  Prerenderer(UtteranceWorker &worker, Render render, bool background);
+  ~Prerenderer();
+  Prerenderer(const Prerenderer &) = delete;
+  Prerenderer &operator=(const Prerenderer &) = delete;
+  Prerenderer(Prerenderer &&) = delete;
+  Prerenderer &operator=(Prerenderer &&) = delete;
+  void prerender(std::span<const std::string_view> texts,
+                 SpeechPriority priority);
+  void hint(std::string_view text);
+  void cancel_hints();
+  void yield();
+};
@@ -1,18 +1,48 @@
 // SPDX-License-Identifier: MPL-2.0
 
 #include "prism.h"
+#include "audio_cache.h"
+#include "audio_convert.h"
+#include "audio_stream.h"
 #include "backend_enumerator.h"
+#include "backend_group.h"
+#include "backend_selector.h"
+#include "failover.h"
 #include "frozen_registry.h"
+#include "latency_stats.h"
 #include "logging.h"
+#include "phrase_pack.h"
 #include "plugin_loader.h"
+#include "prerenderer.h"
+#include "ssml.h"
+#include "text_normalizer.h"
+#include "text_segmenter.h"
+#include "trace.h"
 #include "power_notifier.h"
+#include "utterance_worker.h"
+#include "voice_index.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <optional>
 #include <simdutf.h>
+#include <span>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 #ifdef __ANDROID__
 #include <jni.h>
 #endif
@@ -30,12 +60,17 @@
 struct PrismContext {
   FrozenRegistry *registry;
   std::unique_ptr<BackendEnumerator> enumerator;
+  // Null only if it could not be allocated, in which case selection falls
+  // back to the registry's own, one candidate at a time.
+  std::unique_ptr<BackendSelector> selector;
+  std::shared_ptr<AudioCache> audio_cache;
   bool com_initialized = false;
 
   explicit PrismContext(FrozenRegistry *registry) : registry(registry) {
     registry->retain();
   }
   ~PrismContext() {
+    selector.reset();
     enumerator.reset();
     registry->release();
   }
@@ -43,8 +78,61 @@ struct PrismContext {
 
 struct PrismBackend {
   std::shared_ptr<TextToSpeechBackend> impl;
+  BackendId id{};
+  std::shared_ptr<AudioCache> cache;
+  std::string cache_key;
   std::string voice_name;
   std::string voice_lang;
+  std::string text_scratch;
+  // PRISM_TEXT_FILTER_* applied to text on its way to be spoken.
+  std::uint32_t text_filters = 0;
+  // Longest segment long text is split into, or 0 to speak it whole.
+  std::size_t segment_bytes = 0;
+  std::string segment_scratch;
+  // Bumped by every stop, so segmented rendering on another thread notices.
+  std::atomic<std::uint64_t> stops{0};
+  // Text arriving through prism_backend_feed_append, and whether its next
+  // unit should interrupt. A stop since `feed_stops` discards what is held.
+  TextFeed feed;
+  bool feed_open = false;
+  bool feed_interrupt = false;
+  std::uint64_t feed_stops = 0;
+  UtteranceId feed_last = 0;
+  // Whether the backend takes SSML itself, asked on first use.
+  std::optional<bool> native_ssml;
+  std::vector<Utterance> batch_scratch;
+  // Built on the first lookup, and rebuilt once the instance's voice
+  // generation has moved past the one it was built from.
+  std::unique_ptr<VoiceIndex> voice_index;
+  std::uint64_t voice_index_generation = 0;
+  // Streams still open on this handle, which a stop ends.
+  std::mutex streams_mutex;
+  std::vector<AudioStream *> streams;
+  // Last, so both threads are joined before anything they read is destroyed,
+  // and the prerenderer, which renders through the worker, goes first.
+  std::unique_ptr<UtteranceWorker> worker;
+  std::unique_ptr<Prerenderer> prerenderer;
+};
+
+struct PrismAudioStream {
+  AudioStream stream;
+  PrismBackend *backend;
+};
+
+struct PrismCancelToken {
+  std::stop_source source;
+};
+
+// Groups and failovers drive their members' workers directly, but keep the
+// handles too, for the filters and stop count of each.
+struct PrismBackendGroup {
+  BackendGroup group;
+  std::vector<PrismBackend *> members;
+};
+
+struct PrismFailover {
+  Failover failover;
+  std::vector<PrismBackend *> members;
 };
 
 // This below function definition is defined in the custom backend adapter
@@ -65,12 +153,807 @@ static inline PrismBackendId to_prism_id(BackendId id) {
   return static_cast<PrismBackendId>(id);
 }
 
-static PrismBackend *wrap_backend(std::shared_ptr<TextToSpeechBackend> impl) {
+inline constexpr std::uint32_t known_text_flags =
+    PRISM_TEXT_PREVALIDATED | PRISM_TEXT_NUL_TERMINATED;
+inline constexpr std::uint32_t known_memory_flags = PRISM_MEMORY_INCREMENTAL;
+inline constexpr std::uint32_t known_param_flags =
+    PRISM_PARAM_VOLUME | PRISM_PARAM_RATE | PRISM_PARAM_PITCH |
+    PRISM_PARAM_VOICE;
+inline constexpr std::uint32_t max_output_channels = 64;
+inline constexpr std::uint32_t max_output_rate = 1'000'000;
+
+static BackendResult<> check_text(const char *text, std::size_t length,
+                                  std::uint32_t flags) {
+  if ((flags & ~known_text_flags) != 0)
+    return std::unexpected(BackendError::InvalidParam);
+  if ((flags & PRISM_TEXT_PREVALIDATED) == 0 &&
+      !simdutf::validate_utf8(text, length))
+    return std::unexpected(BackendError::InvalidUtf8);
+  return {};
+}
+
+// Backends may hand text.data() straight to C APIs, so the view we give them
+// must be NUL-terminated. Unterminated slices go through the handle's scratch
+// buffer, which keeps its capacity between calls.
+static BackendResult<std::string_view> prepare_text(PrismBackend *backend,
+                                                    const char *text,
+                                                    std::size_t length,
+                                                    std::uint32_t flags) {
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return std::unexpected(ok.error());
+  if ((flags & PRISM_TEXT_NUL_TERMINATED) != 0)
+    return std::string_view{text, length};
+  try {
+    backend->text_scratch.assign(text, length);
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  return std::string_view{backend->text_scratch};
+}
+
+static_assert(PRISM_TEXT_FILTER_STRIP_TAGS == TextFilter::STRIP_TAGS);
+static_assert(PRISM_TEXT_FILTER_COLLAPSE_WHITESPACE ==
+              TextFilter::COLLAPSE_WHITESPACE);
+static_assert(PRISM_TEXT_FILTER_STRIP_CONTROL == TextFilter::STRIP_CONTROL);
+static_assert(PRISM_TEXT_FILTER_DROP_EMPTY == TextFilter::DROP_EMPTY);
+
+// Text about to be spoken also goes through the handle's filters, rewritten
+// into the scratch buffer. An empty optional means the filters dropped it
+// and the call should succeed without reaching the backend.
+static BackendResult<std::optional<std::string_view>>
+prepare_speech(PrismBackend *backend, const char *text, std::size_t length,
+               std::uint32_t flags) {
+  if (backend->text_filters == 0)
+    return prepare_text(backend, text, length, flags);
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return std::unexpected(ok.error());
+  auto &scratch = backend->text_scratch;
+  try {
+    scratch.clear();
+    if (!normalize_text({text, length}, backend->text_filters, scratch))
+      return std::optional<std::string_view>{};
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  return std::string_view{scratch};
+}
+
+// Items before the last interrupting one would be cut off as soon as they
+// started, so only the tail of the batch is validated and sent.
+static BackendResult<std::span<const Utterance>>
+prepare_batch(PrismBackend *backend, const PrismUtterance *items,
+              std::size_t count) {
+  std::size_t first = 0;
+  for (std::size_t i = count; i-- > 0;) {
+    if (items[i].interrupt) {
+      first = i;
+      break;
+    }
+  }
+  std::size_t copy_bytes = 0;
+  for (std::size_t i = first; i < count; ++i) {
+    const auto &item = items[i];
+    if (item.text == nullptr)
+      return std::unexpected(BackendError::InvalidParam);
+    if (const auto ok = check_text(item.text, item.length, item.flags); !ok)
+      return std::unexpected(ok.error());
+    if (backend->text_filters != 0 ||
+        (item.flags & PRISM_TEXT_NUL_TERMINATED) == 0)
+      copy_bytes += item.length + 1;
+  }
+  auto &scratch = backend->text_scratch;
+  auto &batch = backend->batch_scratch;
+  try {
+    scratch.clear();
+    scratch.reserve(copy_bytes);
+    batch.clear();
+    batch.reserve(count - first);
+    for (std::size_t i = first; i < count; ++i) {
+      const auto &item = items[i];
+      std::string_view text{item.text, item.length};
+      const auto offset = scratch.size();
+      if (backend->text_filters != 0) {
+        if (!normalize_text(text, backend->text_filters, scratch)) {
+          scratch.resize(offset);
+          continue;
+        }
+        text = std::string_view{scratch}.substr(offset);
+        scratch.push_back('\0');
+      } else if ((item.flags & PRISM_TEXT_NUL_TERMINATED) == 0) {
+        scratch.append(text);
+        scratch.push_back('\0');
+        text = std::string_view{scratch.data() + offset, item.length};
+      }
+      batch.push_back({.text = text, .interrupt = item.interrupt});
+    }
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  return std::span<const Utterance>{batch};
+}
+
+// Once a handle has a worker, its thread may be inside the backend at any
+// time, so everything else that touches the backend has to take its lock.
+static std::unique_lock<std::mutex> lock_backend(PrismBackend *backend) {
+  if (!backend->worker)
+    return {};
+  return backend->worker->lock_backend();
+}
+
+static BackendResult<UtteranceWorker *> ensure_worker(PrismBackend *backend) {
+  if (!backend->worker) {
+    try {
+      backend->worker = std::make_unique<UtteranceWorker>(backend->impl);
+    } catch (const std::bad_alloc &) {
+      return std::unexpected(BackendError::MemoryFailure);
+    } catch (const std::system_error &) {
+      return std::unexpected(BackendError::InternalBackendError);
+    }
+  }
+  return backend->worker.get();
+}
+
+static bool use_worker(PrismBackend *backend) {
+  return backend->worker && !backend->worker->on_worker_thread();
+}
+
+static BackendResult<> submit_and_wait(PrismBackend *backend,
+                                       std::string_view text, bool interrupt,
+                                       UtteranceWorker::Kind kind) {
+  const auto id = backend->worker->submit(text, interrupt, kind, {});
+  if (!id)
+    return std::unexpected(id.error());
+  // A coalesced interrupt may be held back or superseded, so the caller only
+  // learns that it was accepted.
+  if (interrupt && backend->worker->coalescing())
+    return {};
+  return backend->worker->wait(*id);
+}
+
+// Serves a parameter from the instance's copy, asking the engine only when
+// the copy is unknown or the backend does not own its parameters.
+template <typename T, typename Get>
+static BackendResult<T> read_param(PrismBackend *backend,
+                                   std::optional<T> VoiceParams::*member,
+                                   Get get) {
+  auto &shadow = backend->impl->param_shadow();
+  std::uint64_t generation = 0;
+  {
+    std::scoped_lock lock(shadow.mutex);
+    if (const auto &known = shadow.known.*member; known)
+      return *known;
+    generation = shadow.generation;
+  }
+  const auto r = get();
+  if (r && backend->impl->owns_params()) {
+    std::scoped_lock lock(shadow.mutex);
+    if (shadow.generation == generation)
+      shadow.known.*member = *r;
+  }
+  return r;
+}
+
+// Applies the parameters that differ from the instance's copy in one backend
+// call. After a failure nothing is known about which of them took effect.
+static BackendResult<> write_params(PrismBackend *backend, VoiceParams params) {
+  auto &shadow = backend->impl->param_shadow();
+  const auto drop_unchanged = [](auto &wanted, const auto &current,
+                                 const auto &requested) {
+    if (wanted && (wanted == current || wanted == requested))
+      wanted.reset();
+  };
+  {
+    std::scoped_lock lock(shadow.mutex);
+    const auto &known = shadow.known;
+    const auto &requested = shadow.requested;
+    drop_unchanged(params.volume, known.volume, requested.volume);
+    drop_unchanged(params.rate, known.rate, requested.rate);
+    drop_unchanged(params.pitch, known.pitch, requested.pitch);
+    drop_unchanged(params.voice, known.voice, requested.voice);
+  }
+  if (!params.volume && !params.rate && !params.pitch && !params.voice)
+    return {};
+  const auto r = backend->impl->set_params(params);
+  // Some engines reset the other parameters along with the voice.
+  if (!r || !backend->impl->owns_params() || params.voice)
+    shadow.forget();
+  if (!r || !backend->impl->owns_params())
+    return r;
+  std::scoped_lock lock(shadow.mutex);
+  // What the engine made of a new value is read back on the next get.
+  const auto remember = [](auto &known, auto &requested, const auto &wanted) {
+    if (wanted) {
+      known.reset();
+      requested = wanted;
+    }
+  };
+  remember(shadow.known.volume, shadow.requested.volume, params.volume);
+  remember(shadow.known.rate, shadow.requested.rate, params.rate);
+  remember(shadow.known.pitch, shadow.requested.pitch, params.pitch);
+  remember(shadow.known.voice, shadow.requested.voice, params.voice);
+  ++shadow.generation;
+  return r;
+}
+
+inline constexpr auto quiet_poll = std::chrono::milliseconds{10};
+
+// Waits for the backend to finish speaking and then for `pause`, returning
+// false if `cancel` is stopped first. A backend whose is_speaking fails is
+// taken to be quiet.
+static bool wait_for_silence(PrismBackend *backend,
+                             std::chrono::milliseconds pause,
+                             const std::stop_token &cancel) {
+  for (;;) {
+    if (cancel.stop_requested())
+      return false;
+    {
+      const auto guard = lock_backend(backend);
+      const auto speaking = backend->impl->is_speaking();
+      if (!speaking || !*speaking)
+        break;
+    }
+    std::this_thread::sleep_for(quiet_poll);
+  }
+  for (auto left = pause; left > left.zero(); left -= quiet_poll) {
+    std::this_thread::sleep_for(std::min(left, quiet_poll));
+    if (cancel.stop_requested())
+      return false;
+  }
+  return true;
+}
+
+// An SSML document reduced to plain text, on its way through the worker.
+// `started` is told the outcome once the first segment has reached the
+// backend, or once the document has finished or been dropped without
+// getting that far.
+struct ReducedDocument {
+  std::string text;
+  std::vector<SsmlSegment> segments;
+  VoiceParams base;
+  bool interrupt = false;
+  std::promise<BackendError> started;
+  bool told = false;
+
+  void tell(BackendError error) {
+    if (!std::exchange(told, true))
+      started.set_value(error);
+  }
+};
+
+// Runs on the worker: the text is spoken a segment at a time, and where the
+// prosody changes or a break falls, the next segment waits for the backend to
+// go quiet and the new values go through the ordinary setters. Whatever was
+// changed is put back once the document has played or been cut short.
+static BackendResult<> play_reduced(PrismBackend *backend,
+                                    ReducedDocument &doc,
+                                    const std::stop_token &cancel) {
+  const auto &base = doc.base;
+  // Prosody relative to the document's start, as in SsmlSegment.
+  VoiceParams applied;
+  const auto apply = [&](const VoiceParams &prosody) {
+    const auto pick = [&](std::optional<float> VoiceParams::*member) {
+      return (prosody.*member).has_value() ? prosody.*member
+             : (applied.*member).has_value() ? base.*member
+                                             : std::nullopt;
+    };
+    VoiceParams params;
+    params.volume = pick(&VoiceParams::volume);
+    params.rate = pick(&VoiceParams::rate);
+    params.pitch = pick(&VoiceParams::pitch);
+    applied = prosody;
+    const auto guard = lock_backend(backend);
+    return write_params(backend, params);
+  };
+  const auto same = [](const VoiceParams &a, const VoiceParams &b) {
+    return a.volume == b.volume && a.rate == b.rate && a.pitch == b.pitch;
+  };
+  bool first = true;
+  bool stopped = false;
+  BackendResult<> r;
+  for (const auto &segment : doc.segments) {
+    const auto changed = !same(segment.prosody, applied);
+    // A break before any text has nothing to separate.
+    if (!first && (changed || segment.pause_ms != 0) &&
+        !wait_for_silence(backend, std::chrono::milliseconds{segment.pause_ms},
+                          cancel)) {
+      stopped = true;
+      break;
+    }
+    if (changed)
+      if (r = apply(segment.prosody); !r)
+        break;
+    const std::string_view text{doc.text.data() + segment.offset,
+                                segment.length};
+    {
+      const auto guard = lock_backend(backend);
+      r = backend->impl->speak(text, doc.interrupt && first);
+    }
+    if (!r)
+      break;
+    if (first)
+      doc.tell(BackendError::Ok);
+    first = false;
+  }
+  if (r && stopped)
+    r = std::unexpected(BackendError::Cancelled);
+  if (same(applied, {}))
+    return r;
+  // A stop, before or during this wait, leaves nothing playing.
+  if (!stopped)
+    (void)wait_for_silence(backend, {}, cancel);
+  const auto restored = apply({});
+  return r ? restored : r;
+}
+
+// Joins the runs of a reduced document into one, dropping its prosody and
+// breaks.
+static void merge_segments(ReducedDocument &doc) {
+  if (doc.segments.empty())
+    return;
+  const auto begin = doc.segments.front().offset;
+  const auto end = doc.segments.back().offset + doc.segments.back().length;
+  std::replace(doc.text.data() + begin, doc.text.data() + end, '\0', ' ');
+  doc.segments.resize(1);
+  doc.segments.front() = {
+      .offset = begin, .length = end - begin, .prosody = {}, .pause_ms = 0};
+}
+
+// Plays an SSML document on a backend without SSML support. Only parameters
+// the backend can report are changed, and only on backends that can say when
+// they have finished speaking; anywhere else the text is spoken in one go at
+// the current settings, since a change would take effect partway through
+// the run before it. The document plays as one task on the handle's worker,
+// so like segmented speech, this returns once its first segment has been
+// handed to the backend.
+static BackendResult<> speak_reduced(PrismBackend *backend,
+                                     std::string_view ssml, bool interrupt) {
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return std::unexpected(worker.error());
+  std::shared_ptr<ReducedDocument> doc;
+  std::future<BackendError> started;
+  try {
+    doc = std::make_shared<ReducedDocument>();
+    doc->interrupt = interrupt;
+    started = doc->started.get_future();
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  const bool paced = (backend->impl->get_features().to_ullong() &
+                      BackendFeature::SUPPORTS_IS_SPEAKING) != 0;
+  auto &base = doc->base;
+  if (paced) {
+    const auto guard = lock_backend(backend);
+    auto &impl = *backend->impl;
+    const auto read = [&](std::optional<float> VoiceParams::*member, auto get) {
+      if (const auto r = read_param(backend, member, get); r)
+        base.*member = *r;
+    };
+    read(&VoiceParams::volume, [&impl] { return impl.get_volume(); });
+    read(&VoiceParams::rate, [&impl] { return impl.get_rate(); });
+    read(&VoiceParams::pitch, [&impl] { return impl.get_pitch(); });
+  }
+  try {
+    if (const auto r = reduce_ssml(ssml, base, doc->text, doc->segments); !r)
+      return r;
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  if (!paced)
+    merge_segments(*doc);
+  const auto id = (*worker)->submit_task(
+      [backend, doc](const std::stop_token &cancel) {
+        return play_reduced(backend, *doc, cancel);
+      },
+      interrupt, [doc](UtteranceId, BackendError error) { doc->tell(error); });
+  if (!id)
+    return std::unexpected(id.error());
+  // A coalesced interrupt may be held back or superseded, so the caller only
+  // learns that it was accepted.
+  if ((*worker)->on_worker_thread() || (interrupt && (*worker)->coalescing()))
+    return {};
+  if (const auto error = started.get(); error != BackendError::Ok)
+    return std::unexpected(error);
+  return {};
+}
+
+// A batch on its way through the worker, with its own copy of the text.
+struct QueuedBatch {
+  std::string text;
+  std::vector<Utterance> items;
+};
+
+// The batch goes to the worker as one task, so backends that pipeline a
+// batch still see it whole rather than one utterance at a time.
+static BackendResult<> queue_batch(PrismBackend *backend,
+                                   std::span<const Utterance> items) {
+  if (items.empty())
+    return {};
+  std::shared_ptr<QueuedBatch> batch;
+  try {
+    batch = std::make_shared<QueuedBatch>();
+    std::size_t bytes = 0;
+    for (const auto &item : items)
+      bytes += item.text.size() + 1;
+    batch->text.reserve(bytes);
+    batch->items.reserve(items.size());
+    for (const auto &item : items) {
+      const auto offset = batch->text.size();
+      batch->text.append(item.text);
+      batch->text.push_back('\0');
+      batch->items.push_back(
+          {.text = std::string_view{batch->text}.substr(offset,
+                                                        item.text.size()),
+           .interrupt = item.interrupt});
+    }
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+  auto &worker = *backend->worker;
+  const auto id = worker.submit_task(
+      [backend, batch](const std::stop_token &cancel) -> BackendResult<> {
+        const auto guard = lock_backend(backend);
+        if (cancel.stop_requested())
+          return std::unexpected(BackendError::Cancelled);
+        return backend->impl->speak_batch(batch->items);
+      },
+      items.front().interrupt, {});
+  if (!id)
+    return std::unexpected(id.error());
+  return worker.wait(*id);
+}
+
+// A setting the application can change but the backend cannot report would
+// turn every later hit stale, so such backends are not cached at all.
+static std::optional<AudioCacheParams> cache_params(PrismBackend *backend) {
+  auto &impl = *backend->impl;
+  const auto features = impl.get_features().to_ullong();
+  const auto read = [backend, features](std::uint64_t set, std::uint64_t get,
+                                        auto member, const auto &getter,
+                                        auto &out) {
+    if ((features & get) == 0)
+      return (features & set) == 0;
+    const auto r = read_param(backend, member, getter);
+    if (r)
+      out = *r;
+    return r.has_value();
+  };
+  AudioCacheParams params{.backend = backend->id};
+  if (!read(PRISM_BACKEND_SUPPORTS_SET_VOICE, PRISM_BACKEND_SUPPORTS_GET_VOICE,
+            &VoiceParams::voice, [&] { return impl.get_voice(); },
+            params.voice) ||
+      !read(PRISM_BACKEND_SUPPORTS_SET_RATE, PRISM_BACKEND_SUPPORTS_GET_RATE,
+            &VoiceParams::rate, [&] { return impl.get_rate(); },
+            params.rate) ||
+      !read(PRISM_BACKEND_SUPPORTS_SET_PITCH, PRISM_BACKEND_SUPPORTS_GET_PITCH,
+            &VoiceParams::pitch, [&] { return impl.get_pitch(); },
+            params.pitch) ||
+      !read(PRISM_BACKEND_SUPPORTS_SET_VOLUME,
+            PRISM_BACKEND_SUPPORTS_GET_VOLUME, &VoiceParams::volume,
+            [&] { return impl.get_volume(); }, params.volume))
+    return std::nullopt;
+  return params;
+}
+
+// Renders text and stores the result under `key` if it finished uncancelled
+// in a single format.
+static BackendResult<>
+render_and_store(PrismBackend *backend, std::string_view text,
+                 std::string_view key,
+                 const TextToSpeechBackend::AudioCallback &sink,
+                 const MemoryOptions &memory) {
+  std::vector<float> rendered;
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+  bool keep = true;
+  const auto r = backend->impl->speak_to_memory_ex(
+      text,
+      [&](void *userdata, const float *samples, std::size_t count,
+          std::size_t ch, std::size_t sr) {
+        if (channels == 0) {
+          channels = ch;
+          sample_rate = sr;
+        }
+        if (keep && (ch != channels || sr != sample_rate))
+          keep = false;
+        if (keep) {
+          try {
+            rendered.insert(rendered.end(), samples, samples + count);
+          } catch (const std::bad_alloc &) {
+            keep = false;
+          }
+        }
+        sink(userdata, samples, count, ch, sr);
+      },
+      nullptr, memory);
+  if (r && keep && channels != 0 && sample_rate != 0 &&
+      !memory.cancel.stop_requested())
+    backend->cache->insert(key, std::move(rendered), channels, sample_rate);
+  return r;
+}
+
+// Memory synthesis through the context's audio cache. A hit is delivered as
+// one chunk without touching the engine; a miss is rendered as usual.
+static BackendResult<>
+render_cached(PrismBackend *backend, std::string_view text,
+              const TextToSpeechBackend::AudioCallback &deliver,
+              const MemoryOptions &memory) {
+  const TextToSpeechBackend::AudioCallback traced =
+      [&deliver, id = backend->id](void *userdata, const float *samples,
+                                   std::size_t count, std::size_t ch,
+                                   std::size_t sr) {
+        const TraceScope trace("audio_callback", "callback", id);
+        deliver(userdata, samples, count, ch, sr);
+      };
+  const auto &sink = tracing() ? traced : deliver;
+  const auto params =
+      backend->cache ? cache_params(backend) : std::nullopt;
+  if (!params)
+    return backend->impl->speak_to_memory_ex(text, sink, nullptr, memory);
+  AudioCache::make_key(backend->cache_key, *params, text);
+  if (const auto hit = backend->cache->find(backend->cache_key)) {
+    if (!hit->samples.empty())
+      sink(nullptr, hit->samples.data(), hit->samples.size(), hit->channels,
+           hit->sample_rate);
+    return {};
+  }
+  return render_and_store(backend, text, backend->cache_key, sink, memory);
+}
+
+// Zero when segmentation is off or `text` fits in one segment.
+static std::size_t segment_limit(PrismBackend *backend, std::string_view text) {
+  if (backend->segment_bytes == 0)
+    return 0;
+  auto limit = backend->segment_bytes;
+  if (const auto engine = backend->impl->max_text_bytes(); engine != 0)
+    limit = std::min(limit, engine);
+  return text.size() > limit ? limit : 0;
+}
+
+// Long text is rendered a segment at a time, so its first audio arrives after
+// one sentence rather than after all of it, and a stop from another thread
+// takes effect at the next segment.
+static BackendResult<>
+render_segmented(PrismBackend *backend, std::string_view text,
+                 const TextToSpeechBackend::AudioCallback &deliver,
+                 const MemoryOptions &memory) {
+  const auto limit = segment_limit(backend, text);
+  if (limit == 0)
+    return render_cached(backend, text, deliver, memory);
+  const auto stops = backend->stops.load(std::memory_order_acquire);
+  TextSegmenter segments(text, limit);
+  for (auto segment = segments.next(); !segment.empty();
+       segment = segments.next()) {
+    if (memory.cancel.stop_requested() ||
+        backend->stops.load(std::memory_order_acquire) != stops)
+      break;
+    // Backends expect a NUL after the text.
+    try {
+      backend->segment_scratch.assign(segment);
+    } catch (const std::bad_alloc &) {
+      return std::unexpected(BackendError::MemoryFailure);
+    }
+    if (const auto r = render_cached(backend, backend->segment_scratch,
+                                     deliver, memory);
+        !r)
+      return r;
+  }
+  return {};
+}
+
+// Long text goes to the worker a segment at a time: the first is dispatched
+// straight away and the rest wait in the queue, where a stop drops them.
+// Only the first segment is waited for.
+static BackendResult<> speak_segmented(PrismBackend *backend,
+                                       std::string_view text, bool interrupt,
+                                       UtteranceWorker::Kind kind,
+                                       std::size_t limit) {
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return std::unexpected(worker.error());
+  TextSegmenter segments(text, limit);
+  std::optional<UtteranceId> first;
+  for (auto segment = segments.next(); !segment.empty();
+       segment = segments.next()) {
+    const auto id = (*worker)->submit(segment, interrupt && !first, kind, {});
+    if (!id)
+      return std::unexpected(id.error());
+    first = first.value_or(*id);
+  }
+  if (!first || (*worker)->on_worker_thread() ||
+      (interrupt && (*worker)->coalescing()))
+    return {};
+  return (*worker)->wait(*first);
+}
+
+// Fed units are queued without waiting, so the caller can go straight back to
+// reading its stream.
+static BackendResult<> speak_fed(PrismBackend *backend, UtteranceWorker &worker,
+                                 std::string_view unit) {
+  if (backend->text_filters != 0) {
+    auto &scratch = backend->text_scratch;
+    try {
+      scratch.clear();
+      if (!normalize_text(unit, backend->text_filters, scratch))
+        return {};
+    } catch (const std::bad_alloc &) {
+      return std::unexpected(BackendError::MemoryFailure);
+    }
+    unit = scratch;
+  }
+  const auto id = worker.submit(unit, backend->feed_interrupt,
+                                UtteranceWorker::Kind::Speak, {});
+  if (!id)
+    return std::unexpected(id.error());
+  backend->feed_interrupt = false;
+  backend->feed_last = *id;
+  return {};
+}
+
+static void discard_stopped_feed(PrismBackend *backend) {
+  const auto stops = backend->stops.load(std::memory_order_acquire);
+  if (stops == backend->feed_stops)
+    return;
+  backend->feed.clear();
+  backend->feed_stops = stops;
+}
+
+// Runs on the prerender thread, which holds the backend meanwhile.
+static BackendResult<> prerender_one(PrismBackend *backend, std::string &key,
+                                     std::string_view text,
+                                     const std::stop_token &cancel) {
+  const auto params = cache_params(backend);
+  if (!params)
+    return std::unexpected(BackendError::NotImplemented);
+  AudioCache::make_key(key, *params, text);
+  if (backend->cache->contains(key))
+    return {};
+  return render_and_store(
+      backend, text, key, [](void *, const float *, std::size_t, std::size_t,
+                             std::size_t) {},
+      {.incremental = false, .cancel = cancel});
+}
+
+static BackendResult<Prerenderer *> ensure_prerenderer(PrismBackend *backend) {
+  if (!backend->cache)
+    return std::unexpected(BackendError::InvalidOperation);
+  if ((backend->impl->get_features().to_ullong() &
+       PRISM_BACKEND_SUPPORTS_SPEAK_TO_MEMORY) == 0)
+    return std::unexpected(BackendError::NotImplemented);
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return std::unexpected(worker.error());
+  if (!backend->prerenderer) {
+    {
+      const auto guard = lock_backend(backend);
+      if (!cache_params(backend))
+        return std::unexpected(BackendError::NotImplemented);
+    }
+    try {
+      backend->prerenderer = std::make_unique<Prerenderer>(
+          **worker, [backend, key = std::string{}](
+                        std::string_view text,
+                        const std::stop_token &cancel) mutable {
+            return prerender_one(backend, key, text, cancel);
+          },
+          backend->impl->cancels_memory_synthesis());
+    } catch (const std::bad_alloc &) {
+      return std::unexpected(BackendError::MemoryFailure);
+    } catch (const std::system_error &) {
+      return std::unexpected(BackendError::InternalBackendError);
+    }
+  }
+  return backend->prerenderer.get();
+}
+
+// Shared by the float and PCM variants of memory synthesis: converts each
+// chunk to the requested format, then splits it into pieces of at most
+// `max_chunk_frames` frames for `sink`. Only the PCM variant accepts a
+// sample format other than float.
+template <typename Sink>
+static PrismError render_to_memory(PrismBackend *backend, const char *text,
+                                   std::size_t length, std::uint32_t flags,
+                                   const PrismMemoryOptions *options,
+                                   bool pcm, Sink sink) {
+  if (options->size == 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  PrismMemoryOptions opts{};
+  std::memcpy(&opts, options, std::min(options->size, sizeof(opts)));
+  if ((opts.flags & ~known_memory_flags) != 0 ||
+      opts.sample_format >= PRISM_SAMPLE_FORMAT_COUNT ||
+      (!pcm && opts.sample_format != PRISM_SAMPLE_FORMAT_F32) ||
+      opts.channels > max_output_channels ||
+      opts.sample_rate > max_output_rate)
+    return PRISM_ERROR_INVALID_PARAM;
+  MemoryOptions memory{.incremental =
+                           (opts.flags & PRISM_MEMORY_INCREMENTAL) != 0,
+                       .cancel = {}};
+  if (opts.cancel != nullptr) {
+    memory.cancel = opts.cancel->source.get_token();
+    if (memory.cancel.stop_requested())
+      return PRISM_ERROR_CANCELLED;
+  }
+  const auto view = prepare_speech(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  if (!*view)
+    return PRISM_OK;
+  const auto format = static_cast<SampleFormat>(opts.sample_format);
+  AudioConverter converter({.format = format,
+                            .channels = opts.channels,
+                            .sample_rate = opts.sample_rate});
+  BackendError failure = BackendError::Ok;
+  const auto guard = lock_backend(backend);
+  const auto r = render_segmented(
+      backend, **view,
+      [&, max_frames = opts.max_chunk_frames](void *, const float *samples,
+                                              std::size_t count,
+                                              std::size_t ch, std::size_t sr) {
+        if (failure != BackendError::Ok)
+          return;
+        const auto chunk = converter.convert({samples, count}, ch, sr);
+        if (!chunk) {
+          failure = chunk.error();
+          return;
+        }
+        const auto stride = chunk->channels * bytes_per_sample(format);
+        const auto *bytes = static_cast<const std::uint8_t *>(chunk->data);
+        const auto step = max_frames == 0 ? chunk->frames : max_frames;
+        for (std::size_t offset = 0; offset < chunk->frames; offset += step) {
+          if (memory.cancel.stop_requested())
+            return;
+          sink(bytes + (offset * stride),
+               std::min(step, chunk->frames - offset), chunk->channels,
+               chunk->sample_rate, format);
+        }
+      },
+      memory);
+  if (memory.cancel.stop_requested())
+    return PRISM_ERROR_CANCELLED;
+  if (!r)
+    return to_prism_error(r.error());
+  return to_prism_error(failure);
+}
+
+template <typename Lookup>
+static PrismError find_voice(PrismBackend *backend, size_t *out_voice_id,
+                             Lookup lookup) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
+  try {
+    // Read before enumerating, so a change while the list is read is only
+    // ever rebuilt too often.
+    const auto generation = backend->impl->voice_generation();
+    if (!backend->voice_index ||
+        backend->voice_index_generation != generation) {
+      backend->voice_index.reset();
+      VoiceList voices;
+      if (const auto r = backend->impl->get_voices(voices); !r)
+        return to_prism_error(r.error());
+      backend->voice_index = std::make_unique<VoiceIndex>(voices);
+      backend->voice_index_generation = generation;
+    }
+    const auto found = lookup(*backend->voice_index);
+    if (!found)
+      return PRISM_ERROR_VOICE_NOT_FOUND;
+    *out_voice_id = *found;
+    return PRISM_OK;
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+}
+
+static PrismBackend *wrap_backend(PrismContext *ctx,
+                                  std::shared_ptr<TextToSpeechBackend> impl) {
   if (!impl)
     return nullptr;
   auto *b = new (std::nothrow) PrismBackend;
   if (b == nullptr)
     return nullptr;
+  b->id = make_backend_id(impl->get_name());
+  if (tracing())
+    trace_backend_name(b->id, impl->get_name());
+  b->cache = ctx->audio_cache;
   b->impl = std::move(impl);
   return b;
 }
@@ -98,6 +981,7 @@ PRISM_API PRISM_NODISCARD PrismConfig PRISM_CALL prism_config_init(void) {
 PRISM_API PRISM_NODISCARD PrismContext *PRISM_CALL
 prism_init(PrismConfig *cfg) {
   init_logging_from_env();
+  init_tracing_from_env();
 #ifdef _WIN32
   bool owns_com = false;
   switch (CoInitializeEx(nullptr,
@@ -144,6 +1028,13 @@ prism_init(PrismConfig *cfg) {
 #ifdef _WIN32
   ctx->com_initialized = owns_com;
 #endif
+  if (cfg != nullptr && cfg->version >= 4 && cfg->audio_cache_bytes != 0) {
+    ctx->audio_cache = std::shared_ptr<AudioCache>(
+        new (std::nothrow) AudioCache(cfg->audio_cache_bytes));
+    if (!ctx->audio_cache)
+      prism_log(PRISM_LOG_LEVEL_ERROR, "prism",
+                "failed to allocate the audio cache");
+  }
   if (cfg != nullptr && cfg->version >= 3 &&
       cfg->availability_callback != nullptr) {
     try {
@@ -157,6 +1048,18 @@ prism_init(PrismConfig *cfg) {
                 "failed to start backend enumerator");
     }
   }
+  std::uint32_t parallelism = 1;
+  std::uint32_t deadline_ms = 0;
+  if (cfg != nullptr && cfg->version >= 5) {
+    parallelism = cfg->selection_parallelism;
+    deadline_ms = cfg->selection_deadline_ms;
+  }
+  ctx->selector.reset(new (std::nothrow) BackendSelector(
+      registry, ctx->enumerator.get(), parallelism,
+      std::chrono::milliseconds{deadline_ms}));
+  if (!ctx->selector)
+    prism_log(PRISM_LOG_LEVEL_ERROR, "prism",
+              "failed to allocate the backend selector");
   return ctx;
 }
 
@@ -168,6 +1071,7 @@ PRISM_API void PRISM_CALL prism_shutdown(PrismContext *ctx) {
     CoUninitialize();
 #endif
   delete ctx;
+  write_trace();
 #ifdef _WIN32
   (void)__FUnloadDelayLoadedDLL2("ZDSRAPI.dll");
   (void)__FUnloadDelayLoadedDLL2("byctrl.dll");
@@ -194,9 +1098,81 @@ prism_availability_auto_power_supported(void) {
   return PowerNotifier::supported();
 }
 
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_audio_cache_get_stats(
+    PrismContext *ctx, PrismAudioCacheStats *PRISM_RESTRICT out_stats) {
+  if (!ctx->audio_cache)
+    return PRISM_ERROR_INVALID_OPERATION;
+  const auto stats = ctx->audio_cache->stats();
+  out_stats->hits = stats.hits;
+  out_stats->misses = stats.misses;
+  out_stats->evictions = stats.evictions;
+  out_stats->bytes = stats.bytes;
+  out_stats->entries = stats.entries;
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_audio_cache_clear(PrismContext *ctx) {
+  if (ctx->audio_cache)
+    ctx->audio_cache->clear();
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_stats_snapshot(PrismBackendId backend, PrismStatsOperation operation,
+                     PrismStatsLayer layer,
+                     PrismLatencyHistogram *PRISM_RESTRICT out_histogram) {
+  if (operation < 0 || operation >= PRISM_STATS_OPERATION_COUNT ||
+      layer < 0 || layer >= PRISM_STATS_LAYER_COUNT)
+    return PRISM_ERROR_INVALID_PARAM;
+  auto *stats = latency_stats();
+  const auto h = stats != nullptr
+                     ? stats->snapshot(static_cast<BackendId>(backend),
+                                       static_cast<StatsOperation>(operation),
+                                       static_cast<StatsLayer>(layer))
+                     : LatencyHistogram{};
+  out_histogram->count = h.count;
+  out_histogram->sum_us = h.sum_us;
+  std::ranges::copy(h.buckets, std::begin(out_histogram->buckets));
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_stats_reset(void) {
+  auto *stats = latency_stats();
+  if (stats == nullptr)
+    return;
+  try {
+    stats->reset();
+  } catch (const std::bad_alloc &) {
+    // Snapshots keep counting from the previous reset.
+  }
+}
+
+PRISM_API PRISM_NODISCARD uint64_t PRISM_CALL
+prism_stats_bucket_floor(size_t bucket) {
+  if (bucket >= PRISM_STATS_BUCKET_COUNT)
+    return UINT64_MAX;
+  return stats_bucket_floor(bucket);
+}
+
+PRISM_API PRISM_NODISCARD uint64_t PRISM_CALL prism_stats_percentile(
+    const PrismLatencyHistogram *histogram, double percentile) {
+  if (histogram->count == 0 || !(percentile >= 0.0))
+    return 0;
+  const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(
+             std::ceil(std::min(percentile, 100.0) / 100.0 *
+                       static_cast<double>(histogram->count))));
+  std::uint64_t seen = 0;
+  for (std::size_t b = 0; b < PRISM_STATS_BUCKET_COUNT; ++b) {
+    seen += histogram->buckets[b];
+    if (seen >= rank)
+      return stats_bucket_floor(b);
+  }
+  return stats_bucket_floor(PRISM_STATS_BUCKET_COUNT - 1);
+}
+
 PRISM_API PRISM_NODISCARD size_t PRISM_CALL
 prism_registry_count(PrismContext *ctx) {
-  return ctx->registry->list().size();
+  return ctx->registry->count();
 }
 
 PRISM_API PRISM_NODISCARD PrismBackendId PRISM_CALL
@@ -227,27 +1203,54 @@ prism_registry_exists(PrismContext *ctx, PrismBackendId id) {
 
 PRISM_API PRISM_NODISCARD PrismBackend *PRISM_CALL
 prism_registry_get(PrismContext *ctx, PrismBackendId id) {
-  return wrap_backend(ctx->registry->get(to_backend_id(id)));
+  return wrap_backend(ctx, ctx->registry->get(to_backend_id(id)));
 }
 
 PRISM_API PRISM_NODISCARD PrismBackend *PRISM_CALL
 prism_registry_create(PrismContext *ctx, PrismBackendId id) {
-  return wrap_backend(ctx->registry->create(to_backend_id(id)));
+  return wrap_backend(ctx, ctx->registry->create(to_backend_id(id)));
 }
 
 PRISM_API PRISM_NODISCARD PrismBackend *PRISM_CALL
 prism_registry_create_best(PrismContext *ctx) {
-  return wrap_backend(ctx->registry->create_best());
+  if (!ctx->selector)
+    return wrap_backend(ctx, ctx->registry->create_best());
+  auto backend = ctx->selector->create_best();
+  return backend ? wrap_backend(ctx, *std::move(backend)) : nullptr;
 }
 
 PRISM_API PRISM_NODISCARD PrismBackend *PRISM_CALL
 prism_registry_acquire(PrismContext *ctx, PrismBackendId id) {
-  return wrap_backend(ctx->registry->acquire(to_backend_id(id)));
+  return wrap_backend(ctx, ctx->registry->acquire(to_backend_id(id)));
 }
 
 PRISM_API PRISM_NODISCARD PrismBackend *PRISM_CALL
 prism_registry_acquire_best(PrismContext *ctx) {
-  return wrap_backend(ctx->registry->acquire_best());
+  if (!ctx->selector)
+    return wrap_backend(ctx, ctx->registry->acquire_best());
+  auto backend = ctx->selector->acquire_best();
+  return backend ? wrap_backend(ctx, *std::move(backend)) : nullptr;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_registry_acquire_best_async(PrismContext *ctx,
+                                  PrismBackendReadyCallback callback,
+                                  void *userdata) {
+  // Only when the selector could not be allocated by prism_init, leaving no
+  // thread to run the work on.
+  if (!ctx->selector)
+    return PRISM_ERROR_INTERNAL;
+  const bool started = ctx->selector->acquire_best_async(
+      [ctx, callback, userdata](BackendResult<BackendSelector::Backend> impl) {
+        if (!impl) {
+          callback(userdata, nullptr, to_prism_error(impl.error()));
+          return;
+        }
+        auto *backend = wrap_backend(ctx, *std::move(impl));
+        callback(userdata, backend,
+                 backend != nullptr ? PRISM_OK : PRISM_ERROR_MEMORY_FAILURE);
+      });
+  return started ? PRISM_OK : PRISM_ERROR_MEMORY_FAILURE;
 }
 
 PRISM_API PRISM_NODISCARD PrismRegistryBuilder *PRISM_CALL
@@ -349,69 +1352,828 @@ prism_backend_get_features(PrismBackend *backend) {
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_initialize(PrismBackend *backend) {
+  const LatencyScope timing(backend->id, StatsOperation::Initialize);
+  const auto guard = lock_backend(backend);
+  backend->impl->voices_changed();
+  backend->impl->param_shadow().forget();
   const auto r = backend->impl->initialize();
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_speak(
     PrismBackend *backend, const char *PRISM_RESTRICT text, bool interrupt) {
-  if (!simdutf::validate_utf8(text, std::string_view{text}.size()))
-    return PRISM_ERROR_INVALID_UTF8;
-  const auto r = backend->impl->speak(text, interrupt);
+  return prism_backend_speak_n(backend, text, std::string_view{text}.size(),
+                               interrupt, PRISM_TEXT_NUL_TERMINATED);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_speak_n(
+    PrismBackend *backend, const char *PRISM_RESTRICT text, size_t length,
+    bool interrupt, uint32_t flags) {
+  const LatencyScope timing(backend->id, StatsOperation::Speak);
+  const auto view = prepare_speech(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  if (!*view)
+    return PRISM_OK;
+  if (const auto limit = segment_limit(backend, **view); limit != 0) {
+    const auto r = speak_segmented(backend, **view, interrupt,
+                                   UtteranceWorker::Kind::Speak, limit);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  if (use_worker(backend)) {
+    const auto r = submit_and_wait(backend, **view, interrupt,
+                                   UtteranceWorker::Kind::Speak);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  const auto guard = lock_backend(backend);
+  const auto r = backend->impl->speak(**view, interrupt);
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_speak_ssml(
+    PrismBackend *backend, const char *PRISM_RESTRICT ssml, size_t length,
+    bool interrupt, uint32_t flags) {
+  const LatencyScope timing(backend->id, StatsOperation::Speak);
+  const auto view = prepare_text(backend, ssml, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  if (!backend->native_ssml)
+    backend->native_ssml = (backend->impl->get_features().to_ullong() &
+                            BackendFeature::SUPPORTS_SPEAK_SSML) != 0;
+  if (!*backend->native_ssml) {
+    const auto r = speak_reduced(backend, *view, interrupt);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  if (use_worker(backend)) {
+    const auto r = submit_and_wait(backend, *view, interrupt,
+                                   UtteranceWorker::Kind::Ssml);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  const auto guard = lock_backend(backend);
+  const auto r = backend->impl->speak_ssml(*view, interrupt);
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_speak_batch(PrismBackend *backend,
+                          const PrismUtterance *PRISM_RESTRICT items,
+                          size_t count) {
+  const LatencyScope timing(backend->id, StatsOperation::Speak);
+  if (count == 0)
+    return PRISM_OK;
+  if (items == nullptr)
+    return PRISM_ERROR_INVALID_PARAM;
+  const auto batch = prepare_batch(backend, items, count);
+  if (!batch)
+    return to_prism_error(batch.error());
+  if (use_worker(backend)) {
+    const auto r = queue_batch(backend, *batch);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  const auto guard = lock_backend(backend);
+  const auto r = backend->impl->speak_batch(*batch);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
+static PrismError submit_async(PrismBackend *backend, const char *text,
+                               std::size_t length, std::uint32_t flags,
+                               bool interrupt, SpeechPriority priority,
+                               PrismCompletionCallback callback,
+                               void *userdata, PrismUtteranceId *out_id) {
+  std::string_view view{text, length};
+  if (backend->text_filters == 0) {
+    if (const auto ok = check_text(text, length, flags); !ok)
+      return to_prism_error(ok.error());
+  } else {
+    // The worker copies the text, so the scratch buffer can be reused.
+    const auto prepared = prepare_speech(backend, text, length, flags);
+    if (!prepared)
+      return to_prism_error(prepared.error());
+    if (!*prepared) {
+      if (out_id != nullptr)
+        *out_id = PRISM_UTTERANCE_INVALID;
+      return PRISM_OK;
+    }
+    view = **prepared;
+  }
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return to_prism_error(worker.error());
+  UtteranceWorker::Completion done;
+  if (callback != nullptr)
+    done = [callback, userdata](UtteranceId id, BackendError error) {
+      callback(userdata, id, to_prism_error(error));
+    };
+  const auto id = (*worker)->submit(view, interrupt,
+                                    UtteranceWorker::Kind::Speak,
+                                    std::move(done), priority);
+  if (!id)
+    return to_prism_error(id.error());
+  if (out_id != nullptr)
+    *out_id = *id;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_speak_async(
+    PrismBackend *backend, const char *PRISM_RESTRICT text, size_t length,
+    bool interrupt, uint32_t flags, PrismCompletionCallback callback,
+    void *userdata, PrismUtteranceId *PRISM_RESTRICT out_id) {
+  return submit_async(backend, text, length, flags, interrupt,
+                      SpeechPriority::Message, callback, userdata, out_id);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_speak_prioritized(PrismBackend *backend,
+                                const char *PRISM_RESTRICT text, size_t length,
+                                PrismSpeechPriority priority, uint32_t flags,
+                                PrismCompletionCallback callback,
+                                void *userdata,
+                                PrismUtteranceId *PRISM_RESTRICT out_id) {
+  if (priority < 0 || priority >= PRISM_SPEECH_PRIORITY_COUNT)
+    return PRISM_ERROR_INVALID_PARAM;
+  return submit_async(backend, text, length, flags, false,
+                      static_cast<SpeechPriority>(priority), callback,
+                      userdata, out_id);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_wait(PrismBackend *backend, PrismUtteranceId utterance) {
+  if (!backend->worker)
+    return PRISM_ERROR_INVALID_PARAM;
+  const auto r = backend->worker->wait(utterance);
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_set_coalescing(PrismBackend *backend, uint32_t window_ms) {
+  if (window_ms == 0 && !backend->worker)
+    return PRISM_OK;
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return to_prism_error(worker.error());
+  (*worker)->set_coalescing(std::chrono::milliseconds{window_ms});
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_set_text_filters(PrismBackend *backend, uint32_t filters) {
+  if ((filters & ~TextFilter::KNOWN) != 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  backend->text_filters = filters;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_set_segmentation(PrismBackend *backend,
+                               size_t max_segment_bytes) {
+  backend->segment_bytes = max_segment_bytes;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_feed_open(PrismBackend *backend, bool interrupt) {
+  if (const auto worker = ensure_worker(backend); !worker)
+    return to_prism_error(worker.error());
+  backend->feed.clear();
+  backend->feed_open = true;
+  backend->feed_interrupt = interrupt;
+  backend->feed_stops = backend->stops.load(std::memory_order_acquire);
+  backend->feed_last = 0;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_feed_append(
+    PrismBackend *backend, const char *PRISM_RESTRICT text, size_t length) {
+  if (!backend->feed_open)
+    return PRISM_ERROR_INVALID_OPERATION;
+  discard_stopped_feed(backend);
+  try {
+    if (!backend->feed.append({text, length}))
+      return PRISM_ERROR_INVALID_UTF8;
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  auto &worker = *backend->worker;
+  for (auto unit = backend->feed.next(); !unit.empty();
+       unit = backend->feed.next())
+    if (const auto r = speak_fed(backend, worker, unit); !r)
+      return to_prism_error(r.error());
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_feed_close(PrismBackend *backend) {
+  if (!backend->feed_open)
+    return PRISM_ERROR_INVALID_OPERATION;
+  backend->feed_open = false;
+  discard_stopped_feed(backend);
+  auto &worker = *backend->worker;
+  const auto rest = backend->feed.finish();
+  BackendResult<> r;
+  if (!rest)
+    r = std::unexpected(BackendError::InvalidUtf8);
+  else if (!rest->empty())
+    r = speak_fed(backend, worker, *rest);
+  backend->feed.clear();
+  if (!r)
+    return to_prism_error(r.error());
+  // Waiting for the last unit reports whether the backend accepted it.
+  if (backend->feed_last == 0 || worker.on_worker_thread())
+    return PRISM_OK;
+  const auto last = worker.wait(std::exchange(backend->feed_last, 0));
+  return last ? PRISM_OK : to_prism_error(last.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_get_coalescing_stats(
+    PrismBackend *backend, PrismCoalescingStats *PRISM_RESTRICT out_stats) {
+  if (!backend->worker) {
+    *out_stats = {};
+    return PRISM_OK;
+  }
+  const auto stats = backend->worker->coalescing_stats();
+  out_stats->dropped = stats.dropped;
+  out_stats->deduplicated = stats.deduplicated;
+  return PRISM_OK;
+}
+
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_speak_to_memory(
     PrismBackend *backend, const char *PRISM_RESTRICT text,
     PrismAudioCallback callback, void *userdata) {
-  if (!simdutf::validate_utf8(text, std::string_view{text}.size()))
-    return PRISM_ERROR_INVALID_UTF8;
-  const auto r = backend->impl->speak_to_memory(
-      text,
+  return prism_backend_speak_to_memory_n(backend, text,
+                                         std::string_view{text}.size(),
+                                         callback, userdata,
+                                         PRISM_TEXT_NUL_TERMINATED);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_speak_to_memory_n(PrismBackend *backend,
+                                const char *PRISM_RESTRICT text, size_t length,
+                                PrismAudioCallback callback, void *userdata,
+                                uint32_t flags) {
+  const LatencyScope timing(backend->id, StatsOperation::SpeakToMemory);
+  const auto view = prepare_speech(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  if (!*view)
+    return PRISM_OK;
+  const auto guard = lock_backend(backend);
+  const auto r = render_segmented(
+      backend, **view,
       [callback, userdata](void *, const float *samples, size_t count,
                            size_t ch, size_t sr) {
         callback(userdata, samples, count, ch, sr);
       },
-      nullptr);
+      {});
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PRISM_MALLOC PrismCancelToken *PRISM_CALL
+prism_cancel_token_new(void) {
+  return new (std::nothrow) PrismCancelToken;
+}
+
+PRISM_API void PRISM_CALL prism_cancel_token_cancel(PrismCancelToken *token) {
+  token->source.request_stop();
+}
+
+PRISM_API PRISM_NODISCARD bool PRISM_CALL
+prism_cancel_token_is_cancelled(const PrismCancelToken *token) {
+  return token->source.stop_requested();
+}
+
+PRISM_API void PRISM_CALL prism_cancel_token_free(PrismCancelToken *token) {
+  delete token;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_speak_to_memory_ex(PrismBackend *backend,
+                                 const char *PRISM_RESTRICT text, size_t length,
+                                 PrismAudioCallback callback, void *userdata,
+                                 uint32_t flags,
+                                 const PrismMemoryOptions *options) {
+  const LatencyScope timing(backend->id, StatsOperation::SpeakToMemory);
+  return render_to_memory(
+      backend, text, length, flags, options, false,
+      [callback, userdata](const void *data, std::size_t frames,
+                           std::size_t ch, std::size_t sr, SampleFormat) {
+        callback(userdata, static_cast<const float *>(data), frames * ch, ch,
+                 sr);
+      });
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_speak_to_memory_pcm(PrismBackend *backend,
+                                  const char *PRISM_RESTRICT text,
+                                  size_t length, PrismPcmCallback callback,
+                                  void *userdata, uint32_t flags,
+                                  const PrismMemoryOptions *options) {
+  const LatencyScope timing(backend->id, StatsOperation::SpeakToMemory);
+  return render_to_memory(
+      backend, text, length, flags, options, true,
+      [callback, userdata](const void *data, std::size_t frames,
+                           std::size_t ch, std::size_t sr,
+                           SampleFormat format) {
+        callback(userdata, data, frames, ch, sr,
+                 static_cast<PrismSampleFormat>(format));
+      });
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_prerender(PrismBackend *backend, const char *const *texts,
+                        size_t count, PrismSpeechPriority priority) {
+  if (priority < 0 || priority >= PRISM_SPEECH_PRIORITY_COUNT)
+    return PRISM_ERROR_INVALID_PARAM;
+  std::vector<std::string_view> views;
+  try {
+    views.reserve(count);
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (texts[i] == nullptr)
+      return PRISM_ERROR_INVALID_PARAM;
+    const std::string_view text{texts[i]};
+    if (const auto ok = check_text(text.data(), text.size(), 0); !ok)
+      return to_prism_error(ok.error());
+    views.push_back(text);
+  }
+  const auto prerenderer = ensure_prerenderer(backend);
+  if (!prerenderer)
+    return to_prism_error(prerenderer.error());
+  try {
+    (*prerenderer)->prerender(views, static_cast<SpeechPriority>(priority));
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_hint(PrismBackend *backend, const char *PRISM_RESTRICT text) {
+  const std::string_view view{text};
+  if (const auto ok = check_text(view.data(), view.size(), 0); !ok)
+    return to_prism_error(ok.error());
+  const auto prerenderer = ensure_prerenderer(backend);
+  if (!prerenderer)
+    return to_prism_error(prerenderer.error());
+  try {
+    (*prerenderer)->hint(view);
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_cancel_hints(PrismBackend *backend) {
+  if (backend->prerenderer)
+    backend->prerenderer->cancel_hints();
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_group_new(PrismBackend *const *members, size_t count,
+                        PrismBackendGroup **PRISM_RESTRICT out_group) {
+  if (count == 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  const std::span list{members, count};
+  for (std::size_t i = 0; i < count; ++i) {
+    if (list[i] == nullptr ||
+        std::ranges::find(list.first(i), list[i]) != list.begin() + i)
+      return PRISM_ERROR_INVALID_PARAM;
+  }
+  std::vector<UtteranceWorker *> workers;
+  try {
+    workers.reserve(count);
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  for (auto *member : list) {
+    const auto worker = ensure_worker(member);
+    if (!worker)
+      return to_prism_error(worker.error());
+    workers.push_back(*worker);
+  }
+  try {
+    *out_group = new PrismBackendGroup{
+        .group = BackendGroup(std::move(workers)),
+        .members = std::vector<PrismBackend *>(list.begin(), list.end())};
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_backend_group_free(PrismBackendGroup *group) {
+  delete group;
+}
+
+PRISM_API PRISM_NODISCARD size_t PRISM_CALL
+prism_backend_group_count(PrismBackendGroup *group) {
+  return group->group.size();
+}
+
+// The text each member would speak through prism_backend_speak, after its
+// own filters, or nothing where they dropped it. Filtered text lives in the
+// member's scratch buffer.
+static BackendResult<std::vector<std::optional<std::string_view>>>
+member_texts(std::span<PrismBackend *const> members, std::string_view text,
+             bool filtered) {
+  try {
+    std::vector<std::optional<std::string_view>> texts;
+    texts.reserve(members.size());
+    for (auto *member : members) {
+      if (!filtered || member->text_filters == 0) {
+        texts.emplace_back(text);
+        continue;
+      }
+      auto &scratch = member->text_scratch;
+      scratch.clear();
+      if (normalize_text(text, member->text_filters, scratch))
+        texts.emplace_back(scratch);
+      else
+        texts.emplace_back();
+    }
+    return texts;
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+}
+
+static PrismError broadcast(PrismBackendGroup *group, std::string_view text,
+                            bool interrupt, UtteranceWorker::Kind kind,
+                            uint32_t timeout_ms, PrismError *out_results) {
+  auto &g = group->group;
+  const auto texts = member_texts(group->members, text,
+                                  kind == UtteranceWorker::Kind::Speak ||
+                                      kind == UtteranceWorker::Kind::Output);
+  if (!texts)
+    return to_prism_error(texts.error());
+  std::vector<BackendError> results;
+  try {
+    results.resize(out_results != nullptr ? g.size() : 0);
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  const auto r = g.broadcast(*texts, interrupt, kind,
+                             std::chrono::milliseconds(timeout_ms), results);
+  for (std::size_t i = 0; i < results.size(); ++i)
+    out_results[i] = to_prism_error(results[i]);
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_group_speak(
+    PrismBackendGroup *group, const char *PRISM_RESTRICT text, size_t length,
+    bool interrupt, uint32_t flags, uint32_t timeout_ms,
+    PrismError *out_results) {
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return to_prism_error(ok.error());
+  return broadcast(group, {text, length}, interrupt,
+                   UtteranceWorker::Kind::Speak, timeout_ms, out_results);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_group_output(
+    PrismBackendGroup *group, const char *PRISM_RESTRICT text, size_t length,
+    bool interrupt, uint32_t flags, uint32_t timeout_ms,
+    PrismError *out_results) {
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return to_prism_error(ok.error());
+  return broadcast(group, {text, length}, interrupt,
+                   UtteranceWorker::Kind::Output, timeout_ms, out_results);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_group_braille(
+    PrismBackendGroup *group, const char *PRISM_RESTRICT text, size_t length,
+    uint32_t flags, uint32_t timeout_ms, PrismError *out_results) {
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return to_prism_error(ok.error());
+  return broadcast(group, {text, length}, false,
+                   UtteranceWorker::Kind::Braille, timeout_ms, out_results);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_group_stop(PrismBackendGroup *group, uint32_t timeout_ms,
+                         PrismError *out_results) {
+  for (auto *member : group->members)
+    member->stops.fetch_add(1, std::memory_order_acq_rel);
+  return broadcast(group, {}, false, UtteranceWorker::Kind::Stop, timeout_ms,
+                   out_results);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_failover_new(PrismBackend *const *members, size_t count,
+                   const PrismFailoverOptions *options,
+                   PrismFailover **PRISM_RESTRICT out_failover) {
+  if (count == 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  PrismFailoverOptions opts{};
+  if (options != nullptr) {
+    if (options->size == 0)
+      return PRISM_ERROR_INVALID_PARAM;
+    std::memcpy(&opts, options, std::min(options->size, sizeof(opts)));
+    if (!(opts.error_threshold >= 0.0F && opts.error_threshold <= 1.0F))
+      return PRISM_ERROR_INVALID_PARAM;
+  }
+  Failover::Options policy;
+  using std::chrono::milliseconds;
+  if (opts.timeout_ms != 0)
+    policy.timeout = milliseconds(opts.timeout_ms);
+  policy.hedge = milliseconds(opts.hedge_ms);
+  if (opts.latency_threshold_ms != 0)
+    policy.latency_threshold = milliseconds(opts.latency_threshold_ms);
+  if (opts.cooldown_ms != 0)
+    policy.cooldown = milliseconds(opts.cooldown_ms);
+  if (opts.error_threshold != 0.0F)
+    policy.error_threshold = opts.error_threshold;
+  const std::span list{members, count};
+  for (std::size_t i = 0; i < count; ++i) {
+    if (list[i] == nullptr ||
+        std::ranges::find(list.first(i), list[i]) != list.begin() + i)
+      return PRISM_ERROR_INVALID_PARAM;
+  }
+  try {
+    std::vector<UtteranceWorker *> workers;
+    workers.reserve(count);
+    for (auto *member : list) {
+      const auto worker = ensure_worker(member);
+      if (!worker)
+        return to_prism_error(worker.error());
+      workers.push_back(*worker);
+    }
+    *out_failover = new PrismFailover{
+        .failover = Failover(workers, policy),
+        .members = std::vector<PrismBackend *>(list.begin(), list.end())};
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_failover_free(PrismFailover *failover) {
+  delete failover;
+}
+
+PRISM_API PRISM_NODISCARD size_t PRISM_CALL
+prism_failover_count(PrismFailover *failover) {
+  return failover->failover.size();
+}
+
+static PrismError failover_submit(PrismFailover *failover, const char *text,
+                                  std::size_t length, bool interrupt,
+                                  std::uint32_t flags,
+                                  UtteranceWorker::Kind kind,
+                                  std::size_t *out_member) {
+  if (const auto ok = check_text(text, length, flags); !ok)
+    return to_prism_error(ok.error());
+  const auto texts = member_texts(failover->members, {text, length}, true);
+  if (!texts)
+    return to_prism_error(texts.error());
+  const auto member = failover->failover.submit(*texts, interrupt, kind);
+  if (!member)
+    return to_prism_error(member.error());
+  if (out_member != nullptr)
+    *out_member = *member;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_failover_speak(PrismFailover *failover, const char *PRISM_RESTRICT text,
+                     size_t length, bool interrupt, uint32_t flags,
+                     size_t *out_member) {
+  return failover_submit(failover, text, length, interrupt, flags,
+                         UtteranceWorker::Kind::Speak, out_member);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_failover_output(PrismFailover *failover, const char *PRISM_RESTRICT text,
+                      size_t length, bool interrupt, uint32_t flags,
+                      size_t *out_member) {
+  return failover_submit(failover, text, length, interrupt, flags,
+                         UtteranceWorker::Kind::Output, out_member);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_failover_get_health(PrismFailover *failover, size_t index,
+                          PrismBackendHealth *PRISM_RESTRICT out_health) {
+  auto &f = failover->failover;
+  if (index >= f.size())
+    return PRISM_ERROR_RANGE_OUT_OF_BOUNDS;
+  const auto health = f.health(index);
+  *out_health = {.error_rate = health.error_rate,
+                 .latency_ms = health.latency_ms,
+                 .successes = health.successes,
+                 .failures = health.failures,
+                 .circuit_open = health.open};
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_open_stream(
+    PrismBackend *backend, const char *PRISM_RESTRICT text, size_t length,
+    uint32_t flags, size_t capacity_frames,
+    PrismAudioStream **PRISM_RESTRICT out_stream) {
+  if (capacity_frames == 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  const auto view = prepare_text(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  const auto worker = ensure_worker(backend);
+  if (!worker)
+    return to_prism_error(worker.error());
+  try {
+    std::unique_ptr<PrismAudioStream> stream(new PrismAudioStream{
+        .stream = {backend->impl, **worker, *view, capacity_frames},
+        .backend = backend});
+    std::scoped_lock lock(backend->streams_mutex);
+    backend->streams.push_back(&stream->stream);
+    *out_stream = stream.release();
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  } catch (const std::system_error &) {
+    return PRISM_ERROR_INTERNAL;
+  }
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_audio_stream_get_format(
+    PrismAudioStream *stream, size_t *PRISM_RESTRICT out_channels,
+    size_t *PRISM_RESTRICT out_sample_rate) {
+  const auto format = stream->stream.format();
+  if (!format)
+    return to_prism_error(format.error());
+  *out_channels = format->first;
+  *out_sample_rate = format->second;
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_audio_stream_read(PrismAudioStream *stream, float *PRISM_RESTRICT dst,
+                        size_t frames, bool wait,
+                        size_t *PRISM_RESTRICT out_frames) {
+  const auto got = stream->stream.read(dst, frames, wait);
+  if (!got)
+    return to_prism_error(got.error());
+  *out_frames = *got;
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_audio_stream_close(PrismAudioStream *stream) {
+  if (stream == nullptr)
+    return;
+  {
+    auto &backend = *stream->backend;
+    std::scoped_lock lock(backend.streams_mutex);
+    std::erase(backend.streams, &stream->stream);
+  }
+  delete stream;
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_write_phrase_pack(PrismBackend *backend,
+                                const char *PRISM_RESTRICT path,
+                                const char *const *phrases, size_t count) {
+  std::vector<std::string_view> views;
+  try {
+    views.reserve(count);
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (phrases[i] == nullptr)
+      return PRISM_ERROR_INVALID_PARAM;
+    const std::string_view text{phrases[i]};
+    if (!simdutf::validate_utf8(text.data(), text.size()))
+      return PRISM_ERROR_INVALID_UTF8;
+    views.push_back(text);
+  }
+  const auto guard = lock_backend(backend);
+  const auto r = write_phrase_pack(*backend->impl, path, views);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_phrase_pack_open(const char *PRISM_RESTRICT path,
+                       PrismPhrasePack **PRISM_RESTRICT out_pack) {
+  auto pack = PhrasePack::open(path);
+  if (!pack)
+    return to_prism_error(pack.error());
+  *out_pack = reinterpret_cast<PrismPhrasePack *>(pack->release());
+  return PRISM_OK;
+}
+
+PRISM_API PRISM_NODISCARD size_t PRISM_CALL
+prism_phrase_pack_count(PrismPhrasePack *pack) {
+  return reinterpret_cast<PhrasePack *>(pack)->count();
+}
+
+PRISM_API PRISM_NODISCARD bool PRISM_CALL
+prism_phrase_pack_find(PrismPhrasePack *pack, const char *PRISM_RESTRICT text,
+                       size_t length,
+                       PrismPhraseAudio *PRISM_RESTRICT out_audio) {
+  const auto audio =
+      reinterpret_cast<PhrasePack *>(pack)->find({text, length});
+  if (!audio)
+    return false;
+  out_audio->samples = audio->samples.data();
+  out_audio->frames =
+      audio->channels == 0 ? 0 : audio->samples.size() / audio->channels;
+  out_audio->channels = audio->channels;
+  out_audio->sample_rate = audio->sample_rate;
+  return true;
+}
+
+PRISM_API void PRISM_CALL prism_phrase_pack_close(PrismPhrasePack *pack) {
+  delete reinterpret_cast<PhrasePack *>(pack);
+}
+
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_braille(PrismBackend *backend, const char *PRISM_RESTRICT text) {
-  if (!simdutf::validate_utf8(text, std::string_view{text}.size()))
-    return PRISM_ERROR_INVALID_UTF8;
-  const auto r = backend->impl->braille(text);
+  return prism_backend_braille_n(backend, text, std::string_view{text}.size(),
+                                 PRISM_TEXT_NUL_TERMINATED);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_braille_n(PrismBackend *backend, const char *PRISM_RESTRICT text,
+                        size_t length, uint32_t flags) {
+  const LatencyScope timing(backend->id, StatsOperation::Braille);
+  const auto view = prepare_text(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  const auto guard = lock_backend(backend);
+  const auto r = backend->impl->braille(*view);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_output(
     PrismBackend *backend, const char *PRISM_RESTRICT text, bool interrupt) {
-  if (!simdutf::validate_utf8(text, std::string_view{text}.size()))
-    return PRISM_ERROR_INVALID_UTF8;
-  const auto r = backend->impl->output(text, interrupt);
+  return prism_backend_output_n(backend, text, std::string_view{text}.size(),
+                                interrupt, PRISM_TEXT_NUL_TERMINATED);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_output_n(
+    PrismBackend *backend, const char *PRISM_RESTRICT text, size_t length,
+    bool interrupt, uint32_t flags) {
+  const LatencyScope timing(backend->id, StatsOperation::Output);
+  const auto view = prepare_speech(backend, text, length, flags);
+  if (!view)
+    return to_prism_error(view.error());
+  if (!*view)
+    return PRISM_OK;
+  if (const auto limit = segment_limit(backend, **view); limit != 0) {
+    const auto r = speak_segmented(backend, **view, interrupt,
+                                   UtteranceWorker::Kind::Output, limit);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  if (use_worker(backend)) {
+    const auto r = submit_and_wait(backend, **view, interrupt,
+                                   UtteranceWorker::Kind::Output);
+    return r ? PRISM_OK : to_prism_error(r.error());
+  }
+  const auto guard = lock_backend(backend);
+  const auto r = backend->impl->output(**view, interrupt);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_stop(PrismBackend *backend) {
+  const LatencyScope timing(backend->id, StatsOperation::Stop);
+  backend->stops.fetch_add(1, std::memory_order_acq_rel);
+  if (backend->worker)
+    backend->worker->cancel_pending();
+  {
+    std::scoped_lock lock(backend->streams_mutex);
+    for (auto *stream : backend->streams)
+      stream->cancel();
+  }
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->stop();
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_pause(PrismBackend *backend) {
+  const LatencyScope timing(backend->id, StatsOperation::Pause);
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->pause();
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_resume(PrismBackend *backend) {
+  const LatencyScope timing(backend->id, StatsOperation::Resume);
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->resume();
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_is_speaking(
     PrismBackend *backend, bool *PRISM_RESTRICT out_speaking) {
+  const LatencyScope timing(backend->id, StatsOperation::IsSpeaking);
+  if (backend->worker && backend->worker->busy()) {
+    *out_speaking = true;
+    return PRISM_OK;
+  }
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->is_speaking();
   if (!r)
     return to_prism_error(r.error());
@@ -421,31 +2183,70 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_is_speaking(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_set_volume(PrismBackend *backend, float volume) {
+  const LatencyScope timing(backend->id, StatsOperation::SetParameter);
   if (!std::isfinite(volume) || volume < 0.0F || volume > 1.0F)
     return PRISM_ERROR_RANGE_OUT_OF_BOUNDS;
-  const auto r = backend->impl->set_volume(volume);
+  const auto guard = lock_backend(backend);
+  VoiceParams params;
+  params.volume = volume;
+  const auto r = write_params(backend, params);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_set_rate(PrismBackend *backend, float rate) {
+  const LatencyScope timing(backend->id, StatsOperation::SetParameter);
   if (!std::isfinite(rate) || rate < 0.0F || rate > 1.0F)
     return PRISM_ERROR_RANGE_OUT_OF_BOUNDS;
-  const auto r = backend->impl->set_rate(rate);
+  const auto guard = lock_backend(backend);
+  VoiceParams params;
+  params.rate = rate;
+  const auto r = write_params(backend, params);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_set_pitch(PrismBackend *backend, float pitch) {
+  const LatencyScope timing(backend->id, StatsOperation::SetParameter);
   if (!std::isfinite(pitch) || pitch < 0.0F || pitch > 1.0F)
     return PRISM_ERROR_RANGE_OUT_OF_BOUNDS;
-  const auto r = backend->impl->set_pitch(pitch);
+  const auto guard = lock_backend(backend);
+  VoiceParams params;
+  params.pitch = pitch;
+  const auto r = write_params(backend, params);
+  return r ? PRISM_OK : to_prism_error(r.error());
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_set_params(PrismBackend *backend, uint32_t mask, float volume,
+                         float rate, float pitch, size_t voice_id) {
+  const LatencyScope timing(backend->id, StatsOperation::SetParameter);
+  if ((mask & ~known_param_flags) != 0)
+    return PRISM_ERROR_INVALID_PARAM;
+  VoiceParams params;
+  for (auto [flag, value, out] :
+       {std::tuple{PRISM_PARAM_VOLUME, volume, &params.volume},
+        std::tuple{PRISM_PARAM_RATE, rate, &params.rate},
+        std::tuple{PRISM_PARAM_PITCH, pitch, &params.pitch}}) {
+    if ((mask & flag) == 0)
+      continue;
+    if (!std::isfinite(value) || value < 0.0F || value > 1.0F)
+      return PRISM_ERROR_RANGE_OUT_OF_BOUNDS;
+    *out = value;
+  }
+  if ((mask & PRISM_PARAM_VOICE) != 0)
+    params.voice = voice_id;
+  const auto guard = lock_backend(backend);
+  const auto r = write_params(backend, params);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_volume(
     PrismBackend *backend, float *PRISM_RESTRICT out_volume) {
-  const auto r = backend->impl->get_volume();
+  const LatencyScope timing(backend->id, StatsOperation::GetParameter);
+  const auto guard = lock_backend(backend);
+  const auto r = read_param(backend, &VoiceParams::volume,
+                            [backend] { return backend->impl->get_volume(); });
   if (!r)
     return to_prism_error(r.error());
   *out_volume = *r;
@@ -454,7 +2255,10 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_volume(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_get_rate(PrismBackend *backend, float *PRISM_RESTRICT out_rate) {
-  const auto r = backend->impl->get_rate();
+  const LatencyScope timing(backend->id, StatsOperation::GetParameter);
+  const auto guard = lock_backend(backend);
+  const auto r = read_param(backend, &VoiceParams::rate,
+                            [backend] { return backend->impl->get_rate(); });
   if (!r)
     return to_prism_error(r.error());
   *out_rate = *r;
@@ -463,7 +2267,10 @@ prism_backend_get_rate(PrismBackend *backend, float *PRISM_RESTRICT out_rate) {
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_pitch(
     PrismBackend *backend, float *PRISM_RESTRICT out_pitch) {
-  const auto r = backend->impl->get_pitch();
+  const LatencyScope timing(backend->id, StatsOperation::GetParameter);
+  const auto guard = lock_backend(backend);
+  const auto r = read_param(backend, &VoiceParams::pitch,
+                            [backend] { return backend->impl->get_pitch(); });
   if (!r)
     return to_prism_error(r.error());
   *out_pitch = *r;
@@ -472,12 +2279,18 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_pitch(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_refresh_voices(PrismBackend *backend) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
+  backend->impl->voices_changed();
+  backend->impl->param_shadow().forget();
   const auto r = backend->impl->refresh_voices();
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_count_voices(
     PrismBackend *backend, size_t *PRISM_RESTRICT out_count) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->count_voices();
   if (!r)
     return to_prism_error(r.error());
@@ -488,6 +2301,8 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_count_voices(
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_get_voice_name(PrismBackend *backend, size_t voice_id,
                              const char **PRISM_RESTRICT out_name) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
   auto r = backend->impl->get_voice_name(voice_id);
   if (!r)
     return to_prism_error(r.error());
@@ -499,6 +2314,8 @@ prism_backend_get_voice_name(PrismBackend *backend, size_t voice_id,
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_get_voice_language(PrismBackend *backend, size_t voice_id,
                                  const char **PRISM_RESTRICT out_language) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
   auto r = backend->impl->get_voice_language(voice_id);
   if (!r)
     return to_prism_error(r.error());
@@ -507,15 +2324,86 @@ prism_backend_get_voice_language(PrismBackend *backend, size_t voice_id,
   return PRISM_OK;
 }
 
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_get_voices(PrismBackend *backend,
+                         PrismVoiceList **PRISM_RESTRICT out_list) {
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  VoiceList voices;
+  try {
+    const auto guard = lock_backend(backend);
+    if (const auto r = backend->impl->get_voices(voices); !r)
+      return to_prism_error(r.error());
+  } catch (const std::bad_alloc &) {
+    return PRISM_ERROR_MEMORY_FAILURE;
+  }
+  // The list, its voices and their strings share one block, in that order.
+  static_assert(sizeof(PrismVoiceList) % alignof(PrismVoice) == 0);
+  const auto &strings = voices.strings();
+  const auto count = voices.size();
+  const auto bytes =
+      sizeof(PrismVoiceList) + (count * sizeof(PrismVoice)) + strings.size();
+  auto *block = new (std::nothrow) std::byte[bytes];
+  if (block == nullptr)
+    return PRISM_ERROR_MEMORY_FAILURE;
+  auto *entries =
+      reinterpret_cast<PrismVoice *>(block + sizeof(PrismVoiceList));
+  auto *text = reinterpret_cast<char *>(entries + count);
+  std::ranges::copy(strings, text);
+  for (std::size_t i = 0; i < count; ++i)
+    std::construct_at(
+        entries + i,
+        PrismVoice{.name = text + voices[i].name,
+                   .language = text + voices[i].language,
+                   .index = i,
+                   .id = VoiceList::stable_id(voices.name(i),
+                                              voices.language(i))});
+  *out_list = std::construct_at(reinterpret_cast<PrismVoiceList *>(block),
+                                PrismVoiceList{.count = count,
+                                               .voices = entries});
+  return PRISM_OK;
+}
+
+PRISM_API void PRISM_CALL prism_voice_list_free(PrismVoiceList *list) {
+  delete[] reinterpret_cast<std::byte *>(list);
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_find_voice(
+    PrismBackend *backend, const char *PRISM_RESTRICT query,
+    PrismVoiceQuery kind, size_t *PRISM_RESTRICT out_voice_id) {
+  if (kind < 0 || kind >= PRISM_VOICE_QUERY_COUNT)
+    return PRISM_ERROR_INVALID_PARAM;
+  const std::string_view text{query};
+  if (!simdutf::validate_utf8(text.data(), text.size()))
+    return PRISM_ERROR_INVALID_UTF8;
+  return find_voice(backend, out_voice_id, [&](VoiceIndex &index) {
+    return kind == PRISM_VOICE_QUERY_NAME ? index.find_name(text)
+                                          : index.find_language(text);
+  });
+}
+
+PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
+prism_backend_find_voice_by_id(PrismBackend *backend, uint64_t id,
+                               size_t *PRISM_RESTRICT out_voice_id) {
+  return find_voice(backend, out_voice_id,
+                    [id](VoiceIndex &index) { return index.find_id(id); });
+}
+
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL
 prism_backend_set_voice(PrismBackend *backend, size_t voice_id) {
-  const auto r = backend->impl->set_voice(voice_id);
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
+  VoiceParams params;
+  params.voice = voice_id;
+  const auto r = write_params(backend, params);
   return r ? PRISM_OK : to_prism_error(r.error());
 }
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_voice(
     PrismBackend *backend, size_t *PRISM_RESTRICT out_voice_id) {
-  const auto r = backend->impl->get_voice();
+  const LatencyScope timing(backend->id, StatsOperation::Voices);
+  const auto guard = lock_backend(backend);
+  const auto r = read_param(backend, &VoiceParams::voice,
+                            [backend] { return backend->impl->get_voice(); });
   if (!r)
     return to_prism_error(r.error());
   *out_voice_id = *r;
@@ -524,6 +2412,7 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_voice(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_channels(
     PrismBackend *backend, size_t *PRISM_RESTRICT out_channels) {
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->get_channels();
   if (!r)
     return to_prism_error(r.error());
@@ -533,6 +2422,7 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_channels(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_sample_rate(
     PrismBackend *backend, size_t *PRISM_RESTRICT out_sample_rate) {
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->get_sample_rate();
   if (!r)
     return to_prism_error(r.error());
@@ -542,6 +2432,7 @@ PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_sample_rate(
 
 PRISM_API PRISM_NODISCARD PrismError PRISM_CALL prism_backend_get_bit_depth(
     PrismBackend *backend, size_t *PRISM_RESTRICT out_bit_depth) {
+  const auto guard = lock_backend(backend);
   const auto r = backend->impl->get_bit_depth();
   if (!r)
     return to_prism_error(r.error());
@@ -574,7 +2465,10 @@ prism_error_string(PrismError error) {
                                         "Backend entered undefined state",
                                         "Shared library load failed",
                                         "Shared library is not a Prism plugin",
-                                        "Incompatible plugin ABI"};
+                                        "Incompatible plugin ABI",
+                                        "Operation cancelled",
+                                        "File I/O failure",
+                                        "Timed out"};
   static_assert(std::size(strings) == PRISM_ERROR_COUNT,
                 "Error string table size mismatches error count");
   if (static_cast<std::uint32_t>(error) >= PRISM_ERROR_COUNT)
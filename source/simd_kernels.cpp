@@ -1,7 +1,11 @@
 // SPDX-License-Identifier: MPL-2.0
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <span>
+#include <string_view>
 
 #undef HWY_TARGET_INCLUDE
 #define HWY_TARGET_INCLUDE "simd_kernels.cpp"
@@ -49,6 +53,130 @@ HWY_ATTR void fill_frame_db_impl(std::span<const float> interleaved,
     hn::StoreN(hn::Mul(scale, hn::Log10(d, ms)), d, db.data() + i, rest);
   }
 }
+
+// Linear interpolation of mono audio: out[j] sits at in position
+// start + j * step. The caller guarantees every position it asks for has a
+// right-hand neighbour inside `in`.
+HWY_ATTR void resample_linear_impl(std::span<const float> in, double start,
+                                   double step, std::span<float> out) {
+  const hn::ScalableTag<float> d;
+  const hn::RebindToSigned<decltype(d)> di;
+  const auto N = hn::Lanes(d);
+  const auto lanes =
+      hn::Mul(hn::Iota(d, 0.0F), hn::Set(d, static_cast<float>(step)));
+  const std::size_t n = out.size();
+  std::size_t j = 0;
+  for (; j + N <= n; j += N) {
+    // Keep the large part of the position in double and gather relative to
+    // it, so float lanes only ever hold small offsets.
+    const double p0 = start + (static_cast<double>(j) * step);
+    const auto i0 = static_cast<std::size_t>(p0);
+    const auto pos =
+        hn::Add(hn::Set(d, static_cast<float>(p0 - static_cast<double>(i0))),
+                lanes);
+    const auto whole = hn::Floor(pos);
+    const auto frac = hn::Sub(pos, whole);
+    const auto idx = hn::ConvertTo(di, whole);
+    const float *HWY_RESTRICT base = in.data() + i0;
+    const auto a = hn::GatherIndex(d, base, idx);
+    const auto b = hn::GatherIndex(d, base + 1, idx);
+    hn::StoreU(hn::MulAdd(hn::Sub(b, a), frac, a), d, out.data() + j);
+  }
+  for (; j < n; ++j) {
+    const double pos = start + (static_cast<double>(j) * step);
+    const auto i = static_cast<std::size_t>(pos);
+    const auto frac = static_cast<float>(pos - static_cast<double>(i));
+    out[j] = in[i] + ((in[i + 1] - in[i]) * frac);
+  }
+}
+
+template <class DI>
+HWY_ATTR hn::VFromD<DI> quantize(DI /* tag */, const float *HWY_RESTRICT p,
+                                 float scale) {
+  const hn::Rebind<float, DI> d;
+  const auto v = hn::Min(hn::Max(hn::LoadU(d, p), hn::Set(d, -1.0F)),
+                         hn::Set(d, 1.0F));
+  return hn::NearestInt(hn::Mul(v, hn::Set(d, scale)));
+}
+
+HWY_ATTR void quantize_s16_impl(std::span<const float> in,
+                                std::span<std::int16_t> out) {
+  const hn::ScalableTag<std::int32_t> di;
+  const hn::Rebind<std::int16_t, decltype(di)> d16;
+  const auto N = hn::Lanes(di);
+  const std::size_t n = in.size();
+  std::size_t i = 0;
+  for (; i + N <= n; i += N)
+    hn::StoreU(hn::DemoteTo(d16, quantize(di, in.data() + i, 32767.0F)), d16,
+               out.data() + i);
+  for (; i < n; ++i)
+    out[i] = static_cast<std::int16_t>(
+        std::lround(std::clamp(in[i], -1.0F, 1.0F) * 32767.0F));
+}
+
+// Packed little-endian 24-bit samples, as stored in WAV files.
+HWY_ATTR void quantize_s24_impl(std::span<const float> in,
+                                std::span<std::uint8_t> out) {
+  const hn::ScalableTag<std::int32_t> di;
+  const auto N = hn::Lanes(di);
+  HWY_ALIGN std::array<std::int32_t, hn::MaxLanes(di)> lanes{};
+  const std::size_t n = in.size();
+  const auto pack = [&out](std::size_t at, std::int32_t v) {
+    out[(at * 3) + 0] = static_cast<std::uint8_t>(v & 0xFF);
+    out[(at * 3) + 1] = static_cast<std::uint8_t>((v >> 8) & 0xFF);
+    out[(at * 3) + 2] = static_cast<std::uint8_t>((v >> 16) & 0xFF);
+  };
+  std::size_t i = 0;
+  for (; i + N <= n; i += N) {
+    hn::Store(quantize(di, in.data() + i, 8388607.0F), di, lanes.data());
+    for (std::size_t k = 0; k < N; ++k)
+      pack(i + k, lanes[k]);
+  }
+  for (; i < n; ++i)
+    pack(i, static_cast<std::int32_t>(
+                std::lround(std::clamp(in[i], -1.0F, 1.0F) * 8388607.0F)));
+}
+
+// The bytes the text normalizer has to look at itself: C0 controls and DEL,
+// the 0xC2 lead byte of C1 controls and U+00A0, the second of two spaces,
+// and with `markup` the '<' and '&' that may open a tag or entity. Anything
+// else is copied through as it is.
+HWY_ATTR std::size_t find_text_special_impl(std::string_view text,
+                                            std::size_t from, bool markup) {
+  const hn::ScalableTag<std::uint8_t> d;
+  const auto N = hn::Lanes(d);
+  const auto *HWY_RESTRICT p =
+      reinterpret_cast<const std::uint8_t *>(text.data());
+  const auto control_end = hn::Set(d, 0x20);
+  const auto del = hn::Set(d, 0x7F);
+  const auto lead = hn::Set(d, 0xC2);
+  const auto space = hn::Set(d, ' ');
+  // Without markup these collapse onto DEL, which is caught anyway.
+  const auto open = hn::Set(d, markup ? '<' : 0x7F);
+  const auto amp = hn::Set(d, markup ? '&' : 0x7F);
+  const std::size_t n = text.size();
+  std::size_t i = from;
+  // The second load reads one byte ahead, so stop a byte short.
+  for (; i + N < n; i += N) {
+    const auto v = hn::LoadU(d, p + i);
+    const auto next = hn::LoadU(d, p + i + 1);
+    const auto hit = hn::Or(
+        hn::Or(hn::Lt(v, control_end), hn::Eq(v, del)),
+        hn::Or(hn::Or(hn::Eq(v, lead), hn::Eq(v, open)),
+               hn::Or(hn::Eq(v, amp),
+                      hn::And(hn::Eq(v, space), hn::Eq(next, space)))));
+    if (const auto at = hn::FindFirstTrue(d, hit); at >= 0)
+      return i + static_cast<std::size_t>(at);
+  }
+  for (; i < n; ++i) {
+    const auto c = p[i];
+    if (c < 0x20 || c == 0x7F || c == 0xC2 ||
+        (markup && (c == '<' || c == '&')) ||
+        (c == ' ' && i + 1 < n && p[i + 1] == ' '))
+      return i;
+  }
+  return n;
+}
 } // namespace HWY_NAMESPACE
 HWY_AFTER_NAMESPACE();
 
@@ -61,4 +189,28 @@ void fill_frame_db(std::span<const float> interleaved, std::size_t channels,
   HWY_DYNAMIC_DISPATCH(fill_frame_db_impl)
   (interleaved, channels, frame_len, hop, total_frames, db);
 }
+
+HWY_EXPORT(resample_linear_impl);
+HWY_EXPORT(quantize_s16_impl);
+HWY_EXPORT(quantize_s24_impl);
+
+void resample_linear(std::span<const float> in, double start, double step,
+                     std::span<float> out) {
+  HWY_DYNAMIC_DISPATCH(resample_linear_impl)(in, start, step, out);
+}
+
+void quantize_s16(std::span<const float> in, std::span<std::int16_t> out) {
+  HWY_DYNAMIC_DISPATCH(quantize_s16_impl)(in, out);
+}
+
+void quantize_s24(std::span<const float> in, std::span<std::uint8_t> out) {
+  HWY_DYNAMIC_DISPATCH(quantize_s24_impl)(in, out);
+}
+
+HWY_EXPORT(find_text_special_impl);
+
+std::size_t find_text_special(std::string_view text, std::size_t from,
+                              bool markup) {
+  return HWY_DYNAMIC_DISPATCH(find_text_special_impl)(text, from, markup);
+}
 #endif
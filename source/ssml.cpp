@@ -0,0 +1,446 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "ssml.h"
+#include "text_normalizer.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <system_error>
+#include <utility>
+
+namespace {
+bool is_space(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view trim(std::string_view s) noexcept {
+  while (!s.empty() && is_space(s.front()))
+    s.remove_prefix(1);
+  while (!s.empty() && is_space(s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+// The offset of the '>' ending the tag at the start of `text`, skipping any
+// inside quoted attribute values.
+std::size_t tag_end(std::string_view text) noexcept {
+  char quote = 0;
+  for (std::size_t i = 1; i < text.size(); ++i) {
+    const auto c = text[i];
+    if (quote != 0) {
+      if (c == quote)
+        quote = 0;
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '>') {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+std::optional<float> parse_number(std::string_view s) noexcept {
+  if (s.starts_with('+'))
+    s.remove_prefix(1);
+  float value = 0.0F;
+  const auto *last = s.data() + s.size();
+  const auto [ptr, ec] = std::from_chars(s.data(), last, value);
+  if (s.empty() || ec != std::errc{} || ptr != last || !std::isfinite(value))
+    return std::nullopt;
+  return value;
+}
+
+enum class Prosody : std::uint8_t { Rate, Pitch, Volume };
+
+using Keyword = std::pair<std::string_view, float>;
+
+// Keywords map onto fixed points of the normalized range, with "medium" the
+// engine's default. Everything relative scales the enclosing value.
+constexpr std::array<Keyword, 5> rate_keywords{{{"x-slow", 0.1F},
+                                                {"slow", 0.3F},
+                                                {"medium", 0.5F},
+                                                {"fast", 0.7F},
+                                                {"x-fast", 0.9F}}};
+constexpr std::array<Keyword, 5> pitch_keywords{{{"x-low", 0.1F},
+                                                 {"low", 0.3F},
+                                                 {"medium", 0.5F},
+                                                 {"high", 0.7F},
+                                                 {"x-high", 0.9F}}};
+constexpr std::array<Keyword, 6> volume_keywords{{{"silent", 0.0F},
+                                                  {"x-soft", 0.2F},
+                                                  {"soft", 0.4F},
+                                                  {"medium", 0.6F},
+                                                  {"loud", 0.8F},
+                                                  {"x-loud", 1.0F}}};
+
+std::optional<float> keyword(std::string_view value, Prosody which) noexcept {
+  const auto find = [value](const auto &keywords) -> std::optional<float> {
+    const auto it = std::ranges::find(keywords, value, &Keyword::first);
+    return it != keywords.end() ? std::optional{it->second} : std::nullopt;
+  };
+  switch (which) {
+  case Prosody::Rate:
+    return find(rate_keywords);
+  case Prosody::Pitch:
+    return find(pitch_keywords);
+  case Prosody::Volume:
+    return find(volume_keywords);
+  }
+  return std::nullopt;
+}
+
+// Empty for a value that cannot be applied through the normalized setters,
+// such as a pitch in hertz, which then leaves the parameter as it was.
+std::optional<float> prosody_value(std::string_view value, float parent,
+                                   float base, Prosody which) noexcept {
+  value = trim(value);
+  if (value == "default")
+    return base;
+  if (const auto fixed = keyword(value, which))
+    return fixed;
+  const bool relative = value.starts_with('+') || value.starts_with('-');
+  if (value.ends_with('%')) {
+    const auto n = parse_number(value.substr(0, value.size() - 1));
+    if (!n)
+      return std::nullopt;
+    return parent * (relative ? 1.0F + (*n / 100.0F) : *n / 100.0F);
+  }
+  if (which == Prosody::Volume) {
+    if (value.ends_with("dB")) {
+      const auto db = parse_number(value.substr(0, value.size() - 2));
+      if (!db)
+        return std::nullopt;
+      return parent * std::pow(10.0F, *db / 20.0F);
+    }
+    // SSML 1.0 volumes run from 0 to 100.
+    const auto n = parse_number(value);
+    return n && !relative ? std::optional{*n / 100.0F} : std::nullopt;
+  }
+  if (which == Prosody::Rate && !relative) {
+    // A bare number multiplies the default rate.
+    const auto n = parse_number(value);
+    return n ? std::optional{base * *n} : std::nullopt;
+  }
+  return std::nullopt;
+}
+
+void apply_prosody(std::string_view attributes, const VoiceParams &base,
+                   VoiceParams &params) {
+  const auto apply = [&](std::string_view name,
+                         std::optional<float> VoiceParams::*member,
+                         Prosody which) {
+    const auto &start = base.*member;
+    const auto value = ssml_attribute(attributes, name);
+    if (!start || !value)
+      return;
+    auto &current = params.*member;
+    const auto next =
+        prosody_value(*value, current.value_or(*start), *start, which);
+    if (!next)
+      return;
+    current = std::clamp(*next, 0.0F, 1.0F);
+    if (*current == *start)
+      current.reset();
+  };
+  apply("rate", &VoiceParams::rate, Prosody::Rate);
+  apply("pitch", &VoiceParams::pitch, Prosody::Pitch);
+  apply("volume", &VoiceParams::volume, Prosody::Volume);
+}
+
+std::uint32_t break_ms(std::string_view attributes) noexcept {
+  if (const auto time = ssml_attribute(attributes, "time")) {
+    auto t = trim(*time);
+    float scale = 1000.0F;
+    if (t.ends_with("ms")) {
+      t.remove_suffix(2);
+      scale = 1.0F;
+    } else if (t.ends_with('s')) {
+      t.remove_suffix(1);
+    }
+    const auto n = parse_number(t);
+    return n && *n > 0.0F ? static_cast<std::uint32_t>(
+                                std::min(*n * scale, 10'000.0F))
+                          : 0;
+  }
+  static constexpr std::array<std::pair<std::string_view, std::uint32_t>, 6>
+      strengths{{{"none", 0},
+                 {"x-weak", 125},
+                 {"weak", 250},
+                 {"medium", 500},
+                 {"strong", 750},
+                 {"x-strong", 1000}}};
+  const auto strength = ssml_attribute(attributes, "strength").value_or(
+      "medium");
+  const auto it = std::ranges::find(strengths, trim(strength),
+                                    [](const auto &s) { return s.first; });
+  return it != strengths.end() ? it->second : 500;
+}
+
+bool same_prosody(const VoiceParams &a, const VoiceParams &b) noexcept {
+  return a.rate == b.rate && a.pitch == b.pitch && a.volume == b.volume;
+}
+
+// Elements whose content is never spoken. <sub> is spoken as its alias.
+bool is_silent(std::string_view name) noexcept {
+  return name == "desc" || name == "lexicon" || name == "meta" ||
+         name == "metadata" || name == "sub";
+}
+
+class Reducer {
+  // Prosody nested deeper than this reads as the deepest level kept.
+  static constexpr std::size_t max_depth = 16;
+
+  const VoiceParams &base;
+  std::string &text;
+  std::vector<SsmlSegment> &segments;
+  std::array<VoiceParams, max_depth> stack{};
+  std::size_t depth = 0;
+  std::size_t silent = 0;
+  std::uint32_t pause = 0;
+  bool open = false;
+
+  [[nodiscard]] VoiceParams current() const noexcept {
+    return depth == 0 ? VoiceParams{}
+                      : stack[std::min(depth, max_depth) - 1];
+  }
+
+  void close() {
+    if (!open)
+      return;
+    open = false;
+    auto &segment = segments.back();
+    while (text.size() > segment.offset && is_space(text.back()))
+      text.pop_back();
+    segment.length = text.size() - segment.offset;
+    if (segment.length == 0) {
+      pause = std::min(pause + segment.pause_ms, 10'000U);
+      segments.pop_back();
+      return;
+    }
+    text.push_back('\0');
+  }
+
+  // Returns false if `s` is only whitespace that would start a segment.
+  bool begin(std::string_view s) {
+    const auto prosody = current();
+    if (open && pause == 0 && same_prosody(segments.back().prosody, prosody))
+      return true;
+    if (trim(s).empty())
+      return false;
+    close();
+    segments.push_back({.offset = text.size(),
+                        .length = 0,
+                        .prosody = prosody,
+                        .pause_ms = pause});
+    pause = 0;
+    open = true;
+    return true;
+  }
+
+  // Segments start at their first non-blank character.
+  [[nodiscard]] std::string_view fresh(std::string_view s) const noexcept {
+    if (text.size() != segments.back().offset)
+      return s;
+    while (!s.empty() && is_space(s.front()))
+      s.remove_prefix(1);
+    return s;
+  }
+
+  void character_data(std::string_view s) {
+    if (silent == 0 && begin(s))
+      (void)normalize_text(fresh(s), TextFilter::STRIP_TAGS, text);
+  }
+
+  void cdata(std::string_view s) {
+    if (silent == 0 && begin(s))
+      text.append(fresh(s));
+  }
+
+  void open_element(const SsmlToken &token) {
+    if (silent != 0) {
+      ++silent;
+      return;
+    }
+    if (token.name == "prosody") {
+      auto params = current();
+      apply_prosody(token.body, base, params);
+      if (depth < max_depth)
+        stack[depth] = params;
+      ++depth;
+    } else if (token.name == "break") {
+      pause_for(token.body);
+    } else if (is_silent(token.name)) {
+      if (token.name == "sub")
+        if (const auto alias = ssml_attribute(token.body, "alias"))
+          character_data(*alias);
+      silent = 1;
+    } else if (token.name == "p" || token.name == "s") {
+      separate();
+    }
+  }
+
+  void close_element(const SsmlToken &token) {
+    if (silent != 0) {
+      --silent;
+      return;
+    }
+    if (token.name == "prosody" && depth != 0)
+      --depth;
+    else if (token.name == "p" || token.name == "s")
+      separate();
+  }
+
+  void empty_element(const SsmlToken &token) {
+    if (silent != 0)
+      return;
+    if (token.name == "break")
+      pause_for(token.body);
+    else if (token.name == "sub")
+      if (const auto alias = ssml_attribute(token.body, "alias"))
+        character_data(*alias);
+  }
+
+  void pause_for(std::string_view attributes) {
+    pause = std::min(pause + break_ms(attributes), 10'000U);
+  }
+
+  // Paragraphs and sentences get a line break, which engines read as the end
+  // of a sentence even where the markup left out the punctuation.
+  void separate() {
+    if (open)
+      text.push_back('\n');
+  }
+
+public:
+  Reducer(const VoiceParams &base, std::string &text,
+          std::vector<SsmlSegment> &segments)
+      : base(base), text(text), segments(segments) {}
+
+  BackendResult<> run(std::string_view ssml) {
+    SsmlTokenizer tokens(ssml);
+    for (;;) {
+      const auto token = tokens.next();
+      if (!token)
+        return std::unexpected(token.error());
+      switch (token->kind) {
+      case SsmlToken::Kind::Text:
+        character_data(token->body);
+        break;
+      case SsmlToken::Kind::Cdata:
+        cdata(token->body);
+        break;
+      case SsmlToken::Kind::Open:
+        open_element(*token);
+        break;
+      case SsmlToken::Kind::Close:
+        close_element(*token);
+        break;
+      case SsmlToken::Kind::Empty:
+        empty_element(*token);
+        break;
+      case SsmlToken::Kind::End:
+        close();
+        return {};
+      }
+    }
+  }
+};
+} // namespace
+
+BackendResult<SsmlToken> SsmlTokenizer::next() noexcept {
+  const auto skip_past = [this](std::string_view terminator,
+                                std::size_t from) {
+    const auto end = rest.find(terminator, from);
+    if (end == std::string_view::npos)
+      return false;
+    rest.remove_prefix(end + terminator.size());
+    return true;
+  };
+  for (;;) {
+    if (rest.empty())
+      return SsmlToken{.kind = SsmlToken::Kind::End, .name = {}, .body = {}};
+    if (rest.front() != '<') {
+      const auto text = rest.substr(0, rest.find('<'));
+      rest.remove_prefix(text.size());
+      return SsmlToken{.kind = SsmlToken::Kind::Text, .name = {}, .body = text};
+    }
+    if (rest.starts_with("<!--")) {
+      if (!skip_past("-->", 4))
+        return std::unexpected(BackendError::InvalidParam);
+      continue;
+    }
+    if (rest.starts_with("<![CDATA[")) {
+      const auto end = rest.find("]]>", 9);
+      if (end == std::string_view::npos)
+        return std::unexpected(BackendError::InvalidParam);
+      const auto body = rest.substr(9, end - 9);
+      rest.remove_prefix(end + 3);
+      return SsmlToken{
+          .kind = SsmlToken::Kind::Cdata, .name = {}, .body = body};
+    }
+    if (rest.starts_with("<?")) {
+      if (!skip_past("?>", 2))
+        return std::unexpected(BackendError::InvalidParam);
+      continue;
+    }
+    if (rest.starts_with("<!")) {
+      if (!skip_past(">", 2))
+        return std::unexpected(BackendError::InvalidParam);
+      continue;
+    }
+    break;
+  }
+  const auto end = tag_end(rest);
+  if (end == std::string_view::npos)
+    return std::unexpected(BackendError::InvalidParam);
+  auto body = rest.substr(1, end - 1);
+  rest.remove_prefix(end + 1);
+  auto kind = SsmlToken::Kind::Open;
+  if (body.starts_with('/')) {
+    kind = SsmlToken::Kind::Close;
+    body.remove_prefix(1);
+  } else if (body.ends_with('/')) {
+    kind = SsmlToken::Kind::Empty;
+    body.remove_suffix(1);
+  }
+  const auto name_end = std::ranges::find_if(body, is_space) - body.begin();
+  auto name = body.substr(0, static_cast<std::size_t>(name_end));
+  body = trim(body.substr(name.size()));
+  if (const auto colon = name.rfind(':'); colon != std::string_view::npos)
+    name.remove_prefix(colon + 1);
+  if (name.empty())
+    return std::unexpected(BackendError::InvalidParam);
+  return SsmlToken{.kind = kind, .name = name, .body = body};
+}
+
+std::optional<std::string_view>
+ssml_attribute(std::string_view attributes, std::string_view name) noexcept {
+  auto rest = attributes;
+  for (;;) {
+    rest = trim(rest);
+    const auto eq = rest.find('=');
+    if (eq == std::string_view::npos)
+      return std::nullopt;
+    const auto key = trim(rest.substr(0, eq));
+    rest = trim(rest.substr(eq + 1));
+    if (rest.empty() || (rest.front() != '"' && rest.front() != '\''))
+      return std::nullopt;
+    const auto close = rest.find(rest.front(), 1);
+    if (close == std::string_view::npos)
+      return std::nullopt;
+    if (key == name)
+      return rest.substr(1, close - 1);
+    rest.remove_prefix(close + 1);
+  }
+}
+
+BackendResult<> reduce_ssml(std::string_view ssml, const VoiceParams &base,
+                            std::string &text,
+                            std::vector<SsmlSegment> &segments) {
+  text.clear();
+  segments.clear();
+  // Markup only ever shrinks, apart from the NUL after each segment.
+  text.reserve(ssml.size() + 1);
+  return Reducer{base, text, segments}.run(ssml);
+}
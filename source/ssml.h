@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One piece of an SSML document, viewing the document itself. `name` is the
+// element's local name, without any namespace prefix, and `body` is the
+// character data of text and CDATA, or the attributes of a tag.
+struct SsmlToken {
+  enum class Kind : std::uint8_t { Text, Cdata, Open, Close, Empty, End };
+  Kind kind;
+  std::string_view name;
+  std::string_view body;
+};
+
+// Walks an SSML document a token at a time without building a tree or
+// allocating. Comments, processing instructions and the DOCTYPE are skipped.
+// Nesting is not checked, so a reader that cares keeps its own depth.
+class SsmlTokenizer {
+  std::string_view rest;
+
+public:
+  explicit SsmlTokenizer(std::string_view ssml) noexcept : rest(ssml) {}
+  // InvalidParam for a tag, comment or CDATA section that never closes.
+  [[nodiscard]] BackendResult<SsmlToken> next() noexcept;
+};
+
+// The value of attribute `name` in a tag body, entities left undecoded.
+[[nodiscard]] std::optional<std::string_view>
+ssml_attribute(std::string_view attributes, std::string_view name) noexcept;
+
+// A run of text read with the same prosody. Values are normalized like the
+// backend's parameters; an empty one leaves the parameter as it was before
+// the document. `pause_ms` is silence to leave before the run.
+struct SsmlSegment {
+  std::size_t offset;
+  std::size_t length;
+  VoiceParams prosody;
+  std::uint32_t pause_ms;
+};
+
+// Reduces `ssml` to plain text in `text`, each segment followed by a NUL, and
+// the prosody and breaks that apply to each run in `segments`. Prosody is
+// worked out from `base`, the parameters in force before the document; a
+// parameter `base` leaves empty is never changed, since it could not be put
+// back afterwards. Both outputs are cleared first and keep their capacity.
+[[nodiscard]] BackendResult<> reduce_ssml(std::string_view ssml,
+                                          const VoiceParams &base,
+                                          std::string &text,
+                                          std::vector<SsmlSegment> &segments);
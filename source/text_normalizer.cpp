@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "text_normalizer.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+std::size_t find_text_special(std::string_view text, std::size_t from,
+                              bool markup);
+
+namespace {
+bool is_ascii_space(char c) noexcept {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool is_ascii_alnum(char c) noexcept {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z');
+}
+
+// Tags that separate words when rendered, so removing them leaves a space.
+bool is_break_tag(std::string_view name) noexcept {
+  static constexpr std::array<std::string_view, 20> names{
+      "blockquote", "br", "dd", "div", "dt", "h1", "h2",    "h3", "h4", "h5",
+      "h6",         "hr", "li", "ol",  "p",  "td", "table", "th", "tr", "ul"};
+  std::array<char, 10> folded{};
+  if (name.size() > folded.size())
+    return false;
+  std::ranges::transform(name, folded.begin(), [](char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  });
+  return std::ranges::find(names, std::string_view{folded.data(),
+                                                   name.size()}) != names.end();
+}
+
+// Returns the number of bytes written to `buffer`.
+std::size_t encode_utf8(char32_t cp, std::array<char, 4> &buffer) noexcept {
+  const auto byte = [](char32_t bits) { return static_cast<char>(bits); };
+  if (cp < 0x80) {
+    buffer[0] = byte(cp);
+    return 1;
+  }
+  if (cp < 0x800) {
+    buffer[0] = byte(0xC0 | (cp >> 6));
+    buffer[1] = byte(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    buffer[0] = byte(0xE0 | (cp >> 12));
+    buffer[1] = byte(0x80 | ((cp >> 6) & 0x3F));
+    buffer[2] = byte(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  buffer[0] = byte(0xF0 | (cp >> 18));
+  buffer[1] = byte(0x80 | ((cp >> 12) & 0x3F));
+  buffer[2] = byte(0x80 | ((cp >> 6) & 0x3F));
+  buffer[3] = byte(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+// &#N; and &#xN;, for any scalar value other than NUL.
+std::optional<char32_t> parse_reference(std::string_view name) noexcept {
+  if (!name.starts_with('#'))
+    return std::nullopt;
+  name.remove_prefix(1);
+  int base = 10;
+  if (name.starts_with('x') || name.starts_with('X')) {
+    name.remove_prefix(1);
+    base = 16;
+  }
+  std::uint32_t cp = 0;
+  const auto *last = name.data() + name.size();
+  const auto [ptr, ec] = std::from_chars(name.data(), last, cp, base);
+  if (name.empty() || ec != std::errc{} || ptr != last || cp == 0 ||
+      cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+    return std::nullopt;
+  return static_cast<char32_t>(cp);
+}
+
+// The output only ever holds what has already been read, rewritten shorter,
+// so it never outgrows the input.
+class Normalizer {
+  std::string_view text;
+  std::string &out;
+  std::size_t start;
+  bool collapse;
+  bool strip_control;
+  bool pending_space = false;
+
+  void emit(std::string_view s) {
+    if (collapse) {
+      // Runs never start the text, and a space already written absorbs a
+      // pending one as well as one leading `s`.
+      const bool at_space = out.size() == start || out.back() == ' ';
+      if (at_space && s.front() == ' ')
+        s.remove_prefix(1);
+      if (pending_space && !at_space && s.front() != ' ')
+        out.push_back(' ');
+      pending_space = false;
+    }
+    out.append(s);
+  }
+
+  void blank(std::string_view original) {
+    if (collapse)
+      pending_space = true;
+    else
+      emit(original);
+  }
+
+  [[nodiscard]] std::size_t whitespace(std::size_t at) {
+    if (!collapse) {
+      const auto width = text[at] == '\xC2' ? 2 : 1;
+      emit(text.substr(at, width));
+      return at + width;
+    }
+    while (at < text.size()) {
+      if (is_ascii_space(text[at]))
+        ++at;
+      else if (text.substr(at, 2) == "\xC2\xA0")
+        at += 2;
+      else
+        break;
+    }
+    pending_space = true;
+    return at;
+  }
+
+  [[nodiscard]] std::size_t control(std::size_t at, std::size_t width) {
+    if (!strip_control)
+      emit(text.substr(at, width));
+    return at + width;
+  }
+
+  // Only '<' followed by a letter, '/', '!' or '?' opens a tag, so "a < b"
+  // and "<3" survive. A tag that never closes is left as text.
+  [[nodiscard]] std::size_t tag(std::size_t at) {
+    const auto rest = text.substr(at + 1);
+    if (rest.empty() || !((is_ascii_alnum(rest.front()) &&
+                           !(rest.front() >= '0' && rest.front() <= '9')) ||
+                          rest.front() == '/' || rest.front() == '!' ||
+                          rest.front() == '?')) {
+      emit("<");
+      return at + 1;
+    }
+    if (rest.starts_with("!--")) {
+      const auto end = rest.find("-->", 3);
+      if (end == std::string_view::npos) {
+        emit("<");
+        return at + 1;
+      }
+      return at + 1 + end + 3;
+    }
+    const auto end = rest.find('>');
+    if (end == std::string_view::npos) {
+      emit("<");
+      return at + 1;
+    }
+    auto name = rest.substr(rest.front() == '/' ? 1 : 0);
+    name = name.substr(
+        0, std::ranges::find_if_not(name, is_ascii_alnum) - name.begin());
+    if (is_break_tag(name))
+      blank(" ");
+    return at + 1 + end + 1;
+  }
+
+  [[nodiscard]] std::size_t entity(std::size_t at) {
+    static constexpr std::array<std::pair<std::string_view, std::string_view>,
+                                5>
+        named{{{"amp", "&"},
+               {"lt", "<"},
+               {"gt", ">"},
+               {"quot", "\""},
+               {"apos", "'"}}};
+    // The longest reference handled, &#x10FFFF;, has eight characters inside.
+    const auto length = text.substr(at + 1, 9).find(';');
+    if (length == std::string_view::npos) {
+      emit("&");
+      return at + 1;
+    }
+    const auto name = text.substr(at + 1, length);
+    const auto next = at + 1 + length + 1;
+    if (const auto it = std::ranges::find(
+            named, name, [](const auto &entry) { return entry.first; });
+        it != named.end()) {
+      emit(it->second);
+      return next;
+    }
+    if (name == "nbsp") {
+      blank("\xC2\xA0");
+      return next;
+    }
+    const auto cp = parse_reference(name);
+    if (!cp) {
+      emit("&");
+      return at + 1;
+    }
+    if ((*cp < 0x80 && is_ascii_space(static_cast<char>(*cp))) ||
+        *cp == 0xA0) {
+      blank(" ");
+      return next;
+    }
+    if ((*cp < 0x20 || (*cp >= 0x7F && *cp < 0xA0)) && strip_control)
+      return next;
+    std::array<char, 4> buffer{};
+    emit({buffer.data(), encode_utf8(*cp, buffer)});
+    return next;
+  }
+
+public:
+  Normalizer(std::string_view text, std::uint32_t filters, std::string &out)
+      : text(text), out(out), start(out.size()),
+        collapse((filters & TextFilter::COLLAPSE_WHITESPACE) != 0),
+        strip_control((filters & TextFilter::STRIP_CONTROL) != 0) {}
+
+  void run(bool markup) {
+    std::size_t i = 0;
+    if (collapse)
+      while (i < text.size() && is_ascii_space(text[i]))
+        ++i;
+    while (i < text.size()) {
+      const auto at = find_text_special(text, i, markup);
+      if (at > i)
+        emit(text.substr(i, at - i));
+      if (at == text.size())
+        break;
+      const auto c = text[at];
+      if (c == '<')
+        i = tag(at);
+      else if (c == '&')
+        i = entity(at);
+      else if (is_ascii_space(c))
+        i = whitespace(at);
+      else if (c != '\xC2')
+        i = control(at, 1);
+      else if (text[at + 1] == '\xA0')
+        i = whitespace(at);
+      else if (static_cast<unsigned char>(text[at + 1]) < 0xA0)
+        i = control(at, 2);
+      else {
+        emit(text.substr(at, 2));
+        i = at + 2;
+      }
+    }
+    if (collapse && out.size() > start && out.back() == ' ')
+      out.pop_back();
+  }
+};
+} // namespace
+
+bool normalize_text(std::string_view text, std::uint32_t filters,
+                    std::string &out) {
+  const auto start = out.size();
+  out.reserve(start + text.size() + 1);
+  Normalizer{text, filters, out}.run((filters & TextFilter::STRIP_TAGS) != 0);
+  if ((filters & TextFilter::DROP_EMPTY) == 0)
+    return true;
+  // Anything outside ASCII may be a letter, an ideograph or an emoji, all of
+  // which an engine reads out; ASCII punctuation alone it does not.
+  return std::ranges::any_of(std::string_view{out}.substr(start), [](char c) {
+    return static_cast<unsigned char>(c) >= 0x80 || is_ascii_alnum(c);
+  });
+}
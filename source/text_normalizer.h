@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Same values as PrismTextFilter.
+namespace TextFilter {
+inline constexpr auto STRIP_TAGS = (1U << 0);
+inline constexpr auto COLLAPSE_WHITESPACE = (1U << 1);
+inline constexpr auto STRIP_CONTROL = (1U << 2);
+inline constexpr auto DROP_EMPTY = (1U << 3);
+inline constexpr auto KNOWN =
+    STRIP_TAGS | COLLAPSE_WHITESPACE | STRIP_CONTROL | DROP_EMPTY;
+} // namespace TextFilter
+
+// Appends valid UTF-8 `text` to `out` with `filters` applied. The result is
+// never longer than the input, so `out` grows at most once, and not at all
+// when the caller has reserved room. Returns false if DROP_EMPTY is set and
+// nothing speakable is left, meaning the text should not be spoken at all.
+[[nodiscard]] bool normalize_text(std::string_view text, std::uint32_t filters,
+                                  std::string &out);
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "text_segmenter.h"
+#include <algorithm>
+#include <simdutf.h>
+
+namespace {
+bool is_space(char c) noexcept { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+bool is_closer(char c) noexcept {
+  return c == '"' || c == '\'' || c == ')' || c == ']';
+}
+
+bool is_continuation(char c) noexcept {
+  return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+std::size_t sequence_width(char lead) noexcept {
+  const auto b = static_cast<unsigned char>(lead);
+  return b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : b >= 0xC0 ? 2 : 1;
+}
+
+void trim(std::string_view &text) noexcept {
+  while (!text.empty() && is_space(text.front()))
+    text.remove_prefix(1);
+  while (!text.empty() && is_space(text.back()))
+    text.remove_suffix(1);
+}
+
+// A fed sentence this long is cut at its latest clause boundary, and a unit
+// with no boundary at all at its latest space, or failing that wherever it
+// has got to, so text without punctuation is not held back indefinitely.
+constexpr std::size_t long_sentence = 160;
+constexpr std::size_t longest_unit = 480;
+
+// Where the text may be cut, each the offset just past the boundary.
+struct Cuts {
+  std::size_t first_sentence = 0;
+  std::size_t first_clause = 0;
+  std::size_t last_sentence = 0;
+  std::size_t last_clause = 0;
+  std::size_t last_space = 0;
+
+  void sentence(std::size_t at) noexcept {
+    if (first_sentence == 0)
+      first_sentence = at;
+    last_sentence = at;
+  }
+  void clause(std::size_t at) noexcept {
+    if (first_clause == 0)
+      first_clause = at;
+    last_clause = at;
+  }
+};
+
+// Scans the first `window` bytes of `text`, looking one byte further where a
+// boundary depends on what follows. Stops early at the first sentence if
+// `stop_at_sentence` is set.
+Cuts scan(std::string_view text, std::size_t window, bool stop_at_sentence) {
+  Cuts cuts;
+  const auto spaced = [text](std::size_t at) {
+    return at >= text.size() || is_space(text[at]);
+  };
+  for (std::size_t i = 0; i < window; ++i) {
+    const auto c = text[i];
+    std::size_t end = 0;
+    if (c == '\n') {
+      cuts.sentence(i + 1);
+    } else if (is_space(c)) {
+      cuts.last_space = i;
+    } else if (c == '.' || c == '!' || c == '?') {
+      end = i + 1;
+      while (end < text.size() && is_closer(text[end]))
+        ++end;
+      if (spaced(end) && end <= window)
+        cuts.sentence(end);
+    } else if (c == ',' || c == ';' || c == ':') {
+      if (spaced(i + 1))
+        cuts.clause(i + 1);
+    } else if (c == '\xE3' || c == '\xEF' || c == '\xE2') {
+      const auto tail = text.substr(i, 3);
+      if (i + 3 > window)
+        break;
+      // 。！？ end a sentence without a following space; … needs one.
+      if (tail == "\xE3\x80\x82" || tail == "\xEF\xBC\x81" ||
+          tail == "\xEF\xBC\x9F" || (tail == "\xE2\x80\xA6" && spaced(i + 3)))
+        cuts.sentence(i + 3);
+      else if (tail == "\xE3\x80\x81" || tail == "\xEF\xBC\x8C" ||
+               tail == "\xEF\xBC\x9B")
+        cuts.clause(i + 3);
+      i += 2;
+    }
+    if (stop_at_sentence && cuts.first_sentence != 0)
+      break;
+  }
+  return cuts;
+}
+} // namespace
+
+TextSegmenter::TextSegmenter(std::string_view text, std::size_t limit) noexcept
+    : rest(text), limit(std::max<std::size_t>(limit, 4)) {}
+
+std::string_view TextSegmenter::next() noexcept {
+  while (!rest.empty() && is_space(rest.front()))
+    rest.remove_prefix(1);
+  if (rest.empty())
+    return {};
+  const bool fits = rest.size() <= limit;
+  std::size_t cut = 0;
+  if (first) {
+    first = false;
+    const auto cuts = scan(rest, std::min(rest.size(), limit), true);
+    cut = cuts.first_sentence != 0 ? cuts.first_sentence : cuts.first_clause;
+    if (cut == 0 && !fits)
+      cut = std::max(cuts.last_clause, cuts.last_space);
+  } else if (!fits) {
+    const auto cuts = scan(rest, limit, false);
+    cut = cuts.last_sentence != 0 ? cuts.last_sentence
+          : cuts.last_clause != 0 ? cuts.last_clause
+                                  : cuts.last_space;
+  }
+  if (cut == 0 && fits) {
+    cut = rest.size();
+  } else if (cut == 0) {
+    // No boundary at all, so cut before the character straddling the limit.
+    cut = limit;
+    while (cut > 0 && is_continuation(rest[cut]))
+      --cut;
+  }
+  auto segment = rest.substr(0, cut);
+  rest.remove_prefix(cut);
+  while (!segment.empty() && is_space(segment.back()))
+    segment.remove_suffix(1);
+  return segment;
+}
+
+bool TextFeed::append(std::string_view text) {
+  if (taken != 0) {
+    buffer.erase(0, taken);
+    checked -= taken;
+    scanned -= taken;
+    clause -= clause != 0 ? taken : 0;
+    space -= space != 0 ? taken : 0;
+    taken = 0;
+  }
+  const auto kept = buffer.size();
+  buffer.append(text);
+  // Hold back a character whose last bytes have not arrived yet.
+  auto end = buffer.size();
+  auto lead = end;
+  while (lead > checked && end - lead < 3 && is_continuation(buffer[lead - 1]))
+    --lead;
+  if (lead > checked) {
+    // Bytes that cannot start a character are left for validation to reject.
+    const auto b = static_cast<unsigned char>(buffer[lead - 1]);
+    if (b >= 0xC2 && b <= 0xF4 &&
+        lead - 1 + sequence_width(buffer[lead - 1]) > end)
+      end = lead - 1;
+  }
+  if (!simdutf::validate_utf8(buffer.data() + checked, end - checked)) {
+    buffer.resize(kept);
+    return false;
+  }
+  checked = end;
+  return true;
+}
+
+std::string_view TextFeed::take(std::size_t end) noexcept {
+  auto unit = std::string_view{buffer}.substr(taken, end - taken);
+  taken = end;
+  clause = 0;
+  space = 0;
+  trim(unit);
+  if (!unit.empty())
+    first = false;
+  return unit;
+}
+
+std::string_view TextFeed::next() noexcept {
+  const std::string_view text{buffer.data(), checked};
+  // Returning early leaves `scanned` on a boundary that depends on text yet
+  // to arrive, so it is looked at again once it has.
+  while (scanned < checked) {
+    const auto i = scanned;
+    const auto c = text[i];
+    std::size_t width = 1;
+    std::size_t sentence = 0;
+    if (c == '\n') {
+      sentence = i + 1;
+    } else if (is_space(c)) {
+      space = i;
+    } else if (c == '.' || c == '!' || c == '?') {
+      auto end = i + 1;
+      while (end < checked && is_closer(text[end]))
+        ++end;
+      if (end == checked)
+        return {};
+      if (is_space(text[end]))
+        sentence = end;
+      width = end - i;
+    } else if (c == ',' || c == ';' || c == ':') {
+      if (i + 1 == checked)
+        return {};
+      if (is_space(text[i + 1]))
+        clause = i + 1;
+    } else if (!is_continuation(c)) {
+      width = sequence_width(c);
+      const auto tail = text.substr(i, width);
+      if (tail == "\xE3\x80\x82" || tail == "\xEF\xBC\x81" ||
+          tail == "\xEF\xBC\x9F") {
+        sentence = i + 3;
+      } else if (tail == "\xE2\x80\xA6") {
+        if (i + 3 == checked)
+          return {};
+        if (is_space(text[i + 3]))
+          sentence = i + 3;
+      } else if (tail == "\xE3\x80\x81" || tail == "\xEF\xBC\x8C" ||
+                 tail == "\xEF\xBC\x9B") {
+        clause = i + 3;
+      }
+    }
+    scanned = i + width;
+    std::size_t cut = 0;
+    if (sentence != 0)
+      cut = sentence;
+    else if (clause != 0 && (first || clause - taken >= long_sentence))
+      cut = clause;
+    else if (scanned - taken >= longest_unit)
+      cut = clause != 0 ? clause : space != 0 ? space : scanned;
+    if (cut == 0)
+      continue;
+    if (const auto unit = take(cut); !unit.empty())
+      return unit;
+  }
+  return {};
+}
+
+std::optional<std::string_view> TextFeed::finish() noexcept {
+  if (checked != buffer.size())
+    return std::nullopt;
+  scanned = checked;
+  return take(checked);
+}
+
+void TextFeed::clear() noexcept {
+  buffer.clear();
+  checked = 0;
+  scanned = 0;
+  taken = 0;
+  clause = 0;
+  space = 0;
+  first = true;
+}
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Splits UTF-8 text into segments of at most `limit` bytes for speaking one
+// after another. The first segment ends at the first sentence (or failing
+// that, clause) boundary so audio can start early; later ones pack as many
+// whole sentences as fit. A sentence longer than the limit is cut at its last
+// clause boundary or space, and only as a last resort inside a word, never
+// inside a character. Segments view the text and carry no surrounding
+// whitespace.
+class TextSegmenter {
+  std::string_view rest;
+  std::size_t limit;
+  bool first = true;
+
+public:
+  TextSegmenter(std::string_view text, std::size_t limit) noexcept;
+  // Empty once the text is used up.
+  [[nodiscard]] std::string_view next() noexcept;
+};
+
+// Splits UTF-8 text that arrives in pieces, such as tokens from a network
+// stream, into units that can be spoken as soon as they are complete. The
+// first unit ends at the first clause boundary so speech starts early; later
+// ones are whole sentences, cut at a clause once a sentence grows long, and at
+// a space if the text has no punctuation at all. Every byte is checked and
+// searched once, however the text is split, and a character split across two
+// pieces is held back until its last byte arrives.
+class TextFeed {
+  std::string buffer;
+  // Offsets into `buffer`: text before `checked` is valid UTF-8, text before
+  // `scanned` has been searched, and text before `taken` has been handed out.
+  std::size_t checked = 0;
+  std::size_t scanned = 0;
+  std::size_t taken = 0;
+  // Boundaries seen since `taken`, or 0.
+  std::size_t clause = 0;
+  std::size_t space = 0;
+  bool first = true;
+
+  [[nodiscard]] std::string_view take(std::size_t end) noexcept;
+
+public:
+  // False if `text` is not valid UTF-8, in which case none of it is kept.
+  [[nodiscard]] bool append(std::string_view text);
+  // The next complete unit, or empty until more text arrives. The view lasts
+  // until the next call to append() or clear().
+  [[nodiscard]] std::string_view next() noexcept;
+  // Whatever is left once no more text will arrive, or nullopt if the text
+  // stopped partway through a character.
+  [[nodiscard]] std::optional<std::string_view> finish() noexcept;
+  // Forgets everything, ready for new text.
+  void clear() noexcept;
+};
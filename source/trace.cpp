@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "trace.h"
+#include "logging.h"
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Per thread; about 10 MiB. Later events are counted and dropped.
+constexpr std::size_t max_thread_events = 256 * 1024;
+
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  BackendId backend;
+  std::chrono::steady_clock::time_point begin;
+  std::chrono::steady_clock::duration duration;
+};
+
+// The owning thread appends; the mutex only ever contends with a write.
+struct ThreadBuffer {
+  std::mutex mutex;
+  std::vector<TraceEvent> events;
+  std::uint64_t dropped = 0;
+  std::uint32_t tid = 0;
+};
+
+struct Tracer {
+  std::filesystem::path path;
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::unordered_map<std::uint64_t, std::string> names;
+  std::uint32_t next_tid = 1;
+  LogSource logger{"Trace"};
+};
+
+// Never destroyed, since threads may still trace during exit. Null if it
+// could not be allocated, in which case tracing never turns on.
+Tracer *tracer() noexcept {
+  static auto *instance = new (std::nothrow) Tracer;
+  return instance;
+}
+
+ThreadBuffer *local_buffer() noexcept {
+  thread_local std::shared_ptr<ThreadBuffer> local;
+  if (local)
+    return local.get();
+  try {
+    auto *instance = tracer();
+    if (instance == nullptr)
+      return nullptr;
+    auto &t = *instance;
+    auto buffer = std::make_shared<ThreadBuffer>();
+    std::scoped_lock lock(t.mutex);
+    buffer->tid = t.next_tid++;
+    t.buffers.push_back(buffer);
+    local = std::move(buffer);
+  } catch (...) {
+    return nullptr;
+  }
+  return local.get();
+}
+
+void append_escaped(std::string &out, std::string_view text) {
+  for (const char c : text) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        fmt::format_to(std::back_inserter(out), "\\u{:04x}",
+                       static_cast<unsigned>(c));
+      else
+        out += c;
+    }
+  }
+}
+
+double to_us(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+int process_id() noexcept {
+#ifdef _WIN32
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
+} // namespace
+
+void trace_event(const char *name, const char *category, BackendId backend,
+                 std::chrono::steady_clock::time_point begin,
+                 std::chrono::steady_clock::time_point end) noexcept {
+  auto *buffer = local_buffer();
+  if (buffer == nullptr)
+    return;
+  std::scoped_lock lock(buffer->mutex);
+  if (buffer->events.size() == max_thread_events) {
+    ++buffer->dropped;
+    return;
+  }
+  try {
+    buffer->events.push_back({.name = name,
+                              .category = category,
+                              .backend = backend,
+                              .begin = begin,
+                              .duration = end - begin});
+  } catch (const std::bad_alloc &) {
+    ++buffer->dropped;
+  }
+}
+
+void trace_backend_name(BackendId backend, std::string_view name) noexcept {
+  auto *instance = tracer();
+  if (instance == nullptr)
+    return;
+  auto &t = *instance;
+  try {
+    std::scoped_lock lock(t.mutex);
+    t.names.try_emplace(std::to_underlying(backend), name);
+  } catch (...) {
+    // The backend shows up by ID instead.
+  }
+}
+
+void write_trace() noexcept {
+  auto *instance = tracer();
+  if (!tracing() || instance == nullptr)
+    return;
+  auto &t = *instance;
+  try {
+    std::scoped_lock lock(t.mutex);
+    const auto pid = process_id();
+    std::string out = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    bool first = true;
+    const auto separate = [&out, &first] {
+      if (!first)
+        out += ",\n";
+      first = false;
+    };
+    for (const auto &buffer : t.buffers) {
+      std::scoped_lock buffer_lock(buffer->mutex);
+      separate();
+      fmt::format_to(std::back_inserter(out),
+                     R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},)"
+                     R"("args":{{"name":"prism {}"}}}})",
+                     pid, buffer->tid, buffer->tid);
+      for (const auto &e : buffer->events) {
+        separate();
+        fmt::format_to(std::back_inserter(out),
+                       R"({{"name":"{}","cat":"{}","ph":"X","ts":{:.3f},)"
+                       R"("dur":{:.3f},"pid":{},"tid":{})",
+                       e.name, e.category, to_us(e.begin.time_since_epoch()),
+                       to_us(e.duration), pid, buffer->tid);
+        if (const auto id = std::to_underlying(e.backend); id != 0) {
+          out += R"(,"args":{"backend":")";
+          if (const auto it = t.names.find(id); it != t.names.end())
+            append_escaped(out, it->second);
+          else
+            fmt::format_to(std::back_inserter(out), "{:016x}", id);
+          out += '"';
+          out += '}';
+        }
+        out += '}';
+      }
+      if (buffer->dropped != 0)
+        t.logger.warn("Dropped {} trace events on thread {}", buffer->dropped,
+                      buffer->tid);
+    }
+    out += "]}\n";
+    std::ofstream file(t.path, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!file)
+      t.logger.error("Failed to write the trace file");
+  } catch (...) {
+    t.logger.error("Failed to write the trace file");
+  }
+}
+
+void init_tracing_from_env() noexcept {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    auto *instance = tracer();
+    if (instance == nullptr)
+      return;
+    auto &t = *instance;
+#ifdef _WIN32
+    wchar_t *env_raw = nullptr;
+    size_t len = 0;
+    if (_wdupenv_s(&env_raw, &len, L"PRISM_TRACE") != 0)
+      return;
+    std::unique_ptr<wchar_t, decltype(&std::free)> env{env_raw, &std::free};
+    if (!env || *env == L'\0')
+      return;
+    const std::wstring_view value{env.get()};
+#else
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    const char *env = std::getenv("PRISM_TRACE");
+    if (env == nullptr || *env == '\0')
+      return;
+    const std::string_view value{env};
+#endif
+    try {
+      t.path = value;
+    } catch (...) {
+      return;
+    }
+    trace_active.store(true, std::memory_order_relaxed);
+    // Applications that never shut Prism down still get a trace.
+    std::atexit([] { write_trace(); });
+  });
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend_catalog.h"
+#include <atomic>
+#include <chrono>
+#include <string_view>
+
+// Set once PRISM_TRACE names a file; checked before anything is recorded, so
+// tracing costs one relaxed load while it is off.
+inline std::atomic_bool trace_active{false};
+
+[[nodiscard]] inline bool tracing() noexcept {
+  return trace_active.load(std::memory_order_relaxed);
+}
+
+// Names and categories MUST be string literals: only the pointers are kept.
+void trace_event(const char *name, const char *category, BackendId backend,
+                 std::chrono::steady_clock::time_point begin,
+                 std::chrono::steady_clock::time_point end) noexcept;
+void trace_backend_name(BackendId backend, std::string_view name) noexcept;
+// Rewrites the trace file with every event recorded so far.
+void write_trace() noexcept;
+void init_tracing_from_env() noexcept;
+
+class TraceScope {
+  using Clock = std::chrono::steady_clock;
+  const char *name;
+  const char *category;
+  BackendId backend;
+  Clock::time_point start;
+
+public:
+  TraceScope(const char *name, const char *category,
+             BackendId backend = {}) noexcept
+      : name(name), category(category), backend(backend),
+        start(tracing() ? Clock::now() : Clock::time_point{}) {}
+  ~TraceScope() {
+    if (tracing() && start != Clock::time_point{})
+      trace_event(name, category, backend, start, Clock::now());
+  }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+  TraceScope(TraceScope &&) = delete;
+  TraceScope &operator=(TraceScope &&) = delete;
+};
@@ -0,0 +1,405 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "utterance_worker.h"
+#include <algorithm>
+#include <new>
+#include <utility>
+#ifdef _WIN32
+#include <objbase.h>
+#endif
+
+namespace {
+constexpr std::uint8_t all_classes = (1U << speech_priority_count) - 1;
+} // namespace
+
+UtteranceWorker::UtteranceWorker(std::shared_ptr<TextToSpeechBackend> backend)
+    : backend(std::move(backend)),
+      native_priorities(this->backend->has_native_priorities()) {
+  logger.debug("Spawning worker thread for {}", this->backend->get_name());
+  thread = std::jthread([this](const std::stop_token &stop) { run(stop); });
+}
+
+UtteranceWorker::~UtteranceWorker() {
+  logger.debug("Requesting thread stop");
+  {
+    std::scoped_lock lock(queue_mutex);
+    task_stop.request_stop();
+  }
+  thread.request_stop();
+  if (thread.joinable())
+    thread.join();
+  // Every submitted utterance is reported exactly once, even the ones that
+  // never got a chance to run.
+  cancel_queued(all_classes);
+  while (!retired.empty()) {
+    auto entry = std::move(retired.front());
+    retired.pop_front();
+    finish(entry.job, entry.error);
+  }
+}
+
+void UtteranceWorker::run(const std::stop_token &stop) {
+#ifdef _WIN32
+  const bool com_ok = SUCCEEDED(
+      CoInitializeEx(nullptr, COINIT_MULTITHREADED | COINIT_SPEED_OVER_MEMORY));
+#endif
+  const auto has_work = [this] { return has_pending() || !retired.empty(); };
+  std::unique_lock lock(queue_mutex);
+  while (queue_cv.wait(lock, stop, has_work) && !stop.stop_requested()) {
+    if (!retired.empty()) {
+      auto entry = std::move(retired.front());
+      retired.pop_front();
+      in_flight = entry.job.id;
+      lock.unlock();
+      finish(entry.job, entry.error);
+      lock.lock();
+      in_flight = 0;
+      // Too late to cancel what was never going to run anyway.
+      cancel_in_flight = false;
+      continue;
+    }
+    auto &queue = *std::ranges::find_if(
+        pending, [](const auto &q) { return !q.empty(); });
+    const auto now = Clock::now();
+    if (queue.front().interrupt && coalesce_window != Clock::duration::zero() &&
+        now < last_interrupt + coalesce_window) {
+      // Hold the interrupt back until the window closes, giving later
+      // interrupts the chance to supersede it in submit().
+      queue_cv.wait_until(
+          lock, stop, last_interrupt + coalesce_window,
+          [this, window = coalesce_window] {
+            return !retired.empty() || coalesce_window != window;
+          });
+      continue;
+    }
+    auto job = std::move(queue.front());
+    queue.pop_front();
+    in_flight = job.id;
+    in_flight_priority = job.priority;
+    std::stop_token cancel;
+    if (job.kind == Kind::Task) {
+      task_stop = std::stop_source{};
+      cancel = task_stop.get_token();
+    }
+    if (job.kind == Kind::Stop) {
+      forget_last_text();
+    } else if (coalesce_window != Clock::duration::zero() &&
+               job.kind != Kind::Task) {
+      if (job.interrupt)
+        last_interrupt = now;
+      last_text = job.text;
+      last_text_at = now;
+      last_kind = job.kind;
+    }
+    lock.unlock();
+    auto r = dispatch(job, cancel);
+    lock.lock();
+    const bool cancelled = std::exchange(cancel_in_flight, false);
+    lock.unlock();
+    if (cancelled) {
+      // Speech already handed over keeps playing after dispatch returns. A
+      // task has seen its token and cleaned up after itself.
+      if (r && job.kind != Kind::Braille && job.kind != Kind::Stop &&
+          job.kind != Kind::Task) {
+        contend();
+        std::scoped_lock guard(backend_mutex);
+        (void)backend->stop();
+      }
+      r = std::unexpected(BackendError::Cancelled);
+    }
+    if (!r)
+      logger.debug("Utterance {} failed with error {}", job.id,
+                   std::to_underlying(r.error()));
+    finish(job, r ? BackendError::Ok : r.error());
+    lock.lock();
+    in_flight = 0;
+    in_flight_priority.reset();
+  }
+#ifdef _WIN32
+  if (com_ok)
+    CoUninitialize();
+#endif
+}
+
+void UtteranceWorker::contend() {
+  std::scoped_lock lock(hook_mutex);
+  for (const auto &[id, hook] : contention_hooks)
+    hook();
+}
+
+BackendResult<> UtteranceWorker::dispatch(const Job &job,
+                                          const std::stop_token &cancel) {
+  if (job.kind == Kind::Task) {
+    last_dispatched = job.priority;
+    return job.task(cancel);
+  }
+  contend();
+  std::scoped_lock guard(backend_mutex);
+  // Neither takes part in preemption between speech classes.
+  if (job.kind == Kind::Braille)
+    return backend->braille(job.text);
+  if (job.kind == Kind::Stop)
+    return backend->stop();
+  bool interrupt = job.interrupt;
+  if (last_dispatched) {
+    const auto active = *last_dispatched;
+    if (interrupt && active == SpeechPriority::Important &&
+        job.priority != SpeechPriority::Important) {
+      // An explicit interrupt from a lower class does not get to cut off
+      // important speech that is still playing.
+      const auto speaking = backend->is_speaking();
+      if (!speaking || *speaking)
+        interrupt = false;
+    }
+    if (!interrupt && !native_priorities &&
+        (preemption_rules[std::to_underlying(job.priority)].interrupts &
+         priority_bit(active)) != 0)
+      interrupt = true;
+  }
+  last_dispatched = job.priority;
+  if (job.kind == Kind::Output)
+    return backend->output(job.text, interrupt);
+  if (job.kind == Kind::Ssml)
+    return backend->speak_ssml(job.text, interrupt);
+  return backend->speak_with_priority(job.text, job.priority, interrupt);
+}
+
+void UtteranceWorker::finish(Job &job, BackendError error) {
+  if (job.done)
+    job.done(job.id, error);
+  record(job.id, error);
+}
+
+void UtteranceWorker::record(UtteranceId id, BackendError error) {
+  {
+    std::scoped_lock lock(queue_mutex);
+    results[id % retained_results] = Result{.id = id, .error = error};
+  }
+  results_cv.notify_all();
+}
+
+std::size_t UtteranceWorker::cancel_queued(std::uint8_t classes) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < speech_priority_count; ++i) {
+    if ((classes & (1U << i)) == 0)
+      continue;
+    count += pending[i].size();
+    for (auto &job : pending[i])
+      retired.push_back(
+          Retired{.job = std::move(job), .error = BackendError::Cancelled});
+    pending[i].clear();
+  }
+  return count;
+}
+
+bool UtteranceWorker::repeats(const Job &job, Clock::time_point now) const {
+  const auto &queue = pending[std::to_underlying(job.priority)];
+  if (!queue.empty()) {
+    const auto &last = queue.back();
+    return last.kind == job.kind && last.text == job.text &&
+           (last.interrupt || !job.interrupt);
+  }
+  return !has_pending() && now - last_text_at < coalesce_window &&
+         last_kind == job.kind && last_text == job.text;
+}
+
+void UtteranceWorker::forget_last_text() noexcept {
+  last_text.clear();
+  last_text_at = {};
+}
+
+bool UtteranceWorker::has_pending() const noexcept {
+  return std::ranges::any_of(pending,
+                             [](const auto &q) { return !q.empty(); });
+}
+
+bool UtteranceWorker::occupied_by(std::uint8_t classes) const noexcept {
+  if (in_flight_priority && (classes & priority_bit(*in_flight_priority)) != 0)
+    return true;
+  for (std::size_t i = 0; i < speech_priority_count; ++i)
+    if ((classes & (1U << i)) != 0 && !pending[i].empty())
+      return true;
+  return false;
+}
+
+bool UtteranceWorker::outstanding(UtteranceId id) const {
+  const auto matches = [id](const Job &job) { return job.id == id; };
+  return in_flight == id ||
+         std::ranges::any_of(retired, matches, &Retired::job) ||
+         std::ranges::any_of(pending, [&](const auto &q) {
+           return std::ranges::any_of(q, matches);
+         });
+}
+
+BackendResult<UtteranceId> UtteranceWorker::submit(std::string_view text,
+                                                   bool interrupt, Kind kind,
+                                                   Completion done,
+                                                   SpeechPriority priority) {
+  try {
+    return enqueue(Job{.id = 0,
+                       .kind = kind,
+                       .priority = priority,
+                       .interrupt = interrupt,
+                       .text = std::string{text},
+                       .done = std::move(done),
+                       .task = {}});
+  } catch (const std::bad_alloc &) {
+    return std::unexpected(BackendError::MemoryFailure);
+  }
+}
+
+BackendResult<UtteranceId>
+UtteranceWorker::submit_task(Task task, bool interrupt, Completion done,
+                             SpeechPriority priority) {
+  return enqueue(Job{.id = 0,
+                     .kind = Kind::Task,
+                     .priority = priority,
+                     .interrupt = interrupt,
+                     .text = {},
+                     .done = std::move(done),
+                     .task = std::move(task)});
+}
+
+BackendResult<UtteranceId> UtteranceWorker::enqueue(Job job) try {
+  UtteranceId id = 0;
+  {
+    std::scoped_lock lock(queue_mutex);
+    id = next_id++;
+    job.id = id;
+    const auto kind = job.kind;
+    const auto &rule = preemption_rules[std::to_underlying(job.priority)];
+    const bool coalesce = coalesce_window != Clock::duration::zero();
+    if (occupied_by(rule.yields_to)) {
+      retired.push_back(
+          Retired{.job = std::move(job), .error = BackendError::Cancelled});
+    } else if (coalesce && kind != Kind::Stop && kind != Kind::Task &&
+               repeats(job, Clock::now())) {
+      // The same text is already queued or was just spoken; report this
+      // one as done rather than saying it twice.
+      ++stats.deduplicated;
+      retired.push_back(
+          Retired{.job = std::move(job), .error = BackendError::Ok});
+    } else {
+      auto drops = rule.drops;
+      if (job.interrupt) {
+        drops |= all_classes & ~priority_bit(SpeechPriority::Important);
+        task_stop.request_stop();
+      }
+      const auto dropped = cancel_queued(drops);
+      if (coalesce)
+        stats.dropped += dropped;
+      pending[std::to_underlying(job.priority)].push_back(std::move(job));
+    }
+  }
+  queue_cv.notify_one();
+  return id;
+} catch (const std::bad_alloc &) {
+  return std::unexpected(BackendError::MemoryFailure);
+}
+
+BackendResult<> UtteranceWorker::wait(UtteranceId id) {
+  if (on_worker_thread())
+    return std::unexpected(BackendError::InvalidOperation);
+  std::unique_lock lock(queue_mutex);
+  if (id == 0 || id >= next_id)
+    return std::unexpected(BackendError::InvalidParam);
+  while (true) {
+    const auto &slot = results[id % retained_results];
+    if (slot.id == id) {
+      if (slot.error != BackendError::Ok)
+        return std::unexpected(slot.error);
+      return {};
+    }
+    if (!outstanding(id))
+      return std::unexpected(BackendError::RangeOutOfBounds);
+    results_cv.wait(lock);
+  }
+}
+
+void UtteranceWorker::cancel_pending() {
+  {
+    std::scoped_lock lock(queue_mutex);
+    // Whatever was just spoken is being cut off, so saying it again is no
+    // longer a repeat, and a task in flight gives up too.
+    forget_last_text();
+    task_stop.request_stop();
+    if (!has_pending())
+      return;
+    cancel_queued(all_classes);
+  }
+  queue_cv.notify_one();
+}
+
+void UtteranceWorker::cancel(UtteranceId id) {
+  if (id == 0)
+    return;
+  {
+    std::scoped_lock lock(queue_mutex);
+    if (in_flight == id) {
+      cancel_in_flight = true;
+      task_stop.request_stop();
+      return;
+    }
+    const auto matches = [id](const Job &job) { return job.id == id; };
+    for (auto &queue : pending) {
+      const auto it = std::ranges::find_if(queue, matches);
+      if (it == queue.end())
+        continue;
+      retired.push_back(
+          Retired{.job = std::move(*it), .error = BackendError::Cancelled});
+      queue.erase(it);
+      break;
+    }
+  }
+  queue_cv.notify_one();
+}
+
+void UtteranceWorker::set_coalescing(std::chrono::milliseconds window) {
+  {
+    std::scoped_lock lock(queue_mutex);
+    coalesce_window = window;
+  }
+  queue_cv.notify_one();
+}
+
+UtteranceWorker::HookId
+UtteranceWorker::add_contention_hook(std::function<void()> hook) {
+  std::scoped_lock lock(hook_mutex);
+  const auto id = next_hook++;
+  contention_hooks.emplace_back(id, std::move(hook));
+  return id;
+}
+
+void UtteranceWorker::remove_contention_hook(HookId id) {
+  std::scoped_lock lock(hook_mutex);
+  std::erase_if(contention_hooks,
+                [id](const auto &entry) { return entry.first == id; });
+}
+
+bool UtteranceWorker::coalescing() {
+  std::scoped_lock lock(queue_mutex);
+  return coalesce_window != Clock::duration::zero();
+}
+
+UtteranceWorker::CoalescingStats UtteranceWorker::coalescing_stats() {
+  std::scoped_lock lock(queue_mutex);
+  return stats;
+}
+
+bool UtteranceWorker::busy() {
+  std::scoped_lock lock(queue_mutex);
+  return in_flight != 0 || has_pending();
+}
+
+bool UtteranceWorker::on_worker_thread() const noexcept {
+  return std::this_thread::get_id() == thread.get_id();
+}
+
+std::unique_lock<std::mutex> UtteranceWorker::lock_backend() {
+  contend();
+  return std::unique_lock(backend_mutex);
+}
+
+std::unique_lock<std::mutex> UtteranceWorker::try_lock_backend() {
+  return std::unique_lock(backend_mutex, std::try_to_lock);
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include "logging.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using UtteranceId = std::uint64_t;
+
+inline constexpr std::size_t speech_priority_count = 5;
+
+constexpr std::uint8_t priority_bit(SpeechPriority priority) noexcept {
+  return static_cast<std::uint8_t>(1U << std::to_underlying(priority));
+}
+
+// What happens to everything else when an utterance of a given class shows
+// up, after SSIP's message priorities. `drops` names queued classes that are
+// cancelled on arrival, `interrupts` names the classes it cuts off when it is
+// dispatched right after them, and `yields_to` names the classes whose
+// presence in the queue or on the wire makes the new utterance pointless.
+struct PreemptionRule {
+  std::uint8_t drops;
+  std::uint8_t interrupts;
+  std::uint8_t yields_to;
+};
+
+inline constexpr auto preemption_rules = [] {
+  using enum SpeechPriority;
+  constexpr std::uint8_t important = priority_bit(Important);
+  constexpr std::uint8_t message = priority_bit(Message);
+  constexpr std::uint8_t text = priority_bit(Text);
+  constexpr std::uint8_t notification = priority_bit(Notification);
+  constexpr std::uint8_t progress = priority_bit(Progress);
+  constexpr std::uint8_t chatter = notification | progress;
+  constexpr std::uint8_t speech = important | message | text;
+  constexpr std::uint8_t below_important = message | text | chatter;
+  // Indexed by SpeechPriority.
+  return std::to_array<PreemptionRule>({
+      {.drops = chatter, .interrupts = below_important, .yields_to = 0},
+      {.drops = text | chatter, .interrupts = text | chatter, .yields_to = 0},
+      {.drops = chatter, .interrupts = chatter, .yields_to = 0},
+      {.drops = notification, .interrupts = 0, .yields_to = speech},
+      {.drops = progress, .interrupts = 0, .yields_to = speech},
+  });
+}();
+
+constexpr bool spares_important(const PreemptionRule &rule) noexcept {
+  return ((rule.drops | rule.interrupts) &
+          priority_bit(SpeechPriority::Important)) == 0;
+}
+
+static_assert(preemption_rules.size() == speech_priority_count);
+static_assert(std::ranges::all_of(preemption_rules, spares_important),
+              "important utterances are never dropped or interrupted");
+
+class UtteranceWorker {
+public:
+  enum class Kind : std::uint8_t { Speak, Output, Ssml, Braille, Stop, Task };
+  using Completion = std::function<void(UtteranceId, BackendError)>;
+  // Work that drives the backend itself, locking it through lock_backend()
+  // for each call. The token is stopped when the task is cancelled, when
+  // pending speech is, and when an interrupting utterance arrives.
+  using Task = std::function<BackendResult<>(const std::stop_token &)>;
+  using HookId = std::uint64_t;
+  struct CoalescingStats {
+    std::uint64_t dropped;
+    std::uint64_t deduplicated;
+  };
+
+private:
+  struct Job {
+    UtteranceId id;
+    Kind kind;
+    SpeechPriority priority;
+    bool interrupt;
+    std::string text;
+    Completion done;
+    Task task;
+  };
+  // A job that will never reach the backend but still owes its caller a
+  // completion.
+  struct Retired {
+    Job job;
+    BackendError error;
+  };
+  struct Result {
+    UtteranceId id;
+    BackendError error;
+  };
+  static constexpr std::size_t retained_results = 256;
+  using Clock = std::chrono::steady_clock;
+
+  std::shared_ptr<TextToSpeechBackend> backend;
+  bool native_priorities;
+  std::mutex backend_mutex;
+  // Called before anything but try_lock_backend() waits for backend_mutex,
+  // so lower-priority work holding it can let go.
+  std::mutex hook_mutex;
+  std::vector<std::pair<HookId, std::function<void()>>> contention_hooks;
+  HookId next_hook = 1;
+  std::mutex queue_mutex;
+  std::condition_variable_any queue_cv;
+  std::condition_variable_any results_cv;
+  std::array<std::deque<Job>, speech_priority_count> pending;
+  std::deque<Retired> retired;
+  UtteranceId next_id = 1;
+  UtteranceId in_flight = 0;
+  // Set by cancel() while the job in flight is still inside the backend.
+  bool cancel_in_flight = false;
+  // Stops the task in flight, if any; replaced for every task.
+  std::stop_source task_stop;
+  std::optional<SpeechPriority> in_flight_priority;
+  std::optional<SpeechPriority> last_dispatched;
+  std::array<Result, retained_results> results{};
+  Clock::duration coalesce_window{};
+  Clock::time_point last_interrupt;
+  // The last utterance recorded for deduplication, cleared whenever queued
+  // or playing speech is cancelled.
+  Clock::time_point last_text_at;
+  std::string last_text;
+  Kind last_kind = Kind::Speak;
+  CoalescingStats stats{};
+  std::jthread thread;
+  LogSource logger{"Utterance Worker"};
+
+  void run(const std::stop_token &stop);
+  void contend();
+  BackendResult<> dispatch(const Job &job, const std::stop_token &cancel);
+  BackendResult<UtteranceId> enqueue(Job job);
+  void finish(Job &job, BackendError error);
+  void record(UtteranceId id, BackendError error);
+  std::size_t cancel_queued(std::uint8_t classes);
+  void forget_last_text() noexcept;
+  [[nodiscard]] bool repeats(const Job &job, Clock::time_point now) const;
+  [[nodiscard]] bool has_pending() const noexcept;
+  [[nodiscard]] bool occupied_by(std::uint8_t classes) const noexcept;
+  [[nodiscard]] bool outstanding(UtteranceId id) const;
+
+public:
+  explicit UtteranceWorker(std::shared_ptr<TextToSpeechBackend> backend);
+  ~UtteranceWorker();
+  UtteranceWorker(const UtteranceWorker &) = delete;
+  UtteranceWorker &operator=(const UtteranceWorker &) = delete;
+  UtteranceWorker(UtteranceWorker &&) = delete;
+  UtteranceWorker &operator=(UtteranceWorker &&) = delete;
+  BackendResult<UtteranceId> submit(std::string_view text, bool interrupt,
+                                    Kind kind, Completion done,
+                                    SpeechPriority priority =
+                                        SpeechPriority::Message);
+  // Queues `task` like an utterance of the given class. It is never treated
+  // as a repeat of anything.
+  BackendResult<UtteranceId> submit_task(Task task, bool interrupt,
+                                         Completion done,
+                                         SpeechPriority priority =
+                                             SpeechPriority::Message);
+  BackendResult<> wait(UtteranceId id);
+  void cancel_pending();
+  // Cancels one utterance. A queued one is dropped; one already handed to the
+  // backend is stopped as soon as the backend returns from it. Either way it
+  // completes with Cancelled. Does nothing once the utterance has completed.
+  void cancel(UtteranceId id);
+  void set_coalescing(std::chrono::milliseconds window);
+  // Adds a hook run before every blocking wait for the backend. Hooks must
+  // not lock the backend themselves. Once remove_contention_hook() returns,
+  // the hook is not running and will not run again.
+  [[nodiscard]] HookId add_contention_hook(std::function<void()> hook);
+  void remove_contention_hook(HookId id);
+  [[nodiscard]] bool coalescing();
+  [[nodiscard]] CoalescingStats coalescing_stats();
+  [[nodiscard]] bool busy();
+  [[nodiscard]] bool on_worker_thread() const noexcept;
+  [[nodiscard]] std::unique_lock<std::mutex> lock_backend();
+  [[nodiscard]] std::unique_lock<std::mutex> try_lock_backend();
+};
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "voice_index.h"
+#include <algorithm>
+
+namespace {
+char fold(char c) noexcept {
+  if (c >= 'A' && c <= 'Z')
+    return static_cast<char>(c - 'A' + 'a');
+  // Engines disagree on en_US versus en-US.
+  return c == '_' ? '-' : c;
+}
+
+void fold_into(std::string &out, std::string_view text) {
+  out.resize(text.size());
+  std::ranges::transform(text, out.begin(), fold);
+}
+
+// Bytes compare as unsigned, the way the trie's sorted subtags do.
+unsigned char byte(char c) noexcept { return static_cast<unsigned char>(c); }
+unsigned char folded_byte(char c) noexcept { return byte(fold(c)); }
+
+// Calls `visit` with each subtag of a tag, folded or not.
+template <typename Visit> void split_tag(std::string_view tag, Visit visit) {
+  while (!tag.empty()) {
+    const auto end = std::min(tag.find_first_of("-_"), tag.size());
+    if (end != 0 && !visit(tag.substr(0, end)))
+      return;
+    tag.remove_prefix(std::min(end + 1, tag.size()));
+  }
+}
+} // namespace
+
+VoiceIndex::VoiceIndex(const VoiceList &voices) {
+  by_id.reserve(voices.size());
+  by_name.reserve(voices.size());
+  std::string folded;
+  for (std::size_t i = 0; i < voices.size(); ++i) {
+    by_id.try_emplace(VoiceList::stable_id(voices.name(i), voices.language(i)),
+                      i);
+    fold_into(folded, voices.name(i));
+    by_name.try_emplace(folded, i);
+    fold_into(folded, voices.language(i));
+    insert_language(folded, i);
+  }
+}
+
+std::optional<std::uint32_t>
+VoiceIndex::child(std::uint32_t node, std::string_view subtag) const noexcept {
+  const auto &children = nodes[node].children;
+  const auto it = std::ranges::lower_bound(
+      children, subtag, {},
+      [](const auto &edge) { return std::string_view{edge.first}; });
+  if (it == children.end() || it->first != subtag)
+    return std::nullopt;
+  return it->second;
+}
+
+// As child(), but folds `subtag` as it compares, so lookups need no copy.
+std::optional<std::uint32_t>
+VoiceIndex::child_folding(std::uint32_t node,
+                          std::string_view subtag) const noexcept {
+  const auto &children = nodes[node].children;
+  // The comparison is asymmetric, which std::ranges::lower_bound rejects.
+  const auto it = std::lower_bound(
+      children.begin(), children.end(), subtag,
+      [](const auto &edge, std::string_view query) {
+        return std::ranges::lexicographical_compare(edge.first, query, {},
+                                                    byte, folded_byte);
+      });
+  if (it == children.end() ||
+      !std::ranges::equal(it->first, subtag, {}, byte, folded_byte))
+    return std::nullopt;
+  return it->second;
+}
+
+void VoiceIndex::insert_language(std::string_view tag, std::size_t voice) {
+  std::uint32_t node = 0;
+  split_tag(tag, [&](std::string_view subtag) {
+    auto next = child(node, subtag);
+    if (!next) {
+      next = static_cast<std::uint32_t>(nodes.size());
+      auto &children = nodes[node].children;
+      const auto at = std::ranges::lower_bound(
+          children, subtag, {},
+          [](const auto &edge) { return std::string_view{edge.first}; });
+      children.emplace(at, std::string{subtag}, *next);
+      nodes.emplace_back();
+    }
+    node = *next;
+    nodes[node].any = std::min(nodes[node].any, voice);
+    return true;
+  });
+  if (node != 0)
+    nodes[node].exact = std::min(nodes[node].exact, voice);
+}
+
+std::optional<std::size_t> VoiceIndex::find_id(std::uint64_t id) const {
+  if (const auto it = by_id.find(id); it != by_id.end())
+    return it->second;
+  return std::nullopt;
+}
+
+std::optional<std::size_t> VoiceIndex::find_name(std::string_view name) {
+  fold_into(scratch, name);
+  if (const auto it = by_name.find(std::string_view{scratch});
+      it != by_name.end())
+    return it->second;
+  return std::nullopt;
+}
+
+std::optional<std::size_t>
+VoiceIndex::find_language(std::string_view tag) const {
+  // The deepest node along the query, and the voice of the deepest node on
+  // the way that has a voice for its own tag.
+  std::optional<std::uint32_t> deepest;
+  std::size_t nearest = none;
+  bool complete = true;
+  split_tag(tag, [&](std::string_view subtag) {
+    const auto next = child_folding(deepest.value_or(0), subtag);
+    if (!next) {
+      complete = false;
+      return false;
+    }
+    deepest = *next;
+    if (nodes[*next].exact != none)
+      nearest = nodes[*next].exact;
+    return true;
+  });
+  if (!deepest)
+    return std::nullopt;
+  const auto &node = nodes[*deepest];
+  // A voice for the exact tag, else a more specific one: en finds en-US.
+  if (complete)
+    return node.exact != none ? node.exact : node.any;
+  // Otherwise truncate the tag one subtag at a time, as in RFC 4647 lookup,
+  // settling for a sibling only once no ancestor has a voice of its own.
+  return nearest != none ? nearest : node.any;
+}
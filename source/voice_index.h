@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include "backend.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Lookup tables over a backend's voices, built from one VoiceList. Names are
+// matched with ASCII letters folded to lower case. Languages go into a trie
+// of BCP 47 subtags, so a tag that no voice carries falls back to the
+// nearest one that does: en-GB finds an en voice, then any other English
+// voice. Where several voices match equally, the lowest index wins.
+class VoiceIndex {
+  static constexpr auto none = static_cast<std::size_t>(-1);
+  struct Node {
+    // Voices whose tag ends at this node, and anywhere below it.
+    std::size_t exact = none;
+    std::size_t any = none;
+    // Sorted by subtag.
+    std::vector<std::pair<std::string, std::uint32_t>> children;
+  };
+  struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  std::unordered_map<std::uint64_t, std::size_t> by_id;
+  std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>>
+      by_name;
+  std::vector<Node> nodes{1};
+  std::string scratch;
+
+  [[nodiscard]] std::optional<std::uint32_t>
+  child(std::uint32_t node, std::string_view subtag) const noexcept;
+  [[nodiscard]] std::optional<std::uint32_t>
+  child_folding(std::uint32_t node, std::string_view subtag) const noexcept;
+  void insert_language(std::string_view tag, std::size_t voice);
+
+public:
+  explicit VoiceIndex(const VoiceList &voices);
+  [[nodiscard]] std::optional<std::size_t> find_id(std::uint64_t id) const;
+  [[nodiscard]] std::optional<std::size_t> find_name(std::string_view name);
+  [[nodiscard]] std::optional<std::size_t>
+  find_language(std::string_view tag) const;
+};
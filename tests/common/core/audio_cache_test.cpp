@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+
+namespace {
+// Each entry holds 4800 samples, so two fit and a third does not.
+constexpr std::size_t two_entries = 50000;
+
+void PRISM_CALL count_samples(void *userdata, const float *, size_t count,
+                              size_t, size_t) {
+  *static_cast<std::size_t *>(userdata) += count;
+}
+
+class AudioCacheTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+
+  void start(std::size_t budget) {
+    engine = &fakes.add("Fake Cache", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start(budget));
+  }
+
+  static std::size_t render(PrismBackend *backend, const char *text) {
+    std::size_t samples = 0;
+    EXPECT_EQ(prism_backend_speak_to_memory(backend, text, count_samples,
+                                            &samples),
+              PRISM_OK);
+    return samples;
+  }
+
+  PrismAudioCacheStats stats() {
+    PrismAudioCacheStats out{};
+    EXPECT_EQ(prism_audio_cache_get_stats(fakes.context(), &out), PRISM_OK);
+    return out;
+  }
+};
+
+TEST_F(AudioCacheTest, RepeatedTextIsServedFromCache) {
+  start(two_entries);
+  auto *backend = fakes.create("Fake Cache");
+  ASSERT_NE(backend, nullptr);
+  EXPECT_EQ(render(backend, "hello"), 4800U);
+  EXPECT_GT(render(backend, "hello"), 0U);
+  EXPECT_EQ(engine->rendered("hello"), 1U);
+  const auto counters = stats();
+  EXPECT_EQ(counters.hits, 1U);
+  EXPECT_EQ(counters.misses, 1U);
+  EXPECT_EQ(counters.entries, 1U);
+}
+
+TEST_F(AudioCacheTest, SettingsArePartOfTheKey) {
+  start(two_entries);
+  auto *backend = fakes.create("Fake Cache");
+  ASSERT_NE(backend, nullptr);
+  (void)render(backend, "hello");
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.8F), PRISM_OK);
+  (void)render(backend, "hello");
+  EXPECT_EQ(engine->rendered("hello"), 2U);
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.5F), PRISM_OK);
+  (void)render(backend, "hello");
+  EXPECT_EQ(engine->rendered("hello"), 2U);
+}
+
+TEST_F(AudioCacheTest, ChangeThroughAnotherHandleIsSeen) {
+  start(two_entries);
+  auto *first = fakes.acquire("Fake Cache");
+  auto *second = fakes.acquire("Fake Cache");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  (void)render(first, "hello");
+  float rate = 0.0F;
+  ASSERT_EQ(prism_backend_get_rate(first, &rate), PRISM_OK);
+  ASSERT_EQ(prism_backend_set_rate(second, 0.9F), PRISM_OK);
+  ASSERT_EQ(prism_backend_get_rate(first, &rate), PRISM_OK);
+  EXPECT_FLOAT_EQ(rate, 0.9F);
+  (void)render(first, "hello");
+  EXPECT_EQ(engine->rendered("hello"), 2U);
+}
+
+TEST_F(AudioCacheTest, LeastRecentlyUsedIsEvicted) {
+  start(two_entries);
+  auto *backend = fakes.create("Fake Cache");
+  ASSERT_NE(backend, nullptr);
+  (void)render(backend, "a");
+  (void)render(backend, "b");
+  (void)render(backend, "a");
+  (void)render(backend, "c");
+  auto counters = stats();
+  EXPECT_EQ(counters.evictions, 1U);
+  EXPECT_EQ(counters.entries, 2U);
+  EXPECT_LE(counters.bytes, two_entries);
+  (void)render(backend, "a");
+  EXPECT_EQ(engine->rendered("a"), 1U);
+  (void)render(backend, "b");
+  EXPECT_EQ(engine->rendered("b"), 2U);
+}
+
+TEST_F(AudioCacheTest, ClearDropsEveryEntry) {
+  start(two_entries);
+  auto *backend = fakes.create("Fake Cache");
+  ASSERT_NE(backend, nullptr);
+  (void)render(backend, "hello");
+  prism_audio_cache_clear(fakes.context());
+  const auto counters = stats();
+  EXPECT_EQ(counters.entries, 0U);
+  EXPECT_EQ(counters.bytes, 0U);
+  (void)render(backend, "hello");
+  EXPECT_EQ(engine->rendered("hello"), 2U);
+}
+} // namespace
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace {
+struct Delivered {
+  std::vector<std::uint8_t> bytes;
+  std::size_t frames = 0;
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+  PrismSampleFormat format = PRISM_SAMPLE_FORMAT_COUNT;
+
+  template <typename T> [[nodiscard]] std::vector<T> samples() const {
+    std::vector<T> out(bytes.size() / sizeof(T));
+    std::memcpy(out.data(), bytes.data(), out.size() * sizeof(T));
+    return out;
+  }
+};
+
+std::size_t bytes_per_sample(PrismSampleFormat format) {
+  switch (format) {
+  case PRISM_SAMPLE_FORMAT_S16:
+    return 2;
+  case PRISM_SAMPLE_FORMAT_S24:
+    return 3;
+  default:
+    return 4;
+  }
+}
+
+void PRISM_CALL collect(void *userdata, const void *data, size_t frames,
+                        size_t channels, size_t sample_rate,
+                        PrismSampleFormat format) {
+  auto &out = *static_cast<Delivered *>(userdata);
+  const auto *bytes = static_cast<const std::uint8_t *>(data);
+  out.bytes.insert(out.bytes.end(), bytes,
+                   bytes + (frames * channels * bytes_per_sample(format)));
+  out.frames += frames;
+  out.channels = channels;
+  out.sample_rate = sample_rate;
+  out.format = format;
+}
+
+// RMS after the filter has settled.
+double settled_rms(std::span<const float> samples) {
+  const auto settled = samples.subspan(samples.size() / 4);
+  double sum = 0.0;
+  for (const float s : settled)
+    sum += static_cast<double>(s) * s;
+  return std::sqrt(sum / static_cast<double>(settled.size()));
+}
+
+class AudioFormatTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Audio", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Audio");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  Delivered render(PrismSampleFormat format, std::uint32_t channels,
+                   std::uint32_t sample_rate) {
+    PrismMemoryOptions options{};
+    options.size = sizeof(options);
+    options.sample_format = format;
+    options.channels = channels;
+    options.sample_rate = sample_rate;
+    Delivered out;
+    EXPECT_EQ(prism_backend_speak_to_memory_pcm(backend, "tone", 4, collect,
+                                                &out, PRISM_TEXT_DEFAULT,
+                                                &options),
+              PRISM_OK);
+    return out;
+  }
+
+  [[nodiscard]] float source(std::size_t frame) const {
+    return engine->amplitude *
+           static_cast<float>(std::sin(
+               2.0 * std::numbers::pi * engine->tone_hz *
+               static_cast<double>(frame) /
+               static_cast<double>(engine->sample_rate)));
+  }
+};
+
+TEST_F(AudioFormatTest, S16IsScaledAndRounded) {
+  const auto out = render(PRISM_SAMPLE_FORMAT_S16, 0, 0);
+  EXPECT_EQ(out.format, PRISM_SAMPLE_FORMAT_S16);
+  EXPECT_EQ(out.sample_rate, engine->sample_rate);
+  ASSERT_EQ(out.frames, engine->frames);
+  const auto samples = out.samples<std::int16_t>();
+  for (std::size_t i = 0; i < samples.size(); ++i)
+    ASSERT_NEAR(samples[i], std::lround(source(i) * 32767.0F), 1) << i;
+}
+
+TEST_F(AudioFormatTest, S24IsPackedLittleEndian) {
+  const auto out = render(PRISM_SAMPLE_FORMAT_S24, 0, 0);
+  ASSERT_EQ(out.frames, engine->frames);
+  ASSERT_EQ(out.bytes.size(), engine->frames * 3);
+  for (std::size_t i = 0; i < out.frames; ++i) {
+    auto value = static_cast<std::int32_t>(out.bytes[i * 3] |
+                                           (out.bytes[(i * 3) + 1] << 8) |
+                                           (out.bytes[(i * 3) + 2] << 16));
+    if ((value & 0x800000) != 0)
+      value -= 0x1000000;
+    ASSERT_NEAR(value, std::lround(source(i) * 8388607.0F), 1) << i;
+  }
+}
+
+TEST_F(AudioFormatTest, MonoIsDuplicatedToEveryChannel) {
+  const auto out = render(PRISM_SAMPLE_FORMAT_F32, 2, 0);
+  EXPECT_EQ(out.channels, 2U);
+  ASSERT_EQ(out.frames, engine->frames);
+  const auto samples = out.samples<float>();
+  for (std::size_t i = 0; i < out.frames; ++i) {
+    ASSERT_FLOAT_EQ(samples[i * 2], source(i)) << i;
+    ASSERT_FLOAT_EQ(samples[(i * 2) + 1], source(i)) << i;
+  }
+}
+
+TEST_F(AudioFormatTest, DownsamplingKeepsDuration) {
+  const auto out = render(PRISM_SAMPLE_FORMAT_F32, 0, 16000);
+  EXPECT_EQ(out.sample_rate, 16000U);
+  EXPECT_NEAR(static_cast<double>(out.frames),
+              static_cast<double>(engine->frames) / 3.0, 2.0);
+}
+
+TEST_F(AudioFormatTest, DownsamplingPassesAudibleContent) {
+  engine->tone_hz = 1000.0;
+  const auto out = render(PRISM_SAMPLE_FORMAT_F32, 0, 16000);
+  const auto samples = out.samples<float>();
+  EXPECT_NEAR(settled_rms(samples), engine->amplitude / std::numbers::sqrt2,
+              0.02);
+}
+
+TEST_F(AudioFormatTest, DownsamplingFiltersAboveNyquist) {
+  // 20 kHz would alias to 4 kHz at 16 kHz without the low-pass filter.
+  engine->tone_hz = 20000.0;
+  const auto out = render(PRISM_SAMPLE_FORMAT_F32, 0, 16000);
+  const auto samples = out.samples<float>();
+  EXPECT_LT(settled_rms(samples), 0.01);
+}
+
+TEST_F(AudioFormatTest, UpsamplingInterpolates) {
+  const auto out = render(PRISM_SAMPLE_FORMAT_F32, 0, 96000);
+  EXPECT_EQ(out.sample_rate, 96000U);
+  ASSERT_NEAR(static_cast<double>(out.frames),
+              static_cast<double>(engine->frames) * 2.0, 2.0);
+  const auto samples = out.samples<float>();
+  for (std::size_t i = 0; i + 1 < engine->frames; ++i) {
+    ASSERT_NEAR(samples[i * 2], source(i), 1e-4) << i;
+    ASSERT_NEAR(samples[(i * 2) + 1], (source(i) + source(i + 1)) / 2.0F,
+                1e-4)
+        << i;
+  }
+}
+} // namespace
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+class AudioStreamTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+  PrismAudioStream *stream = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Stream", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Stream");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  void TearDown() override { prism_audio_stream_close(stream); }
+
+  void open(std::size_t capacity_frames) {
+    ASSERT_EQ(prism_backend_open_stream(backend, "hello", 5,
+                                        PRISM_TEXT_DEFAULT, capacity_frames,
+                                        &stream),
+              PRISM_OK);
+  }
+
+  // Reads until the end of the stream, returning the frames read and the
+  // final result.
+  std::pair<std::size_t, PrismError> read_all() {
+    std::vector<float> buffer(128);
+    std::size_t total = 0;
+    while (true) {
+      std::size_t got = 0;
+      const auto error = prism_audio_stream_read(stream, buffer.data(),
+                                                 buffer.size(), true, &got);
+      if (error != PRISM_OK)
+        return {total, error};
+      total += got;
+      if (got < buffer.size())
+        return {total, PRISM_OK};
+    }
+  }
+};
+
+TEST_F(AudioStreamTest, ReadsTheWholeUtteranceThroughASmallRing) {
+  open(64);
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+  ASSERT_EQ(prism_audio_stream_get_format(stream, &channels, &sample_rate),
+            PRISM_OK);
+  EXPECT_EQ(channels, 1U);
+  EXPECT_EQ(sample_rate, engine->sample_rate);
+  EXPECT_EQ(read_all(), std::pair(engine->frames, PRISM_OK));
+  std::size_t got = 1;
+  float sample = 0;
+  EXPECT_EQ(prism_audio_stream_read(stream, &sample, 1, true, &got), PRISM_OK);
+  EXPECT_EQ(got, 0U);
+}
+
+TEST_F(AudioStreamTest, SpeechBeforeReadingDoesNotWait) {
+  open(64);
+  // The ring fills long before the utterance ends, and nothing is read
+  // until the handle has been used again.
+  ASSERT_TRUE(
+      engine->wait_until([this] { return engine->renders.contains("hello"); }));
+  EXPECT_EQ(prism_backend_speak(backend, "next", false), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"next"});
+  const auto [frames, error] = read_all();
+  EXPECT_LE(frames, engine->frames);
+  EXPECT_TRUE(error == PRISM_OK || error == PRISM_ERROR_CANCELLED);
+}
+
+TEST_F(AudioStreamTest, StopEndsTheStream) {
+  open(64);
+  std::size_t channels = 0;
+  std::size_t sample_rate = 0;
+  ASSERT_EQ(prism_audio_stream_get_format(stream, &channels, &sample_rate),
+            PRISM_OK);
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  const auto [frames, error] = read_all();
+  EXPECT_LT(frames, engine->frames);
+  EXPECT_EQ(error, PRISM_ERROR_CANCELLED);
+}
+
+TEST_F(AudioStreamTest, CloseWhileRendering) {
+  engine->chunk_delay = std::chrono::milliseconds(5);
+  open(64);
+  ASSERT_TRUE(
+      engine->wait_until([this] { return engine->renders.contains("hello"); }));
+  prism_audio_stream_close(stream);
+  stream = nullptr;
+  EXPECT_EQ(prism_backend_speak(backend, "next", false), PRISM_OK);
+}
+
+TEST_F(AudioStreamTest, ZeroCapacityIsRejected) {
+  EXPECT_EQ(prism_backend_open_stream(backend, "hello", 5, PRISM_TEXT_DEFAULT,
+                                      0, &stream),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(stream, nullptr);
+}
+} // namespace
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace {
+void PRISM_CALL ignore_availability(void *, PrismBackendId, const char *,
+                                    bool) {}
+
+class AvailabilityTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *down = nullptr;
+  FakeEngine *up = nullptr;
+
+  void SetUp() override {
+    // Above every built-in backend, so those are never reached.
+    down = &fakes.add("Fake Down", 3000);
+    up = &fakes.add("Fake Up", 2000);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    down->supported = false;
+    down->init_result = PRISM_ERROR_BACKEND_NOT_AVAILABLE;
+  }
+
+  void start(bool enumerate) {
+    auto cfg = prism_config_init();
+    if (enumerate) {
+      cfg.availability_callback = ignore_availability;
+      cfg.availability_poll_interval_ms = 10;
+      cfg.availability_backoff_max_ms = 10;
+    }
+    ASSERT_TRUE(fakes.start(cfg));
+  }
+
+  // Waits for two more samples of `engine`, so that the first of them has
+  // been published by the time the second is taken.
+  static bool sampled(FakeEngine *engine) {
+    std::size_t before = 0;
+    {
+      std::lock_guard lock(engine->mutex);
+      before = engine->probes;
+    }
+    return engine->wait_until(
+        [engine, before] { return engine->probes >= before + 2; });
+  }
+
+  std::string create_best() {
+    auto *backend = prism_registry_create_best(fakes.context());
+    if (backend == nullptr)
+      return {};
+    std::string name = prism_backend_name(backend);
+    prism_backend_free(backend);
+    return name;
+  }
+
+  static std::size_t inits(FakeEngine *engine) {
+    std::lock_guard lock(engine->mutex);
+    return engine->inits;
+  }
+};
+
+TEST_F(AvailabilityTest, WithoutEnumeratorEveryBackendIsTried) {
+  start(false);
+  EXPECT_EQ(create_best(), "Fake Up");
+  EXPECT_EQ(inits(down), 1U);
+}
+
+TEST_F(AvailabilityTest, BackendKnownDownIsSkipped) {
+  start(true);
+  ASSERT_TRUE(sampled(down));
+  EXPECT_EQ(create_best(), "Fake Up");
+  EXPECT_EQ(inits(down), 0U);
+  auto *best = prism_registry_acquire_best(fakes.context());
+  ASSERT_NE(best, nullptr);
+  EXPECT_STREQ(prism_backend_name(best), "Fake Up");
+  prism_backend_free(best);
+  EXPECT_EQ(inits(down), 0U);
+}
+
+TEST_F(AvailabilityTest, BackendThatComesBackIsTriedAgain) {
+  start(true);
+  ASSERT_TRUE(sampled(down));
+  {
+    std::lock_guard lock(down->mutex);
+    down->supported = true;
+    down->init_result = PRISM_OK;
+  }
+  ASSERT_TRUE(sampled(down));
+  EXPECT_EQ(create_best(), "Fake Down");
+}
+} // namespace
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+class BackendGroupTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  std::array<FakeEngine *, 3> engines{};
+  std::array<PrismBackend *, 3> members{};
+  PrismBackendGroup *group = nullptr;
+
+  void SetUp() override {
+    engines = {&fakes.add("Fake First", 100), &fakes.add("Fake Second", 90),
+               &fakes.add("Fake Third", 80)};
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    members = {fakes.create("Fake First"), fakes.create("Fake Second"),
+               fakes.create("Fake Third")};
+    for (auto *member : members)
+      ASSERT_NE(member, nullptr);
+    ASSERT_EQ(prism_backend_group_new(members.data(), members.size(), &group),
+              PRISM_OK);
+  }
+
+  void TearDown() override { prism_backend_group_free(group); }
+
+  PrismError speak(std::string_view text, std::uint32_t timeout_ms,
+                   std::array<PrismError, 3> &results) {
+    return prism_backend_group_speak(group, text.data(), text.size(), false,
+                                     PRISM_TEXT_DEFAULT, timeout_ms,
+                                     results.data());
+  }
+};
+
+TEST_F(BackendGroupTest, EveryMemberSpeaks) {
+  EXPECT_EQ(prism_backend_group_count(group), 3U);
+  std::array<PrismError, 3> results{};
+  ASSERT_EQ(speak("hello", 0, results), PRISM_OK);
+  for (std::size_t i = 0; i < engines.size(); ++i) {
+    EXPECT_EQ(results[i], PRISM_OK) << i;
+    EXPECT_EQ(engines[i]->spoken(), std::vector<std::string>{"hello"}) << i;
+  }
+}
+
+TEST_F(BackendGroupTest, OneFailingMemberDoesNotFailTheGroup) {
+  engines[1]->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  std::array<PrismError, 3> results{};
+  ASSERT_EQ(speak("hello", 0, results), PRISM_OK);
+  EXPECT_EQ(results[0], PRISM_OK);
+  EXPECT_EQ(results[1], PRISM_ERROR_SPEAK_FAILURE);
+  EXPECT_EQ(results[2], PRISM_OK);
+}
+
+TEST_F(BackendGroupTest, FirstErrorIsReportedWhenAllFail) {
+  engines[0]->speak_result = PRISM_ERROR_NOT_SPEAKING;
+  engines[1]->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  engines[2]->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  std::array<PrismError, 3> results{};
+  EXPECT_EQ(speak("hello", 0, results), PRISM_ERROR_NOT_SPEAKING);
+}
+
+TEST_F(BackendGroupTest, SlowMemberDoesNotHoldUpTheOthers) {
+  {
+    std::lock_guard lock(engines[0]->mutex);
+    engines[0]->hold = true;
+  }
+  std::array<PrismError, 3> results{};
+  const auto before = std::chrono::steady_clock::now();
+  ASSERT_EQ(speak("hello", 100, results), PRISM_OK);
+  EXPECT_LT(std::chrono::steady_clock::now() - before,
+            std::chrono::seconds(2));
+  EXPECT_EQ(results[0], PRISM_ERROR_TIMED_OUT);
+  EXPECT_EQ(results[1], PRISM_OK);
+  EXPECT_EQ(results[2], PRISM_OK);
+  // The request keeps running on the slow member.
+  engines[0]->release();
+  EXPECT_TRUE(engines[0]->wait_until(
+      [this] { return engines[0]->calls.size() == 1; }));
+}
+
+TEST_F(BackendGroupTest, BrailleAndStopReachEveryMember) {
+  std::array<PrismError, 3> results{};
+  ASSERT_EQ(prism_backend_group_braille(group, "dots", 4, PRISM_TEXT_DEFAULT,
+                                        0, results.data()),
+            PRISM_OK);
+  ASSERT_EQ(prism_backend_group_stop(group, 0, results.data()), PRISM_OK);
+  for (auto *engine : engines) {
+    std::lock_guard lock(engine->mutex);
+    ASSERT_EQ(engine->calls.size(), 1U);
+    EXPECT_EQ(engine->calls[0].op, "braille");
+    EXPECT_EQ(engine->stops, 1U);
+  }
+}
+
+TEST_F(BackendGroupTest, BadMemberListsAreRejected) {
+  PrismBackendGroup *other = nullptr;
+  EXPECT_EQ(prism_backend_group_new(members.data(), 0, &other),
+            PRISM_ERROR_INVALID_PARAM);
+  const std::array<PrismBackend *, 2> twice{members[0], members[0]};
+  EXPECT_EQ(prism_backend_group_new(twice.data(), twice.size(), &other),
+            PRISM_ERROR_INVALID_PARAM);
+  const std::array<PrismBackend *, 2> missing{members[0], nullptr};
+  EXPECT_EQ(prism_backend_group_new(missing.data(), missing.size(), &other),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(other, nullptr);
+}
+} // namespace
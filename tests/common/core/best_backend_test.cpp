@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace {
+// Priorities well above every built-in backend's, so those are never
+// reached while a fake can win.
+constexpr int first = 3000;
+constexpr int second = 2000;
+constexpr int third = 1000;
+
+struct Ready {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool called = false;
+  PrismBackend *backend = nullptr;
+  PrismError result = PRISM_OK;
+};
+
+void PRISM_CALL on_ready(void *userdata, PrismBackend *backend,
+                         PrismError result) {
+  auto &ready = *static_cast<Ready *>(userdata);
+  {
+    std::scoped_lock lock(ready.mutex);
+    ready.called = true;
+    ready.backend = backend;
+    ready.result = result;
+  }
+  ready.cv.notify_all();
+}
+
+class BestBackendTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *a = nullptr;
+  FakeEngine *b = nullptr;
+  FakeEngine *c = nullptr;
+
+  void SetUp() override {
+    a = &fakes.add("Fake A", first);
+    b = &fakes.add("Fake B", second);
+    c = &fakes.add("Fake C", third);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+  }
+
+  void start(std::uint32_t parallelism, std::uint32_t deadline_ms) {
+    auto cfg = prism_config_init();
+    cfg.selection_parallelism = parallelism;
+    cfg.selection_deadline_ms = deadline_ms;
+    ASSERT_TRUE(fakes.start(cfg));
+  }
+
+  // The name of the backend create_best picks, which is then freed.
+  std::string create_best() {
+    auto *backend = prism_registry_create_best(fakes.context());
+    if (backend == nullptr)
+      return {};
+    std::string name = prism_backend_name(backend);
+    prism_backend_free(backend);
+    return name;
+  }
+
+  static std::size_t inits(FakeEngine *engine) {
+    std::lock_guard lock(engine->mutex);
+    return engine->inits;
+  }
+};
+
+TEST_F(BestBackendTest, HighestThatInitializesWins) {
+  a->init_result = PRISM_ERROR_BACKEND_NOT_AVAILABLE;
+  start(1, 0);
+  EXPECT_EQ(create_best(), "Fake B");
+  EXPECT_EQ(inits(a), 1U);
+  EXPECT_EQ(inits(b), 1U);
+  EXPECT_EQ(inits(c), 0U);
+}
+
+TEST_F(BestBackendTest, AcquireBestSharesItsInstance) {
+  start(1, 0);
+  auto *best = prism_registry_acquire_best(fakes.context());
+  ASSERT_NE(best, nullptr);
+  EXPECT_STREQ(prism_backend_name(best), "Fake A");
+  auto *again = prism_registry_acquire_best(fakes.context());
+  ASSERT_NE(again, nullptr);
+  EXPECT_EQ(inits(a), 1U);
+  prism_backend_free(again);
+  prism_backend_free(best);
+}
+
+TEST_F(BestBackendTest, ParallelWaitsForHigherPriority) {
+  a->init_delay = std::chrono::milliseconds(100);
+  start(3, 0);
+  EXPECT_EQ(create_best(), "Fake A");
+  EXPECT_EQ(inits(a), 1U);
+  // The others started at the same time and lost.
+  EXPECT_TRUE(b->wait_until([this] { return b->inits == 1; }));
+  EXPECT_TRUE(c->wait_until([this] { return c->inits == 1; }));
+}
+
+TEST_F(BestBackendTest, ParallelFailureMakesRoomForTheNext) {
+  a->init_result = PRISM_ERROR_BACKEND_NOT_AVAILABLE;
+  a->init_delay = std::chrono::milliseconds(50);
+  b->init_delay = std::chrono::milliseconds(50);
+  start(2, 0);
+  EXPECT_EQ(create_best(), "Fake B");
+  EXPECT_TRUE(c->wait_until([this] { return c->inits == 1; }));
+}
+
+TEST_F(BestBackendTest, DeadlineTakesTheBestReadySoFar) {
+  a->init_delay = std::chrono::milliseconds(500);
+  start(2, 50);
+  const auto before = std::chrono::steady_clock::now();
+  EXPECT_EQ(create_best(), "Fake B");
+  EXPECT_LT(std::chrono::steady_clock::now() - before,
+            std::chrono::milliseconds(400));
+}
+
+TEST_F(BestBackendTest, DeadlineWithNothingReadyTimesOut) {
+  a->init_delay = std::chrono::milliseconds(300);
+  start(1, 50);
+  Ready ready;
+  ASSERT_EQ(prism_registry_acquire_best_async(fakes.context(), on_ready,
+                                              &ready),
+            PRISM_OK);
+  std::unique_lock lock(ready.mutex);
+  ASSERT_TRUE(ready.cv.wait_for(lock, std::chrono::seconds(5),
+                                [&ready] { return ready.called; }));
+  EXPECT_EQ(ready.backend, nullptr);
+  EXPECT_EQ(ready.result, PRISM_ERROR_TIMED_OUT);
+}
+
+TEST_F(BestBackendTest, AsyncAcquireReportsTheBackend) {
+  b->init_result = PRISM_ERROR_BACKEND_NOT_AVAILABLE;
+  a->init_result = PRISM_ERROR_BACKEND_NOT_AVAILABLE;
+  start(2, 0);
+  Ready ready;
+  ASSERT_EQ(prism_registry_acquire_best_async(fakes.context(), on_ready,
+                                              &ready),
+            PRISM_OK);
+  std::unique_lock lock(ready.mutex);
+  ASSERT_TRUE(ready.cv.wait_for(lock, std::chrono::seconds(5),
+                                [&ready] { return ready.called; }));
+  ASSERT_EQ(ready.result, PRISM_OK);
+  ASSERT_NE(ready.backend, nullptr);
+  EXPECT_STREQ(prism_backend_name(ready.backend), "Fake C");
+  prism_backend_free(ready.backend);
+}
+} // namespace
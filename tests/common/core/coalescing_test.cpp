@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+class CoalescingTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Coalescing", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Coalescing");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismUtteranceId submit(const char *text, bool interrupt) {
+    PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+    EXPECT_EQ(prism_backend_speak_async(backend, text, std::strlen(text),
+                                        interrupt, PRISM_TEXT_DEFAULT, nullptr,
+                                        nullptr, &id),
+              PRISM_OK);
+    return id;
+  }
+
+  PrismCoalescingStats stats() {
+    PrismCoalescingStats out{};
+    EXPECT_EQ(prism_backend_get_coalescing_stats(backend, &out), PRISM_OK);
+    return out;
+  }
+};
+
+TEST_F(CoalescingTest, OffByDefault) {
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"hello", "hello"}));
+  EXPECT_EQ(stats().deduplicated, 0U);
+}
+
+TEST_F(CoalescingTest, TextJustSpokenIsDropped) {
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 5000), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"hello"});
+  EXPECT_EQ(stats().deduplicated, 1U);
+}
+
+TEST_F(CoalescingTest, RepeatOfAnotherKindIsNotDropped) {
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 5000), PRISM_OK);
+  EXPECT_EQ(prism_backend_output(backend, "hello", false), PRISM_OK);
+  EXPECT_EQ(prism_backend_speak(backend, "hello", false), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_EQ(engine->calls[0].op, "output");
+  EXPECT_EQ(engine->calls[1].op, "speak");
+}
+
+TEST_F(CoalescingTest, StopForgetsTextJustSpoken) {
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 5000), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("hello", false)), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"hello", "hello"}));
+  EXPECT_EQ(stats().deduplicated, 0U);
+}
+
+TEST_F(CoalescingTest, LatestInterruptWithinWindowWins) {
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 500), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("one", true)), PRISM_OK);
+  const auto two = submit("two", true);
+  const auto three = submit("three", true);
+  EXPECT_EQ(prism_backend_wait(backend, two), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(prism_backend_wait(backend, three), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "three"}));
+  EXPECT_EQ(stats().dropped, 1U);
+}
+
+TEST_F(CoalescingTest, TurningItOffReleasesHeldInterrupt) {
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 60000), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, submit("one", true)), PRISM_OK);
+  const auto two = submit("two", true);
+  ASSERT_EQ(prism_backend_set_coalescing(backend, 0), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, two), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "two"}));
+}
+} // namespace
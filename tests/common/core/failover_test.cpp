@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+class FailoverTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *first = nullptr;
+  FakeEngine *second = nullptr;
+  std::array<PrismBackend *, 2> members{};
+  PrismFailover *failover = nullptr;
+
+  void start(const PrismFailoverOptions *options = nullptr) {
+    first = &fakes.add("Fake Primary", 100);
+    second = &fakes.add("Fake Secondary", 50);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    members = {fakes.create("Fake Primary"), fakes.create("Fake Secondary")};
+    ASSERT_NE(members[0], nullptr);
+    ASSERT_NE(members[1], nullptr);
+    ASSERT_EQ(prism_failover_new(members.data(), members.size(), options,
+                                 &failover),
+              PRISM_OK);
+  }
+
+  void TearDown() override { prism_failover_free(failover); }
+
+  PrismError speak(std::string_view text, std::size_t *out_member) {
+    return prism_failover_speak(failover, text.data(), text.size(), false,
+                                PRISM_TEXT_DEFAULT, out_member);
+  }
+
+  PrismBackendHealth health(std::size_t index) {
+    PrismBackendHealth out{};
+    EXPECT_EQ(prism_failover_get_health(failover, index, &out), PRISM_OK);
+    return out;
+  }
+
+  static PrismFailoverOptions options() {
+    PrismFailoverOptions out{};
+    out.size = sizeof(out);
+    return out;
+  }
+};
+
+TEST_F(FailoverTest, PreferredMemberSpeaks) {
+  start();
+  std::size_t member = 2;
+  ASSERT_EQ(speak("hello", &member), PRISM_OK);
+  EXPECT_EQ(member, 0U);
+  EXPECT_EQ(first->spoken(), std::vector<std::string>{"hello"});
+  EXPECT_TRUE(second->spoken().empty());
+}
+
+TEST_F(FailoverTest, FailureMovesToNextMember) {
+  start();
+  first->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  std::size_t member = 2;
+  ASSERT_EQ(speak("hello", &member), PRISM_OK);
+  EXPECT_EQ(member, 1U);
+  EXPECT_EQ(second->spoken(), std::vector<std::string>{"hello"});
+  EXPECT_EQ(health(0).failures, 1U);
+  EXPECT_EQ(health(1).successes, 1U);
+}
+
+TEST_F(FailoverTest, FirstErrorIsReportedWhenAllFail) {
+  start();
+  first->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  second->speak_result = PRISM_ERROR_INTERNAL;
+  EXPECT_EQ(speak("hello", nullptr), PRISM_ERROR_SPEAK_FAILURE);
+}
+
+TEST_F(FailoverTest, OpenCircuitIsSkipped) {
+  start();
+  first->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  for (int i = 0; i < 4; ++i)
+    ASSERT_EQ(speak("hello", nullptr), PRISM_OK);
+  ASSERT_TRUE(health(0).circuit_open);
+  std::size_t entered = 0;
+  {
+    std::lock_guard lock(first->mutex);
+    entered = first->entered;
+  }
+  std::size_t member = 2;
+  ASSERT_EQ(speak("again", &member), PRISM_OK);
+  EXPECT_EQ(member, 1U);
+  std::lock_guard lock(first->mutex);
+  EXPECT_EQ(first->entered, entered);
+}
+
+TEST_F(FailoverTest, MemberFiltersApply) {
+  start();
+  first->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  ASSERT_EQ(prism_backend_set_text_filters(members[1],
+                                           PRISM_TEXT_FILTER_STRIP_TAGS),
+            PRISM_OK);
+  ASSERT_EQ(speak("<b>bold</b>", nullptr), PRISM_OK);
+  EXPECT_EQ(second->spoken(), std::vector<std::string>{"bold"});
+}
+
+TEST_F(FailoverTest, TimedOutMemberIsStopped) {
+  auto opts = options();
+  opts.timeout_ms = 100;
+  start(&opts);
+  {
+    std::lock_guard lock(first->mutex);
+    first->hold = true;
+  }
+  std::size_t member = 2;
+  ASSERT_EQ(speak("hello", &member), PRISM_OK);
+  EXPECT_EQ(member, 1U);
+  first->release();
+  EXPECT_TRUE(first->wait_until([this] { return first->stops == 1; }));
+}
+
+TEST_F(FailoverTest, HedgeLoserIsStopped) {
+  auto opts = options();
+  opts.timeout_ms = 5000;
+  opts.hedge_ms = 50;
+  start(&opts);
+  {
+    std::lock_guard lock(first->mutex);
+    first->hold = true;
+  }
+  const auto before = std::chrono::steady_clock::now();
+  std::size_t member = 2;
+  ASSERT_EQ(speak("hello", &member), PRISM_OK);
+  EXPECT_LT(std::chrono::steady_clock::now() - before,
+            std::chrono::seconds(2));
+  EXPECT_EQ(member, 1U);
+  EXPECT_EQ(second->spoken(), std::vector<std::string>{"hello"});
+  first->release();
+  EXPECT_TRUE(first->wait_until([this] { return first->stops == 1; }));
+}
+} // namespace
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <thread>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+constexpr auto patience = std::chrono::seconds(5);
+
+FakeEngine &engine_of(void *instance) {
+  return *static_cast<FakeEngine *>(instance);
+}
+
+PrismError say(void *instance, const char *op, const char *text,
+               bool interrupt) {
+  auto &engine = engine_of(instance);
+  std::unique_lock lock(engine.mutex);
+  ++engine.entered;
+  engine.cv.notify_all();
+  engine.cv.wait(lock, [&engine, text] {
+    return !engine.hold ||
+           (!engine.held_text.empty() && engine.held_text != text);
+  });
+  if (engine.speak_result != PRISM_OK)
+    return engine.speak_result;
+  engine.calls.push_back({.op = op, .text = text, .interrupt = interrupt});
+  engine.speaking_until = Clock::now() + engine.speech_length;
+  engine.cv.notify_all();
+  return PRISM_OK;
+}
+
+bool PRISM_CALL fake_is_supported(void *instance) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  ++engine.probes;
+  engine.cv.notify_all();
+  return engine.supported;
+}
+
+PrismError PRISM_CALL fake_initialize(void *instance) {
+  auto &engine = engine_of(instance);
+  std::chrono::milliseconds delay{};
+  {
+    std::scoped_lock lock(engine.mutex);
+    delay = engine.init_delay;
+  }
+  std::this_thread::sleep_for(delay);
+  std::scoped_lock lock(engine.mutex);
+  ++engine.inits;
+  engine.cv.notify_all();
+  return engine.init_result;
+}
+
+PrismError PRISM_CALL fake_speak(void *instance, const char *text,
+                                 bool interrupt) {
+  return say(instance, "speak", text, interrupt);
+}
+
+PrismError PRISM_CALL fake_output(void *instance, const char *text,
+                                  bool interrupt) {
+  return say(instance, "output", text, interrupt);
+}
+
+PrismError PRISM_CALL fake_speak_ssml(void *instance, const char *ssml,
+                                      bool interrupt) {
+  return say(instance, "ssml", ssml, interrupt);
+}
+
+PrismError PRISM_CALL fake_speak_batch(void *instance,
+                                       const PrismUtterance *items,
+                                       size_t count) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  ++engine.batches;
+  for (std::size_t i = 0; i < count; ++i)
+    engine.calls.push_back({.op = "batch",
+                            .text = std::string{items[i].text, items[i].length},
+                            .interrupt = items[i].interrupt});
+  engine.cv.notify_all();
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_braille(void *instance, const char *text) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  engine.calls.push_back({.op = "braille", .text = text, .interrupt = false});
+  engine.cv.notify_all();
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_speak_to_memory(void *instance, const char *text,
+                                           PrismAudioCallback callback,
+                                           void *userdata) {
+  auto &engine = engine_of(instance);
+  std::vector<float> samples;
+  std::size_t chunk = 0;
+  std::size_t sample_rate = 0;
+  std::chrono::milliseconds delay{};
+  {
+    std::scoped_lock lock(engine.mutex);
+    ++engine.renders[text];
+    engine.cv.notify_all();
+    samples.resize(engine.frames);
+    for (std::size_t i = 0; i < samples.size(); ++i)
+      samples[i] = engine.amplitude *
+                   static_cast<float>(std::sin(
+                       2.0 * std::numbers::pi * engine.tone_hz *
+                       static_cast<double>(i) /
+                       static_cast<double>(engine.sample_rate)));
+    chunk = std::max<std::size_t>(engine.chunk_frames, 1);
+    sample_rate = engine.sample_rate;
+    delay = engine.chunk_delay;
+  }
+  for (std::size_t at = 0; at < samples.size(); at += chunk) {
+    if (at != 0 && delay.count() != 0)
+      std::this_thread::sleep_for(delay);
+    callback(userdata, samples.data() + at,
+             std::min(chunk, samples.size() - at), 1, sample_rate);
+  }
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_stop(void *instance) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  ++engine.stops;
+  engine.speaking_until = {};
+  engine.cv.notify_all();
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_is_speaking(void *instance, bool *out_speaking) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  *out_speaking = Clock::now() < engine.speaking_until;
+  return PRISM_OK;
+}
+
+template <float FakeEngine::*Member>
+PrismError PRISM_CALL fake_set(void *instance, float value) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  engine.*Member = value;
+  if constexpr (Member == &FakeEngine::rate)
+    engine.rates_set.push_back(value);
+  engine.cv.notify_all();
+  return PRISM_OK;
+}
+
+template <float FakeEngine::*Member>
+PrismError PRISM_CALL fake_get(void *instance, float *out_value) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  *out_value = engine.*Member;
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_refresh_voices(void *instance) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  ++engine.refreshes;
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_count_voices(void *instance, size_t *out_count) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  *out_count = engine.voices.size();
+  return PRISM_OK;
+}
+
+template <std::string FakeEngine::Voice::*Member>
+PrismError PRISM_CALL fake_voice_string(void *instance, size_t voice_id,
+                                        const char **out_value) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  if (voice_id >= engine.voices.size())
+    return PRISM_ERROR_VOICE_NOT_FOUND;
+  *out_value = (engine.voices[voice_id].*Member).c_str();
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_set_voice(void *instance, size_t voice_id) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  if (voice_id >= engine.voices.size())
+    return PRISM_ERROR_VOICE_NOT_FOUND;
+  engine.voice = voice_id;
+  return PRISM_OK;
+}
+
+PrismError PRISM_CALL fake_get_voice(void *instance, size_t *out_voice_id) {
+  auto &engine = engine_of(instance);
+  std::scoped_lock lock(engine.mutex);
+  *out_voice_id = engine.voice;
+  return PRISM_OK;
+}
+
+constexpr std::uint64_t fake_features =
+    PRISM_BACKEND_IS_SUPPORTED_AT_RUNTIME | PRISM_BACKEND_SUPPORTS_SPEAK |
+    PRISM_BACKEND_SUPPORTS_SPEAK_TO_MEMORY | PRISM_BACKEND_SUPPORTS_BRAILLE |
+    PRISM_BACKEND_SUPPORTS_OUTPUT | PRISM_BACKEND_SUPPORTS_IS_SPEAKING |
+    PRISM_BACKEND_SUPPORTS_STOP | PRISM_BACKEND_SUPPORTS_SET_VOLUME |
+    PRISM_BACKEND_SUPPORTS_GET_VOLUME | PRISM_BACKEND_SUPPORTS_SET_RATE |
+    PRISM_BACKEND_SUPPORTS_GET_RATE | PRISM_BACKEND_SUPPORTS_SET_PITCH |
+    PRISM_BACKEND_SUPPORTS_GET_PITCH | PRISM_BACKEND_SUPPORTS_REFRESH_VOICES |
+    PRISM_BACKEND_SUPPORTS_COUNT_VOICES |
+    PRISM_BACKEND_SUPPORTS_GET_VOICE_NAME |
+    PRISM_BACKEND_SUPPORTS_GET_VOICE_LANGUAGE |
+    PRISM_BACKEND_SUPPORTS_GET_VOICE | PRISM_BACKEND_SUPPORTS_SET_VOICE;
+
+PrismBackendVTable make_vtable(bool ssml, bool paced) {
+  PrismBackendVTable vtable{};
+  vtable.size = sizeof(PrismBackendVTable);
+  vtable.is_supported = fake_is_supported;
+  vtable.initialize = fake_initialize;
+  vtable.speak = fake_speak;
+  vtable.speak_to_memory = fake_speak_to_memory;
+  vtable.braille = fake_braille;
+  vtable.output = fake_output;
+  vtable.stop = fake_stop;
+  if (paced)
+    vtable.is_speaking = fake_is_speaking;
+  vtable.set_volume = fake_set<&FakeEngine::volume>;
+  vtable.get_volume = fake_get<&FakeEngine::volume>;
+  vtable.set_rate = fake_set<&FakeEngine::rate>;
+  vtable.get_rate = fake_get<&FakeEngine::rate>;
+  vtable.set_pitch = fake_set<&FakeEngine::pitch>;
+  vtable.get_pitch = fake_get<&FakeEngine::pitch>;
+  vtable.refresh_voices = fake_refresh_voices;
+  vtable.count_voices = fake_count_voices;
+  vtable.get_voice_name = fake_voice_string<&FakeEngine::Voice::name>;
+  vtable.get_voice_language = fake_voice_string<&FakeEngine::Voice::language>;
+  vtable.set_voice = fake_set_voice;
+  vtable.get_voice = fake_get_voice;
+  vtable.speak_batch = fake_speak_batch;
+  if (ssml)
+    vtable.speak_ssml = fake_speak_ssml;
+  return vtable;
+}
+
+const PrismBackendVTable plain_vtable = make_vtable(false, true);
+const PrismBackendVTable ssml_vtable = make_vtable(true, true);
+const PrismBackendVTable unpaced_vtable = make_vtable(false, false);
+} // namespace
+
+void FakeEngine::release() {
+  {
+    std::scoped_lock lock(mutex);
+    hold = false;
+  }
+  cv.notify_all();
+}
+
+std::vector<std::string> FakeEngine::spoken() {
+  std::scoped_lock lock(mutex);
+  std::vector<std::string> texts;
+  for (const auto &call : calls)
+    texts.push_back(call.text);
+  return texts;
+}
+
+std::size_t FakeEngine::rendered(std::string_view text) {
+  std::scoped_lock lock(mutex);
+  const auto it = renders.find(text);
+  return it != renders.end() ? it->second : 0;
+}
+
+bool FakeEngine::wait_until(const std::function<bool()> &done) {
+  std::unique_lock lock(mutex);
+  return cv.wait_for(lock, patience, done);
+}
+
+FakeRegistry::FakeRegistry() : builder(prism_registry_builder_new()) {}
+
+FakeRegistry::~FakeRegistry() {
+  for (auto *backend : backends)
+    prism_backend_free(backend);
+  if (ctx != nullptr)
+    prism_shutdown(ctx);
+  if (registry != nullptr)
+    prism_registry_release(registry);
+  if (builder != nullptr)
+    prism_registry_builder_free(builder);
+}
+
+FakeEngine &FakeRegistry::add(const char *name, int priority,
+                              std::uint64_t features,
+                              const PrismBackendVTable &vtable,
+                              PrismBackendId *out_id) {
+  auto &engine = *engines.emplace_back(std::make_unique<FakeEngine>());
+  PrismBackendId id = PRISM_BACKEND_INVALID;
+  const auto error = prism_registry_builder_add_backend(
+      builder, name, priority, features, &vtable, &engine, nullptr, &id);
+  if (error != PRISM_OK && add_error == PRISM_OK)
+    add_error = error;
+  if (out_id != nullptr)
+    *out_id = id;
+  return engine;
+}
+
+FakeEngine &FakeRegistry::add(const char *name, int priority, bool ssml,
+                              PrismBackendId *out_id) {
+  if (ssml)
+    return add(name, priority,
+               fake_features | PRISM_BACKEND_SUPPORTS_SPEAK_SSML, ssml_vtable,
+               out_id);
+  return add(name, priority, fake_features, plain_vtable, out_id);
+}
+
+FakeEngine &FakeRegistry::add_unpaced(const char *name, int priority) {
+  return add(name, priority,
+             fake_features & ~std::uint64_t{PRISM_BACKEND_SUPPORTS_IS_SPEAKING},
+             unpaced_vtable, nullptr);
+}
+
+bool FakeRegistry::start(std::size_t audio_cache_bytes) {
+  auto cfg = prism_config_init();
+  cfg.audio_cache_bytes = audio_cache_bytes;
+  return start(cfg);
+}
+
+bool FakeRegistry::start(PrismConfig cfg) {
+  registry = prism_registry_freeze(builder);
+  if (registry == nullptr)
+    return false;
+  cfg.registry = registry;
+  ctx = prism_init(&cfg);
+  return ctx != nullptr;
+}
+
+PrismBackend *FakeRegistry::keep(PrismBackend *backend) {
+  if (backend == nullptr)
+    return nullptr;
+  backends.push_back(backend);
+  const auto error = prism_backend_initialize(backend);
+  if (error != PRISM_OK && error != PRISM_ERROR_ALREADY_INITIALIZED)
+    return nullptr;
+  return backend;
+}
+
+PrismBackend *FakeRegistry::create(const char *name) {
+  return keep(prism_registry_create(ctx, prism_registry_id(ctx, name)));
+}
+
+PrismBackend *FakeRegistry::acquire(const char *name) {
+  return keep(prism_registry_acquire(ctx, prism_registry_id(ctx, name)));
+}
+
+bool eventually(const std::function<bool()> &done) {
+  const auto until = Clock::now() + patience;
+  while (!done()) {
+    if (Clock::now() >= until)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
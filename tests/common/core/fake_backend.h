@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#pragma once
+
+#include <prism.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A scripted engine behind a custom backend registration. Every vtable call
+// lands here, on whichever thread Prism makes it from, and is recorded so that
+// tests can check exactly what reached the engine.
+struct FakeEngine {
+  struct Call {
+    std::string op;
+    std::string text;
+    bool interrupt;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<Call> calls;
+  std::vector<float> rates_set;
+  std::map<std::string, std::size_t, std::less<>> renders;
+  float volume = 1.0F;
+  float rate = 0.5F;
+  float pitch = 0.5F;
+  struct Voice {
+    std::string name;
+    std::string language;
+  };
+  std::vector<Voice> voices{{.name = "Alice", .language = "en-US"},
+                            {.name = "Bruno", .language = "pt-BR"},
+                            {.name = "Claire", .language = "en-GB"}};
+  std::size_t voice = 0;
+  std::size_t refreshes = 0;
+  std::size_t stops = 0;
+  // What is_supported reports, and how often it has been asked.
+  bool supported = true;
+  std::size_t probes = 0;
+  // initialize fails with this while it is not PRISM_OK, after `init_delay`.
+  PrismError init_result = PRISM_OK;
+  std::chrono::milliseconds init_delay{0};
+  std::size_t inits = 0;
+  // Batches taken whole; their items are recorded as "batch" calls.
+  std::size_t batches = 0;
+  // speak and output fail with this while it is not PRISM_OK.
+  PrismError speak_result = PRISM_OK;
+  // speak and output block while this is set and the text is `held_text`,
+  // or any text if `held_text` is empty.
+  bool hold = false;
+  std::string held_text;
+  std::size_t entered = 0;
+  // How long is_speaking reports speech after each speak.
+  std::chrono::milliseconds speech_length{0};
+  std::chrono::steady_clock::time_point speaking_until;
+  // Memory synthesis: a sine of `tone_hz` at `amplitude`, `frames` frames
+  // long, delivered `chunk_frames` at a time with `chunk_delay` between
+  // chunks.
+  double tone_hz = 1000.0;
+  float amplitude = 0.5F;
+  std::size_t sample_rate = 48000;
+  std::size_t frames = 4800;
+  std::size_t chunk_frames = 480;
+  std::chrono::milliseconds chunk_delay{0};
+
+  void release();
+  [[nodiscard]] std::vector<std::string> spoken();
+  [[nodiscard]] std::size_t rendered(std::string_view text);
+  // Waits up to five seconds for `done`, checked under the engine's mutex.
+  [[nodiscard]] bool wait_until(const std::function<bool()> &done);
+};
+
+// A context bound to a registry of fake engines. Engines are added before
+// start(), which freezes the registry.
+class FakeRegistry {
+  PrismRegistryBuilder *builder;
+  PrismRegistry *registry = nullptr;
+  PrismContext *ctx = nullptr;
+  std::vector<std::unique_ptr<FakeEngine>> engines;
+  std::vector<PrismBackend *> backends;
+  PrismError add_error = PRISM_OK;
+
+  PrismBackend *keep(PrismBackend *backend);
+  FakeEngine &add(const char *name, int priority, std::uint64_t features,
+                  const PrismBackendVTable &vtable, PrismBackendId *out_id);
+
+public:
+  FakeRegistry();
+  ~FakeRegistry();
+  FakeRegistry(const FakeRegistry &) = delete;
+  FakeRegistry &operator=(const FakeRegistry &) = delete;
+  FakeRegistry(FakeRegistry &&) = delete;
+  FakeRegistry &operator=(FakeRegistry &&) = delete;
+  // Registers an engine under `name`. With `ssml` set it also speaks SSML
+  // natively.
+  FakeEngine &add(const char *name, int priority, bool ssml = false,
+                  PrismBackendId *out_id = nullptr);
+  // Registers an engine that cannot say whether it is speaking.
+  FakeEngine &add_unpaced(const char *name, int priority);
+  // Returns PRISM_OK or the first registration error.
+  [[nodiscard]] PrismError error() const noexcept { return add_error; }
+  [[nodiscard]] bool start(std::size_t audio_cache_bytes = 0);
+  // As above, with the rest of the context's configuration; its registry is
+  // filled in.
+  [[nodiscard]] bool start(PrismConfig cfg);
+  [[nodiscard]] PrismContext *context() const noexcept { return ctx; }
+  // An initialized instance, freed with the registry.
+  [[nodiscard]] PrismBackend *create(const char *name);
+  [[nodiscard]] PrismBackend *acquire(const char *name);
+};
+
+// Polls `done` for up to five seconds.
+[[nodiscard]] bool eventually(const std::function<bool()> &done);
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+namespace {
+class LatencyStatsTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  PrismBackendId id = PRISM_BACKEND_INVALID;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    (void)fakes.add("Fake Stats", 100, false, &id);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Stats");
+    ASSERT_NE(backend, nullptr);
+    prism_stats_reset();
+  }
+
+  PrismLatencyHistogram snapshot(PrismStatsOperation operation,
+                                 PrismStatsLayer layer) {
+    PrismLatencyHistogram out{};
+    EXPECT_EQ(prism_stats_snapshot(id, operation, layer, &out), PRISM_OK);
+    return out;
+  }
+};
+
+TEST_F(LatencyStatsTest, CallsAreCountedInBothLayers) {
+  for (int i = 0; i < 3; ++i)
+    ASSERT_EQ(prism_backend_speak(backend, "hello", false), PRISM_OK);
+  ASSERT_EQ(prism_backend_stop(backend), PRISM_OK);
+  for (const auto layer : {PRISM_STATS_LAYER_API, PRISM_STATS_LAYER_ENGINE}) {
+    const auto speak = snapshot(PRISM_STATS_SPEAK, layer);
+    EXPECT_EQ(speak.count, 3U) << layer;
+    EXPECT_EQ(std::accumulate(std::begin(speak.buckets),
+                              std::end(speak.buckets), std::uint64_t{0}),
+              3U)
+        << layer;
+    EXPECT_EQ(snapshot(PRISM_STATS_STOP, layer).count, 1U) << layer;
+    EXPECT_EQ(snapshot(PRISM_STATS_BRAILLE, layer).count, 0U) << layer;
+  }
+}
+
+TEST_F(LatencyStatsTest, ResetClearsEverything) {
+  ASSERT_EQ(prism_backend_speak(backend, "hello", false), PRISM_OK);
+  prism_stats_reset();
+  const auto speak = snapshot(PRISM_STATS_SPEAK, PRISM_STATS_LAYER_API);
+  EXPECT_EQ(speak.count, 0U);
+  EXPECT_EQ(speak.sum_us, 0U);
+}
+
+TEST_F(LatencyStatsTest, BadArgumentsAreRejected) {
+  PrismLatencyHistogram out{};
+  EXPECT_EQ(prism_stats_snapshot(id, PRISM_STATS_OPERATION_COUNT,
+                                 PRISM_STATS_LAYER_API, &out),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(prism_stats_snapshot(id, PRISM_STATS_SPEAK,
+                                 PRISM_STATS_LAYER_COUNT, &out),
+            PRISM_ERROR_INVALID_PARAM);
+}
+
+TEST(LatencyBucketsTest, FloorsRiseStrictly) {
+  EXPECT_EQ(prism_stats_bucket_floor(0), 0U);
+  for (std::size_t i = 1; i < PRISM_STATS_BUCKET_COUNT; ++i)
+    ASSERT_GT(prism_stats_bucket_floor(i), prism_stats_bucket_floor(i - 1))
+        << i;
+  EXPECT_EQ(prism_stats_bucket_floor(PRISM_STATS_BUCKET_COUNT),
+            std::numeric_limits<std::uint64_t>::max());
+}
+
+TEST(LatencyBucketsTest, PercentileFindsItsBucket) {
+  PrismLatencyHistogram histogram{};
+  EXPECT_EQ(prism_stats_percentile(&histogram, 50.0), 0U);
+  histogram.buckets[10] = 90;
+  histogram.buckets[40] = 10;
+  histogram.count = 100;
+  EXPECT_EQ(prism_stats_percentile(&histogram, 50.0),
+            prism_stats_bucket_floor(10));
+  EXPECT_EQ(prism_stats_percentile(&histogram, 99.0),
+            prism_stats_bucket_floor(40));
+  EXPECT_EQ(prism_stats_percentile(&histogram, 200.0),
+            prism_stats_bucket_floor(40));
+  EXPECT_EQ(prism_stats_percentile(&histogram, -1.0), 0U);
+  EXPECT_EQ(prism_stats_percentile(&histogram, std::nan("")), 0U);
+}
+} // namespace
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <vector>
+
+namespace {
+struct Chunks {
+  std::vector<std::size_t> sizes;
+  std::size_t samples = 0;
+  // Cancelled once this many chunks have arrived, if set.
+  PrismCancelToken *cancel = nullptr;
+  std::size_t cancel_after = 0;
+};
+
+void PRISM_CALL collect(void *userdata, const float *, size_t count, size_t,
+                        size_t) {
+  auto &out = *static_cast<Chunks *>(userdata);
+  out.sizes.push_back(count);
+  out.samples += count;
+  if (out.cancel != nullptr && out.sizes.size() == out.cancel_after)
+    prism_cancel_token_cancel(out.cancel);
+}
+
+class MemoryChunksTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+  PrismCancelToken *token = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Chunks", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Chunks");
+    ASSERT_NE(backend, nullptr);
+    token = prism_cancel_token_new();
+    ASSERT_NE(token, nullptr);
+  }
+
+  void TearDown() override { prism_cancel_token_free(token); }
+
+  static PrismMemoryOptions options() {
+    PrismMemoryOptions out{};
+    out.size = sizeof(out);
+    out.sample_format = PRISM_SAMPLE_FORMAT_F32;
+    return out;
+  }
+
+  PrismError render(const PrismMemoryOptions &opts, Chunks &out) {
+    return prism_backend_speak_to_memory_ex(backend, "hello", 5, collect, &out,
+                                            PRISM_TEXT_DEFAULT, &opts);
+  }
+};
+
+TEST_F(MemoryChunksTest, ChunksArriveAsTheEngineDeliversThem) {
+  Chunks out;
+  ASSERT_EQ(render(options(), out), PRISM_OK);
+  EXPECT_EQ(out.samples, engine->frames);
+  EXPECT_EQ(out.sizes.size(), engine->frames / engine->chunk_frames);
+}
+
+TEST_F(MemoryChunksTest, ChunksAreSplitToTheLimit) {
+  auto opts = options();
+  opts.max_chunk_frames = 100;
+  Chunks out;
+  ASSERT_EQ(render(opts, out), PRISM_OK);
+  EXPECT_EQ(out.samples, engine->frames);
+  for (const auto size : out.sizes)
+    EXPECT_LE(size, 100U);
+  // Each 480-frame chunk becomes four full pieces and a short one.
+  EXPECT_EQ(out.sizes.size(), 5 * engine->frames / engine->chunk_frames);
+  EXPECT_EQ(out.sizes[4], 80U);
+}
+
+TEST_F(MemoryChunksTest, CancelledTokenDeliversNothing) {
+  prism_cancel_token_cancel(token);
+  EXPECT_TRUE(prism_cancel_token_is_cancelled(token));
+  auto opts = options();
+  opts.cancel = token;
+  Chunks out;
+  EXPECT_EQ(render(opts, out), PRISM_ERROR_CANCELLED);
+  EXPECT_TRUE(out.sizes.empty());
+  EXPECT_EQ(engine->rendered("hello"), 0U);
+}
+
+TEST_F(MemoryChunksTest, CancelStopsFurtherChunks) {
+  EXPECT_FALSE(prism_cancel_token_is_cancelled(token));
+  auto opts = options();
+  opts.cancel = token;
+  opts.max_chunk_frames = 100;
+  Chunks out{.sizes = {}, .samples = 0, .cancel = token, .cancel_after = 2};
+  EXPECT_EQ(render(opts, out), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(out.sizes.size(), 2U);
+  EXPECT_EQ(out.samples, 200U);
+}
+
+TEST_F(MemoryChunksTest, BadOptionsAreRejected) {
+  Chunks out;
+  auto opts = options();
+  opts.size = 0;
+  EXPECT_EQ(render(opts, out), PRISM_ERROR_INVALID_PARAM);
+  opts = options();
+  opts.flags = 1U << 30;
+  EXPECT_EQ(render(opts, out), PRISM_ERROR_INVALID_PARAM);
+  // Integer samples only come through the PCM variant.
+  opts = options();
+  opts.sample_format = PRISM_SAMPLE_FORMAT_S16;
+  EXPECT_EQ(render(opts, out), PRISM_ERROR_INVALID_PARAM);
+  EXPECT_TRUE(out.sizes.empty());
+}
+
+TEST_F(MemoryChunksTest, ShortOptionsReadAsZero) {
+  // A caller built against a header that ended at max_chunk_frames.
+  auto opts = options();
+  opts.size = offsetof(PrismMemoryOptions, cancel);
+  opts.max_chunk_frames = 1000;
+  opts.cancel = token;
+  prism_cancel_token_cancel(token);
+  Chunks out;
+  ASSERT_EQ(render(opts, out), PRISM_OK);
+  EXPECT_EQ(out.samples, engine->frames);
+}
+} // namespace
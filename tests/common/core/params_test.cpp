@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace {
+class ParamsTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Params", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.acquire("Fake Params");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  float rate(PrismBackend *from) {
+    float out = -1.0F;
+    EXPECT_EQ(prism_backend_get_rate(from, &out), PRISM_OK);
+    return out;
+  }
+
+  void engine_rate(float value) {
+    std::lock_guard lock(engine->mutex);
+    engine->rate = value;
+  }
+};
+
+TEST_F(ParamsTest, CustomBackendsAreAlwaysAsked) {
+  EXPECT_FLOAT_EQ(rate(backend), 0.5F);
+  // The host changed it without going through Prism.
+  engine_rate(0.25F);
+  EXPECT_FLOAT_EQ(rate(backend), 0.25F);
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.75F), PRISM_OK);
+  engine_rate(0.125F);
+  EXPECT_FLOAT_EQ(rate(backend), 0.125F);
+}
+
+TEST_F(ParamsTest, SameValueIsSetAgain) {
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.75F), PRISM_OK);
+  engine_rate(0.5F);
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.75F), PRISM_OK);
+  EXPECT_FLOAT_EQ(rate(backend), 0.75F);
+  std::lock_guard lock(engine->mutex);
+  EXPECT_EQ(engine->rates_set, (std::vector<float>{0.75F, 0.75F}));
+}
+
+TEST_F(ParamsTest, HandlesToOneInstanceAgree) {
+  auto *other = fakes.acquire("Fake Params");
+  ASSERT_NE(other, nullptr);
+  EXPECT_FLOAT_EQ(rate(other), 0.5F);
+  ASSERT_EQ(prism_backend_set_rate(backend, 0.25F), PRISM_OK);
+  EXPECT_FLOAT_EQ(rate(other), 0.25F);
+}
+
+TEST_F(ParamsTest, SetParamsAppliesOnlyTheMask) {
+  ASSERT_EQ(prism_backend_set_params(backend,
+                                     PRISM_PARAM_VOLUME | PRISM_PARAM_RATE |
+                                         PRISM_PARAM_VOICE,
+                                     0.25F, 0.75F, 0.0F, 2),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  EXPECT_FLOAT_EQ(engine->volume, 0.25F);
+  EXPECT_FLOAT_EQ(engine->rate, 0.75F);
+  EXPECT_FLOAT_EQ(engine->pitch, 0.5F);
+  EXPECT_EQ(engine->voice, 2U);
+  EXPECT_EQ(engine->rates_set, std::vector<float>{0.75F});
+}
+
+TEST_F(ParamsTest, BadSetParamsChangesNothing) {
+  EXPECT_EQ(prism_backend_set_params(backend, 1U << 7, 0.0F, 0.0F, 0.0F, 0),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(prism_backend_set_params(backend,
+                                     PRISM_PARAM_VOLUME | PRISM_PARAM_RATE,
+                                     0.25F, 1.5F, 0.0F, 0),
+            PRISM_ERROR_RANGE_OUT_OF_BOUNDS);
+  EXPECT_EQ(prism_backend_set_params(backend, PRISM_PARAM_VOICE, 0.0F, 0.0F,
+                                     0.0F, 99),
+            PRISM_ERROR_VOICE_NOT_FOUND);
+  std::lock_guard lock(engine->mutex);
+  EXPECT_FLOAT_EQ(engine->volume, 1.0F);
+  EXPECT_TRUE(engine->rates_set.empty());
+  EXPECT_EQ(engine->voice, 0U);
+}
+} // namespace
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <system_error>
+
+namespace {
+class PhrasePackTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+  PrismPhrasePack *pack = nullptr;
+  std::filesystem::path path;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Phrases", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Phrases");
+    ASSERT_NE(backend, nullptr);
+    const auto *info = ::testing::UnitTest::GetInstance()->current_test_info();
+    path = std::filesystem::temp_directory_path() /
+           (std::string("prism_") + info->name() + ".pack");
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  void TearDown() override {
+    prism_phrase_pack_close(pack);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+  PrismError write(std::initializer_list<const char *> phrases) {
+    return prism_backend_write_phrase_pack(backend, path.string().c_str(),
+                                           phrases.begin(), phrases.size());
+  }
+
+  PrismError open() {
+    return prism_phrase_pack_open(path.string().c_str(), &pack);
+  }
+
+  bool find(const char *text, PrismPhraseAudio &audio) {
+    return prism_phrase_pack_find(pack, text, std::strlen(text), &audio);
+  }
+};
+
+TEST_F(PhrasePackTest, WrittenPhrasesAreFound) {
+  ASSERT_EQ(write({"OK", "Cancel", "Selected"}), PRISM_OK);
+  ASSERT_EQ(open(), PRISM_OK);
+  EXPECT_EQ(prism_phrase_pack_count(pack), 3U);
+  for (const char *text : {"OK", "Cancel", "Selected"}) {
+    PrismPhraseAudio audio{};
+    ASSERT_TRUE(find(text, audio)) << text;
+    EXPECT_EQ(audio.channels, 1U);
+    EXPECT_EQ(audio.sample_rate, engine->sample_rate);
+    // Leading and trailing silence are trimmed, and nothing else.
+    EXPECT_GT(audio.frames, engine->frames / 2);
+    EXPECT_LE(audio.frames, engine->frames);
+    ASSERT_NE(audio.samples, nullptr);
+  }
+  PrismPhraseAudio audio{};
+  EXPECT_FALSE(find("Help", audio));
+  // Matching is byte for byte.
+  EXPECT_FALSE(find("ok", audio));
+  EXPECT_FALSE(prism_phrase_pack_find(pack, "OK", 1, &audio));
+}
+
+TEST_F(PhrasePackTest, DuplicatesAreStoredOnce) {
+  ASSERT_EQ(write({"OK", "OK", "Cancel"}), PRISM_OK);
+  ASSERT_EQ(open(), PRISM_OK);
+  EXPECT_EQ(prism_phrase_pack_count(pack), 2U);
+  EXPECT_EQ(engine->rendered("OK"), 1U);
+}
+
+TEST_F(PhrasePackTest, PhraseWithoutAudioIsFoundEmpty) {
+  engine->frames = 0;
+  ASSERT_EQ(write({"quiet"}), PRISM_OK);
+  ASSERT_EQ(open(), PRISM_OK);
+  PrismPhraseAudio audio{};
+  ASSERT_TRUE(find("quiet", audio));
+  EXPECT_EQ(audio.frames, 0U);
+  EXPECT_EQ(audio.channels, 0U);
+  EXPECT_EQ(audio.sample_rate, 0U);
+}
+
+TEST_F(PhrasePackTest, BadPhraseLeavesThePackUntouched) {
+  ASSERT_EQ(write({"OK"}), PRISM_OK);
+  EXPECT_EQ(write({"Cancel", ""}), PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(write({"Cancel", "\xff"}), PRISM_ERROR_INVALID_UTF8);
+  ASSERT_EQ(open(), PRISM_OK);
+  EXPECT_EQ(prism_phrase_pack_count(pack), 1U);
+  PrismPhraseAudio audio{};
+  EXPECT_TRUE(find("OK", audio));
+}
+
+TEST_F(PhrasePackTest, OtherFilesAreRejected) {
+  EXPECT_EQ(open(), PRISM_ERROR_IO_FAILURE);
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not a phrase pack, just some text that is long enough";
+  }
+  EXPECT_EQ(open(), PRISM_ERROR_IO_FAILURE);
+  EXPECT_EQ(pack, nullptr);
+}
+} // namespace
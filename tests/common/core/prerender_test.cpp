@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+void PRISM_CALL count_samples(void *userdata, const float *, size_t count,
+                              size_t, size_t) {
+  *static_cast<std::size_t *>(userdata) += count;
+}
+
+class PrerenderTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void start(std::size_t audio_cache_bytes) {
+    engine = &fakes.add("Fake Prerender", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start(audio_cache_bytes));
+    backend = fakes.create("Fake Prerender");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismError prerender(const char *text) {
+    const std::array<const char *, 1> texts{text};
+    return prism_backend_prerender(backend, texts.data(), texts.size(),
+                                   PRISM_SPEECH_PRIORITY_TEXT);
+  }
+
+  std::size_t cached() {
+    PrismAudioCacheStats cache{};
+    EXPECT_EQ(prism_audio_cache_get_stats(fakes.context(), &cache), PRISM_OK);
+    return cache.entries;
+  }
+};
+
+TEST_F(PrerenderTest, NeedsTheAudioCache) {
+  start(0);
+  EXPECT_EQ(prerender("background"), PRISM_ERROR_INVALID_OPERATION);
+}
+
+TEST_F(PrerenderTest, RenderedTextIsServedFromCache) {
+  start(std::size_t{1} << 20);
+  ASSERT_EQ(prerender("background"), PRISM_OK);
+  ASSERT_TRUE(eventually([this] { return cached() == 1; }));
+  std::size_t samples = 0;
+  EXPECT_EQ(prism_backend_speak_to_memory(backend, "background", count_samples,
+                                          &samples),
+            PRISM_OK);
+  EXPECT_GT(samples, 0U);
+  EXPECT_EQ(engine->rendered("background"), 1U);
+}
+
+TEST_F(PrerenderTest, SpeechAbortsPrerendering) {
+  start(std::size_t{1} << 20);
+  engine->chunk_delay = std::chrono::milliseconds(20);
+  ASSERT_EQ(prerender("background"), PRISM_OK);
+  ASSERT_TRUE(engine->wait_until(
+      [this] { return engine->renders["background"] == 1; }));
+  EXPECT_EQ(prism_backend_speak(backend, "now", false), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"now"});
+  // The aborted render was not cached, so it is rendered again once the
+  // backend is quiet.
+  ASSERT_TRUE(engine->wait_until(
+      [this] { return engine->renders["background"] == 2; }));
+  ASSERT_TRUE(eventually([this] { return cached() == 1; }));
+}
+} // namespace
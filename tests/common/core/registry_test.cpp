@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+std::size_t builtin_count() {
+  auto cfg = prism_config_init();
+  auto *ctx = prism_init(&cfg);
+  if (ctx == nullptr)
+    return 0;
+  const auto count = prism_registry_count(ctx);
+  prism_shutdown(ctx);
+  return count;
+}
+
+std::size_t position_of(PrismContext *ctx, PrismBackendId id) {
+  const auto count = prism_registry_count(ctx);
+  for (std::size_t i = 0; i < count; ++i)
+    if (prism_registry_id_at(ctx, i) == id)
+      return i;
+  return count;
+}
+
+TEST(RegistryTest, NamesAndIdsRoundTrip) {
+  FakeRegistry fakes;
+  PrismBackendId low = PRISM_BACKEND_INVALID;
+  PrismBackendId high = PRISM_BACKEND_INVALID;
+  PrismBackendId middle = PRISM_BACKEND_INVALID;
+  (void)fakes.add("Fake Low", 5, false, &low);
+  (void)fakes.add("Fake High", 500, false, &high);
+  (void)fakes.add("Fake Middle", 50, false, &middle);
+  ASSERT_EQ(fakes.error(), PRISM_OK);
+  ASSERT_TRUE(fakes.start());
+  auto *ctx = fakes.context();
+  EXPECT_EQ(prism_registry_count(ctx), builtin_count() + 3);
+  for (const auto &[name, id, priority] :
+       {std::tuple{"Fake Low", low, 5}, std::tuple{"Fake High", high, 500},
+        std::tuple{"Fake Middle", middle, 50}}) {
+    EXPECT_NE(id, PRISM_BACKEND_INVALID);
+    EXPECT_EQ(prism_registry_id(ctx, name), id);
+    EXPECT_STREQ(prism_registry_name(ctx, id), name);
+    EXPECT_EQ(prism_registry_priority(ctx, id), priority);
+    EXPECT_TRUE(prism_registry_exists(ctx, id));
+  }
+  EXPECT_LT(position_of(ctx, high), position_of(ctx, middle));
+  EXPECT_LT(position_of(ctx, middle), position_of(ctx, low));
+}
+
+TEST(RegistryTest, UnknownKeysMiss) {
+  FakeRegistry fakes;
+  PrismBackendId id = PRISM_BACKEND_INVALID;
+  (void)fakes.add("Fake Known", 5, false, &id);
+  ASSERT_EQ(fakes.error(), PRISM_OK);
+  ASSERT_TRUE(fakes.start());
+  auto *ctx = fakes.context();
+  EXPECT_EQ(prism_registry_id(ctx, "Fake Unknown"), PRISM_BACKEND_INVALID);
+  EXPECT_EQ(prism_registry_id(ctx, "fake known"), PRISM_BACKEND_INVALID);
+  EXPECT_EQ(prism_registry_id(ctx, ""), PRISM_BACKEND_INVALID);
+  EXPECT_FALSE(prism_registry_exists(ctx, id + 1));
+  EXPECT_FALSE(prism_registry_exists(ctx, PRISM_BACKEND_INVALID));
+  EXPECT_EQ(prism_registry_name(ctx, id + 1), nullptr);
+  EXPECT_EQ(prism_registry_id_at(ctx, prism_registry_count(ctx)),
+            PRISM_BACKEND_INVALID);
+}
+
+TEST(RegistryTest, EveryEntryOfALargeRegistryIsFound) {
+  FakeRegistry fakes;
+  std::vector<std::string> names;
+  std::vector<PrismBackendId> ids;
+  for (int i = 0; i < 200; ++i) {
+    names.push_back("Fake " + std::to_string(i));
+    (void)fakes.add(names.back().c_str(), i, false, &ids.emplace_back());
+  }
+  ASSERT_EQ(fakes.error(), PRISM_OK);
+  ASSERT_TRUE(fakes.start());
+  auto *ctx = fakes.context();
+  std::set<PrismBackendId> seen;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    EXPECT_EQ(prism_registry_id(ctx, names[i].c_str()), ids[i]) << names[i];
+    EXPECT_STREQ(prism_registry_name(ctx, ids[i]), names[i].c_str());
+    EXPECT_EQ(prism_registry_priority(ctx, ids[i]), static_cast<int>(i));
+    seen.insert(ids[i]);
+  }
+  EXPECT_EQ(seen.size(), names.size());
+}
+
+TEST(RegistryTest, DuplicateNameIsRejected) {
+  FakeRegistry fakes;
+  (void)fakes.add("Fake Twin", 5);
+  ASSERT_EQ(fakes.error(), PRISM_OK);
+  (void)fakes.add("Fake Twin", 6);
+  EXPECT_EQ(fakes.error(), PRISM_ERROR_INVALID_OPERATION);
+}
+
+TEST(RegistryTest, AcquireSharesOneInstance) {
+  FakeRegistry fakes;
+  (void)fakes.add("Fake Shared", 5);
+  ASSERT_EQ(fakes.error(), PRISM_OK);
+  ASSERT_TRUE(fakes.start());
+  auto *first = fakes.acquire("Fake Shared");
+  auto *second = fakes.acquire("Fake Shared");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  const auto id = prism_registry_id(fakes.context(), "Fake Shared");
+  auto *cached = prism_registry_get(fakes.context(), id);
+  ASSERT_NE(cached, nullptr);
+  EXPECT_STREQ(prism_backend_name(cached), "Fake Shared");
+  prism_backend_free(cached);
+}
+} // namespace
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Texts = std::vector<std::string>;
+
+constexpr auto article =
+    "One. Two is here. Three is also here. Four is the last one.";
+
+struct Render {
+  std::size_t samples = 0;
+  PrismCancelToken *cancel = nullptr;
+};
+
+void PRISM_CALL count_audio(void *userdata, const float *, size_t count,
+                            size_t, size_t) {
+  auto &out = *static_cast<Render *>(userdata);
+  out.samples += count;
+  if (out.cancel != nullptr)
+    prism_cancel_token_cancel(out.cancel);
+}
+
+class SegmentationTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Segments", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Segments");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  // Speaks `text` and waits for all of its segments to reach the engine.
+  Texts segments(const char *text, std::size_t count) {
+    EXPECT_EQ(prism_backend_speak(backend, text, false), PRISM_OK);
+    EXPECT_TRUE(engine->wait_until(
+        [this, count] { return engine->calls.size() >= count; }));
+    return engine->spoken();
+  }
+};
+
+TEST_F(SegmentationTest, OffByDefault) {
+  EXPECT_EQ(segments(article, 1), Texts{article});
+}
+
+TEST_F(SegmentationTest, ShortTextIsSpokenWhole) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 100), PRISM_OK);
+  EXPECT_EQ(segments(article, 1), Texts{article});
+}
+
+TEST_F(SegmentationTest, FirstSentenceGoesAlone) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 40), PRISM_OK);
+  EXPECT_EQ(segments(article, 3),
+            (Texts{"One.", "Two is here. Three is also here.",
+                   "Four is the last one."}));
+}
+
+TEST_F(SegmentationTest, LongSentenceIsCutAtAClause) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 20), PRISM_OK);
+  EXPECT_EQ(segments("Apples, pears and plums, then grapes.", 3),
+            (Texts{"Apples,", "pears and plums,", "then grapes."}));
+}
+
+TEST_F(SegmentationTest, WordsAreCutOnlyBetweenCharacters) {
+  // Two three-byte euro signs do not fit in four bytes.
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 4), PRISM_OK);
+  EXPECT_EQ(segments("\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac", 3),
+            (Texts{"\xe2\x82\xac", "\xe2\x82\xac", "\xe2\x82\xac"}));
+}
+
+TEST_F(SegmentationTest, OnlyTheFirstSegmentInterrupts) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 40), PRISM_OK);
+  ASSERT_EQ(prism_backend_speak(backend, article, true), PRISM_OK);
+  ASSERT_TRUE(engine->wait_until([this] { return engine->calls.size() == 3; }));
+  std::lock_guard lock(engine->mutex);
+  EXPECT_TRUE(engine->calls[0].interrupt);
+  EXPECT_FALSE(engine->calls[1].interrupt);
+  EXPECT_FALSE(engine->calls[2].interrupt);
+}
+
+TEST_F(SegmentationTest, StopDropsTheRest) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 40), PRISM_OK);
+  {
+    std::lock_guard lock(engine->mutex);
+    engine->hold = true;
+    engine->held_text = "Two is here. Three is also here.";
+  }
+  ASSERT_EQ(prism_backend_speak(backend, article, false), PRISM_OK);
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 2; }));
+  std::thread release([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    engine->release();
+  });
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  release.join();
+  EXPECT_EQ(prism_backend_speak(backend, "Next.", false), PRISM_OK);
+  EXPECT_EQ(engine->spoken(),
+            (Texts{"One.", "Two is here. Three is also here.", "Next."}));
+}
+
+TEST_F(SegmentationTest, MemoryIsRenderedASegmentAtATime) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 40), PRISM_OK);
+  Render out;
+  ASSERT_EQ(prism_backend_speak_to_memory(backend, article, count_audio, &out),
+            PRISM_OK);
+  EXPECT_EQ(out.samples, 3 * engine->frames);
+  EXPECT_EQ(engine->rendered("One."), 1U);
+  EXPECT_EQ(engine->rendered("Two is here. Three is also here."), 1U);
+  EXPECT_EQ(engine->rendered("Four is the last one."), 1U);
+}
+
+TEST_F(SegmentationTest, CancelledRenderStopsAtASegment) {
+  ASSERT_EQ(prism_backend_set_segmentation(backend, 40), PRISM_OK);
+  auto *token = prism_cancel_token_new();
+  ASSERT_NE(token, nullptr);
+  PrismMemoryOptions opts{};
+  opts.size = sizeof(opts);
+  opts.sample_format = PRISM_SAMPLE_FORMAT_F32;
+  opts.cancel = token;
+  Render out{.samples = 0, .cancel = token};
+  EXPECT_EQ(prism_backend_speak_to_memory_ex(backend, article,
+                                             std::strlen(article), count_audio,
+                                             &out, PRISM_TEXT_DEFAULT, &opts),
+            PRISM_ERROR_CANCELLED);
+  prism_cancel_token_free(token);
+  EXPECT_EQ(engine->rendered("One."), 1U);
+  EXPECT_EQ(engine->rendered("Four is the last one."), 0U);
+}
+} // namespace
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// Completions as the worker reports them.
+struct Completions {
+  std::mutex mutex;
+  std::map<PrismUtteranceId, std::vector<PrismError>> results;
+
+  std::vector<PrismError> of(PrismUtteranceId id) {
+    std::scoped_lock lock(mutex);
+    return results[id];
+  }
+};
+
+void PRISM_CALL record(void *userdata, PrismUtteranceId id, PrismError error) {
+  auto &done = *static_cast<Completions *>(userdata);
+  std::scoped_lock lock(done.mutex);
+  done.results[id].push_back(error);
+}
+
+class SpeakAsyncTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+  Completions done;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Async", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Async");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismUtteranceId submit(PrismBackend *target, const char *text) {
+    PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+    EXPECT_EQ(prism_backend_speak_async(target, text, std::strlen(text), false,
+                                        PRISM_TEXT_DEFAULT, record, &done,
+                                        &id),
+              PRISM_OK);
+    EXPECT_NE(id, PRISM_UTTERANCE_INVALID);
+    return id;
+  }
+
+  PrismUtteranceId submit(const char *text) { return submit(backend, text); }
+
+  void hold(const char *text) {
+    std::lock_guard lock(engine->mutex);
+    engine->hold = true;
+    engine->held_text = text;
+  }
+};
+
+TEST_F(SpeakAsyncTest, EachUtteranceCompletesOnce) {
+  const auto one = submit("one");
+  const auto two = submit("two");
+  EXPECT_NE(one, two);
+  EXPECT_EQ(prism_backend_wait(backend, two), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, one), PRISM_OK);
+  EXPECT_EQ(done.of(one), std::vector<PrismError>{PRISM_OK});
+  EXPECT_EQ(done.of(two), std::vector<PrismError>{PRISM_OK});
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "two"}));
+}
+
+TEST_F(SpeakAsyncTest, BackendErrorIsReported) {
+  engine->speak_result = PRISM_ERROR_SPEAK_FAILURE;
+  const auto id = submit("one");
+  EXPECT_EQ(prism_backend_wait(backend, id), PRISM_ERROR_SPEAK_FAILURE);
+  EXPECT_EQ(done.of(id), std::vector<PrismError>{PRISM_ERROR_SPEAK_FAILURE});
+}
+
+TEST_F(SpeakAsyncTest, SynchronousSpeechWaitsItsTurn) {
+  (void)submit("one");
+  (void)submit("two");
+  ASSERT_EQ(prism_backend_speak(backend, "three", false), PRISM_OK);
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{"one", "two", "three"}));
+}
+
+TEST_F(SpeakAsyncTest, StopCancelsQueuedUtterances) {
+  hold("one");
+  const auto one = submit("one");
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 1; }));
+  const auto two = submit("two");
+  bool speaking = false;
+  ASSERT_EQ(prism_backend_is_speaking(backend, &speaking), PRISM_OK);
+  EXPECT_TRUE(speaking);
+  std::thread release([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    engine->release();
+  });
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  release.join();
+  EXPECT_EQ(prism_backend_wait(backend, one), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, two), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(done.of(two), std::vector<PrismError>{PRISM_ERROR_CANCELLED});
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"one"});
+}
+
+TEST_F(SpeakAsyncTest, FreeReportsQueuedUtterances) {
+  auto *own = prism_registry_create(
+      fakes.context(), prism_registry_id(fakes.context(), "Fake Async"));
+  ASSERT_NE(own, nullptr);
+  ASSERT_EQ(prism_backend_initialize(own), PRISM_OK);
+  hold("one");
+  const auto one = submit(own, "one");
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 1; }));
+  const auto two = submit(own, "two");
+  std::thread release([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    engine->release();
+  });
+  prism_backend_free(own);
+  release.join();
+  EXPECT_EQ(done.of(one), std::vector<PrismError>{PRISM_OK});
+  EXPECT_EQ(done.of(two), std::vector<PrismError>{PRISM_ERROR_CANCELLED});
+}
+
+TEST_F(SpeakAsyncTest, WaitRejectsForeignIds) {
+  EXPECT_EQ(prism_backend_wait(backend, 1), PRISM_ERROR_INVALID_PARAM);
+  const auto id = submit("one");
+  EXPECT_EQ(prism_backend_wait(backend, id + 100), PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(prism_backend_wait(backend, id), PRISM_OK);
+}
+} // namespace
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace {
+struct Item {
+  const char *text;
+  bool interrupt;
+};
+
+class SpeakBatchTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Batch", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Batch");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismError speak(std::initializer_list<Item> items) {
+    std::vector<PrismUtterance> batch;
+    for (const auto &item : items)
+      batch.push_back({.text = item.text,
+                       .length = std::strlen(item.text),
+                       .flags = PRISM_TEXT_DEFAULT,
+                       .interrupt = item.interrupt});
+    return prism_backend_speak_batch(backend, batch.data(), batch.size());
+  }
+};
+
+TEST_F(SpeakBatchTest, BatchReachesBackendWhole) {
+  ASSERT_EQ(speak({{"one", false}, {"two", false}, {"three", false}}),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  EXPECT_EQ(engine->batches, 1U);
+  ASSERT_EQ(engine->calls.size(), 3U);
+  EXPECT_EQ(engine->calls[0].op, "batch");
+  EXPECT_EQ(engine->calls[2].text, "three");
+}
+
+TEST_F(SpeakBatchTest, BatchStaysWholeOnceHandleHasWorker) {
+  PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+  ASSERT_EQ(prism_backend_speak_async(backend, "first", 5, false,
+                                      PRISM_TEXT_DEFAULT, nullptr, nullptr,
+                                      &id),
+            PRISM_OK);
+  ASSERT_EQ(speak({{"one", false}, {"two", false}}), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  EXPECT_EQ(engine->batches, 1U);
+  ASSERT_EQ(engine->calls.size(), 3U);
+  EXPECT_EQ(engine->calls[0].text, "first");
+  EXPECT_EQ(engine->calls[1].op, "batch");
+  EXPECT_EQ(engine->calls[1].text, "one");
+  EXPECT_EQ(engine->calls[2].text, "two");
+}
+
+TEST_F(SpeakBatchTest, ItemsBeforeLastInterruptAreDropped) {
+  ASSERT_EQ(speak({{"one", false}, {"two", true}, {"three", false}}),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_EQ(engine->calls[0].text, "two");
+  EXPECT_TRUE(engine->calls[0].interrupt);
+  EXPECT_EQ(engine->calls[1].text, "three");
+  EXPECT_FALSE(engine->calls[1].interrupt);
+}
+
+TEST_F(SpeakBatchTest, InvalidItemSpeaksNothing) {
+  EXPECT_EQ(speak({{"one", false}, {"t\xffo", false}}),
+            PRISM_ERROR_INVALID_UTF8);
+  EXPECT_TRUE(engine->spoken().empty());
+  // Before the last interrupt it is never looked at.
+  EXPECT_EQ(speak({{"t\xffo", false}, {"one", true}}), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"one"});
+}
+
+TEST_F(SpeakBatchTest, FilteredItemIsLeftOut) {
+  ASSERT_EQ(prism_backend_set_text_filters(
+                backend, PRISM_TEXT_FILTER_STRIP_TAGS |
+                             PRISM_TEXT_FILTER_DROP_EMPTY),
+            PRISM_OK);
+  ASSERT_EQ(speak({{"<b>one</b>", false}, {"<br/>", false}, {"two", false}}),
+            PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "two"}));
+}
+
+TEST_F(SpeakBatchTest, EmptyBatchIsAccepted) {
+  EXPECT_EQ(prism_backend_speak_batch(backend, nullptr, 0), PRISM_OK);
+  EXPECT_TRUE(engine->spoken().empty());
+}
+} // namespace
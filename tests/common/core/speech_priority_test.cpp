@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+class SpeechPriorityTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Priority", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Priority");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismUtteranceId submit(const char *text, PrismSpeechPriority priority) {
+    PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+    EXPECT_EQ(prism_backend_speak_prioritized(
+                  backend, text, std::strlen(text), priority,
+                  PRISM_TEXT_DEFAULT, nullptr, nullptr, &id),
+              PRISM_OK);
+    return id;
+  }
+
+  void hold(const char *text) {
+    std::lock_guard lock(engine->mutex);
+    engine->hold = true;
+    engine->held_text = text;
+  }
+};
+
+TEST_F(SpeechPriorityTest, HigherClassesDropQueuedLowerClasses) {
+  hold("first");
+  const auto first = submit("first", PRISM_SPEECH_PRIORITY_IMPORTANT);
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 1; }));
+  const auto text = submit("text", PRISM_SPEECH_PRIORITY_TEXT);
+  // Chatter is pointless while speech is playing or queued.
+  const auto note = submit("note", PRISM_SPEECH_PRIORITY_NOTIFICATION);
+  const auto message = submit("message", PRISM_SPEECH_PRIORITY_MESSAGE);
+  engine->release();
+  EXPECT_EQ(prism_backend_wait(backend, first), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, text), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(prism_backend_wait(backend, note), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(prism_backend_wait(backend, message), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_EQ(engine->calls[0].text, "first");
+  EXPECT_EQ(engine->calls[1].text, "message");
+  // Important speech is never cut off by a lower class.
+  EXPECT_FALSE(engine->calls[1].interrupt);
+}
+
+TEST_F(SpeechPriorityTest, HigherClassInterruptsLowerClass) {
+  EXPECT_EQ(prism_backend_wait(backend,
+                               submit("reading", PRISM_SPEECH_PRIORITY_TEXT)),
+            PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend,
+                               submit("alert", PRISM_SPEECH_PRIORITY_MESSAGE)),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_FALSE(engine->calls[0].interrupt);
+  EXPECT_TRUE(engine->calls[1].interrupt);
+}
+
+TEST_F(SpeechPriorityTest, ImportantIsQueuedBehindImportant) {
+  hold("first");
+  const auto first = submit("first", PRISM_SPEECH_PRIORITY_IMPORTANT);
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 1; }));
+  const auto second = submit("second", PRISM_SPEECH_PRIORITY_IMPORTANT);
+  engine->release();
+  EXPECT_EQ(prism_backend_wait(backend, first), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, second), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_FALSE(engine->calls[1].interrupt);
+}
+
+TEST_F(SpeechPriorityTest, NotificationPlaysWhenIdle) {
+  const auto note = submit("note", PRISM_SPEECH_PRIORITY_NOTIFICATION);
+  EXPECT_EQ(prism_backend_wait(backend, note), PRISM_OK);
+  // A newer notification replaces one still waiting.
+  hold("progress");
+  const auto progress = submit("progress", PRISM_SPEECH_PRIORITY_PROGRESS);
+  ASSERT_TRUE(engine->wait_until([this] { return engine->entered == 2; }));
+  const auto older = submit("older", PRISM_SPEECH_PRIORITY_NOTIFICATION);
+  const auto newer = submit("newer", PRISM_SPEECH_PRIORITY_NOTIFICATION);
+  engine->release();
+  EXPECT_EQ(prism_backend_wait(backend, progress), PRISM_OK);
+  EXPECT_EQ(prism_backend_wait(backend, older), PRISM_ERROR_CANCELLED);
+  EXPECT_EQ(prism_backend_wait(backend, newer), PRISM_OK);
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{"note", "progress", "newer"}));
+}
+
+TEST_F(SpeechPriorityTest, UnknownClassIsRejected) {
+  PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+  EXPECT_EQ(prism_backend_speak_prioritized(
+                backend, "x", 1, PRISM_SPEECH_PRIORITY_COUNT,
+                PRISM_TEXT_DEFAULT, nullptr, nullptr, &id),
+            PRISM_ERROR_INVALID_PARAM);
+}
+} // namespace
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+class SsmlTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void start(bool native, bool paced = true) {
+    engine = paced ? &fakes.add("Fake SSML", 100, native)
+                   : &fakes.add_unpaced("Fake SSML", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake SSML");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismError speak(std::string_view ssml) {
+    return prism_backend_speak_ssml(backend, ssml.data(), ssml.size(), false,
+                                    PRISM_TEXT_DEFAULT);
+  }
+
+  // Waits for the worker to finish whatever is still playing.
+  void drain() {
+    PrismUtteranceId id = PRISM_UTTERANCE_INVALID;
+    ASSERT_EQ(prism_backend_speak_async(backend, "done", 4, false,
+                                        PRISM_TEXT_DEFAULT, nullptr, nullptr,
+                                        &id),
+              PRISM_OK);
+    ASSERT_EQ(prism_backend_wait(backend, id), PRISM_OK);
+  }
+};
+
+TEST_F(SsmlTest, NativeBackendReceivesDocument) {
+  start(true);
+  constexpr std::string_view doc =
+      R"(<speak>Hello <break time="1s"/> world</speak>)";
+  ASSERT_EQ(speak(doc), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 1U);
+  EXPECT_EQ(engine->calls[0].op, "ssml");
+  EXPECT_EQ(engine->calls[0].text, doc);
+}
+
+TEST_F(SsmlTest, MarkupIsReducedToText) {
+  start(false);
+  ASSERT_EQ(speak("<speak>Fish &amp; chips<desc>ignored</desc> "
+                  R"(<sub alias="World Wide Web">WWW</sub>.</speak>)"),
+            PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{
+                                  "Fish & chips World Wide Web.", "done"}));
+}
+
+TEST_F(SsmlTest, UnclosedTagIsRejected) {
+  start(false);
+  EXPECT_EQ(speak("<speak>Hello <break"), PRISM_ERROR_INVALID_PARAM);
+  drain();
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"done"});
+}
+
+TEST_F(SsmlTest, ProsodyIsAppliedAndRestored) {
+  start(false);
+  ASSERT_EQ(speak(R"(<speak>slow <prosody rate="x-fast">fast</prosody> )"
+                  "slow</speak>"),
+            PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{"slow", "fast", "slow", "done"}));
+  std::lock_guard lock(engine->mutex);
+  EXPECT_EQ(engine->rates_set, (std::vector<float>{0.9F, 0.5F}));
+  EXPECT_FLOAT_EQ(engine->rate, 0.5F);
+}
+
+TEST_F(SsmlTest, BackendThatCannotPaceHearsTheTextWhole) {
+  start(false, false);
+  ASSERT_EQ(speak(R"(<speak>slow <prosody rate="x-fast">fast</prosody>)"
+                  R"(<break time="5s"/> slow</speak>)"),
+            PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{"slow fast slow", "done"}));
+  std::lock_guard lock(engine->mutex);
+  EXPECT_TRUE(engine->rates_set.empty());
+}
+
+TEST_F(SsmlTest, ReturnsOnceFirstPartIsSpoken) {
+  start(false);
+  const auto before = std::chrono::steady_clock::now();
+  ASSERT_EQ(speak(R"(<speak>one<break time="5s"/>two</speak>)"), PRISM_OK);
+  EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::seconds(2));
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"one"});
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "done"}));
+}
+
+TEST_F(SsmlTest, StopRestoresParameters) {
+  start(false);
+  ASSERT_EQ(speak(R"(<speak><prosody rate="x-slow">one<break time="5s"/>)"
+                  "two</prosody></speak>"),
+            PRISM_OK);
+  EXPECT_EQ(prism_backend_stop(backend), PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(), (std::vector<std::string>{"one", "done"}));
+  std::lock_guard lock(engine->mutex);
+  EXPECT_EQ(engine->rates_set, (std::vector<float>{0.1F, 0.5F}));
+}
+
+TEST_F(SsmlTest, InterruptingSpeechCutsDocumentShort) {
+  start(false);
+  ASSERT_EQ(speak(R"(<speak>one<break time="5s"/>two</speak>)"), PRISM_OK);
+  EXPECT_EQ(prism_backend_speak(backend, "urgent", true), PRISM_OK);
+  drain();
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{"one", "urgent", "done"}));
+}
+} // namespace
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+using Texts = std::vector<std::string>;
+
+class TextFeedTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Feed", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Feed");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  PrismError append(const char *text) {
+    return prism_backend_feed_append(backend, text, std::strlen(text));
+  }
+
+  bool spoken(std::size_t count) {
+    return engine->wait_until([this, count] {
+      return engine->calls.size() == count;
+    });
+  }
+};
+
+TEST_F(TextFeedTest, UnitsAreSpokenAsTheyComplete) {
+  ASSERT_EQ(prism_backend_feed_open(backend, false), PRISM_OK);
+  ASSERT_EQ(append("Hello, wor"), PRISM_OK);
+  ASSERT_TRUE(spoken(1));
+  ASSERT_EQ(append("ld. How are"), PRISM_OK);
+  ASSERT_TRUE(spoken(2));
+  ASSERT_EQ(append(" you?"), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (Texts{"Hello,", "world."}));
+  ASSERT_EQ(prism_backend_feed_close(backend), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (Texts{"Hello,", "world.", "How are you?"}));
+}
+
+TEST_F(TextFeedTest, PiecesMaySplitAnything) {
+  constexpr char text[] = "Caf\xc3\xa9, please. Pi is 3.14 or so.";
+  ASSERT_EQ(prism_backend_feed_open(backend, false), PRISM_OK);
+  for (std::size_t i = 0; i + 1 < sizeof(text); ++i)
+    ASSERT_EQ(prism_backend_feed_append(backend, text + i, 1), PRISM_OK);
+  ASSERT_EQ(prism_backend_feed_close(backend), PRISM_OK);
+  EXPECT_EQ(engine->spoken(),
+            (Texts{"Caf\xc3\xa9,", "please.", "Pi is 3.14 or so."}));
+}
+
+TEST_F(TextFeedTest, OnlyTheFirstUnitInterrupts) {
+  ASSERT_EQ(prism_backend_feed_open(backend, true), PRISM_OK);
+  ASSERT_EQ(append("One. Two. "), PRISM_OK);
+  ASSERT_EQ(prism_backend_feed_close(backend), PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_TRUE(engine->calls[0].interrupt);
+  EXPECT_FALSE(engine->calls[1].interrupt);
+}
+
+TEST_F(TextFeedTest, StopDiscardsHeldText) {
+  ASSERT_EQ(prism_backend_feed_open(backend, false), PRISM_OK);
+  ASSERT_EQ(append("held back"), PRISM_OK);
+  ASSERT_EQ(prism_backend_stop(backend), PRISM_OK);
+  ASSERT_EQ(append("Fresh start"), PRISM_OK);
+  ASSERT_EQ(prism_backend_feed_close(backend), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), Texts{"Fresh start"});
+}
+
+TEST_F(TextFeedTest, FeedMustBeOpen) {
+  EXPECT_EQ(append("text"), PRISM_ERROR_INVALID_OPERATION);
+  EXPECT_EQ(prism_backend_feed_close(backend), PRISM_ERROR_INVALID_OPERATION);
+  ASSERT_EQ(prism_backend_feed_open(backend, false), PRISM_OK);
+  ASSERT_EQ(prism_backend_feed_close(backend), PRISM_OK);
+  EXPECT_EQ(prism_backend_feed_close(backend), PRISM_ERROR_INVALID_OPERATION);
+  EXPECT_TRUE(engine->spoken().empty());
+}
+
+TEST_F(TextFeedTest, BadUtf8IsRejected) {
+  ASSERT_EQ(prism_backend_feed_open(backend, false), PRISM_OK);
+  EXPECT_EQ(append("ok \xff"), PRISM_ERROR_INVALID_UTF8);
+  ASSERT_EQ(append("fine"), PRISM_OK);
+  EXPECT_EQ(append("\xc3"), PRISM_OK);
+  EXPECT_EQ(prism_backend_feed_close(backend), PRISM_ERROR_INVALID_UTF8);
+  // The feed is closed regardless.
+  EXPECT_EQ(append("more"), PRISM_ERROR_INVALID_OPERATION);
+}
+} // namespace
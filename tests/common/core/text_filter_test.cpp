@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+void PRISM_CALL ignore_audio(void *, const float *, size_t, size_t, size_t) {}
+
+class TextFilterTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Filters", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Filters");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  // What the engine was given for `text`, or nothing if it was skipped.
+  std::vector<std::string> filtered(const char *text) {
+    const auto before = engine->spoken().size();
+    EXPECT_EQ(prism_backend_speak(backend, text, false), PRISM_OK);
+    auto texts = engine->spoken();
+    texts.erase(texts.begin(),
+                texts.begin() + static_cast<std::ptrdiff_t>(before));
+    return texts;
+  }
+};
+
+using Texts = std::vector<std::string>;
+
+TEST_F(TextFilterTest, OffByDefault) {
+  EXPECT_EQ(filtered("<b>a</b>  \x01"), Texts{"<b>a</b>  \x01"});
+}
+
+TEST_F(TextFilterTest, TagsAreStrippedAndEntitiesDecoded) {
+  ASSERT_EQ(
+      prism_backend_set_text_filters(backend, PRISM_TEXT_FILTER_STRIP_TAGS),
+      PRISM_OK);
+  EXPECT_EQ(filtered("<b>Tom</b> &amp; Jerry"), Texts{"Tom & Jerry"});
+  EXPECT_EQ(filtered("&lt;&#65;&#x42;&gt;"), Texts{"<AB>"});
+  EXPECT_EQ(filtered("a<!-- note -->b"), Texts{"ab"});
+  // Not tags at all.
+  EXPECT_EQ(filtered("1 < 2 and 3 <4"), Texts{"1 < 2 and 3 <4"});
+  EXPECT_EQ(filtered("&bogus; &#0;"), Texts{"&bogus; &#0;"});
+}
+
+TEST_F(TextFilterTest, BlockTagsSeparateWords) {
+  ASSERT_EQ(prism_backend_set_text_filters(
+                backend, PRISM_TEXT_FILTER_STRIP_TAGS |
+                             PRISM_TEXT_FILTER_COLLAPSE_WHITESPACE),
+            PRISM_OK);
+  EXPECT_EQ(filtered("<p>one</p><p>two</p>"), Texts{"one two"});
+  EXPECT_EQ(filtered("line<br>break"), Texts{"line break"});
+}
+
+TEST_F(TextFilterTest, WhitespaceIsCollapsedAndTrimmed) {
+  ASSERT_EQ(prism_backend_set_text_filters(
+                backend, PRISM_TEXT_FILTER_COLLAPSE_WHITESPACE),
+            PRISM_OK);
+  EXPECT_EQ(filtered("  a \t\r\n b\xc2\xa0\xc2\xa0"
+                     "c  "),
+            Texts{"a b c"});
+}
+
+TEST_F(TextFilterTest, ControlCharactersAreRemoved) {
+  ASSERT_EQ(
+      prism_backend_set_text_filters(backend, PRISM_TEXT_FILTER_STRIP_CONTROL),
+      PRISM_OK);
+  EXPECT_EQ(filtered("a\x01"
+                     "b\x7f"
+                     "c\xc2\x85"
+                     "d\te"),
+            Texts{"abcd\te"});
+}
+
+TEST_F(TextFilterTest, EmptyTextIsSkipped) {
+  ASSERT_EQ(prism_backend_set_text_filters(
+                backend, PRISM_TEXT_FILTER_STRIP_TAGS |
+                             PRISM_TEXT_FILTER_DROP_EMPTY),
+            PRISM_OK);
+  EXPECT_EQ(filtered("<br/> ... "), Texts{});
+  EXPECT_EQ(filtered("\xc3\xa9"), Texts{"\xc3\xa9"});
+  PrismUtteranceId id = 1;
+  ASSERT_EQ(prism_backend_speak_async(backend, "<p></p>", 7, true,
+                                      PRISM_TEXT_DEFAULT, nullptr, nullptr,
+                                      &id),
+            PRISM_OK);
+  EXPECT_EQ(id, PRISM_UTTERANCE_INVALID);
+  const PrismUtterance batch[] = {
+      {.text = "one", .length = 3, .flags = PRISM_TEXT_DEFAULT,
+       .interrupt = false},
+      {.text = "<i></i>", .length = 7, .flags = PRISM_TEXT_DEFAULT,
+       .interrupt = false},
+      {.text = "two", .length = 3, .flags = PRISM_TEXT_DEFAULT,
+       .interrupt = false},
+  };
+  ASSERT_EQ(prism_backend_speak_batch(backend, batch, 3), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), (Texts{"\xc3\xa9", "one", "two"}));
+}
+
+TEST_F(TextFilterTest, AppliesToOutputAndMemory) {
+  ASSERT_EQ(
+      prism_backend_set_text_filters(backend, PRISM_TEXT_FILTER_STRIP_TAGS),
+      PRISM_OK);
+  ASSERT_EQ(prism_backend_output(backend, "<b>out</b>", false), PRISM_OK);
+  EXPECT_EQ(engine->spoken(), Texts{"out"});
+  ASSERT_EQ(prism_backend_speak_to_memory(backend, "<b>mem</b>", ignore_audio,
+                                          nullptr),
+            PRISM_OK);
+  EXPECT_EQ(engine->rendered("mem"), 1U);
+}
+
+TEST_F(TextFilterTest, UnknownFlagIsRejected) {
+  EXPECT_EQ(prism_backend_set_text_filters(backend, 1U << 9),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(filtered("<b>a</b>"), Texts{"<b>a</b>"});
+}
+} // namespace
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+void PRISM_CALL ignore_samples(void *, const float *, size_t, size_t, size_t) {
+}
+
+class TextSliceTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Slices", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Slices");
+    ASSERT_NE(backend, nullptr);
+  }
+};
+
+// The caller's buffer goes on past the slice with no NUL after it.
+constexpr std::string_view buffer = "hello world";
+
+TEST_F(TextSliceTest, SpeakSeesOnlyTheSlice) {
+  ASSERT_EQ(prism_backend_speak_n(backend, buffer.data(), 5, true,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 1U);
+  EXPECT_EQ(engine->calls[0].op, "speak");
+  EXPECT_EQ(engine->calls[0].text, "hello");
+  EXPECT_TRUE(engine->calls[0].interrupt);
+}
+
+TEST_F(TextSliceTest, OutputAndBrailleSeeOnlyTheSlice) {
+  ASSERT_EQ(prism_backend_output_n(backend, buffer.data() + 6, 3, false,
+                                   PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  ASSERT_EQ(prism_backend_braille_n(backend, buffer.data(), 4,
+                                    PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  std::lock_guard lock(engine->mutex);
+  ASSERT_EQ(engine->calls.size(), 2U);
+  EXPECT_EQ(engine->calls[0].op, "output");
+  EXPECT_EQ(engine->calls[0].text, "wor");
+  EXPECT_EQ(engine->calls[1].op, "braille");
+  EXPECT_EQ(engine->calls[1].text, "hell");
+}
+
+TEST_F(TextSliceTest, TerminatedTextIsPassedWhole) {
+  ASSERT_EQ(prism_backend_speak_n(backend, buffer.data(), buffer.size(), false,
+                                  PRISM_TEXT_NUL_TERMINATED),
+            PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{std::string{buffer}});
+}
+
+TEST_F(TextSliceTest, MemorySynthesisSeesOnlyTheSlice) {
+  ASSERT_EQ(prism_backend_speak_to_memory_n(backend, buffer.data(), 5,
+                                            ignore_samples, nullptr,
+                                            PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  EXPECT_EQ(engine->rendered("hello"), 1U);
+  EXPECT_EQ(engine->rendered(buffer), 0U);
+}
+
+TEST_F(TextSliceTest, ShorterSliceAfterLongerOneIsNotPadded) {
+  ASSERT_EQ(prism_backend_speak_n(backend, buffer.data(), buffer.size(), false,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  ASSERT_EQ(prism_backend_speak_n(backend, buffer.data(), 2, false,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  EXPECT_EQ(engine->spoken(),
+            (std::vector<std::string>{std::string{buffer}, "he"}));
+}
+
+TEST_F(TextSliceTest, InvalidUtf8IsRejected) {
+  constexpr std::string_view bad = "ab\xff";
+  EXPECT_EQ(prism_backend_speak_n(backend, bad.data(), bad.size(), false,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_ERROR_INVALID_UTF8);
+  EXPECT_EQ(prism_backend_output_n(backend, bad.data(), bad.size(), false,
+                                   PRISM_TEXT_DEFAULT),
+            PRISM_ERROR_INVALID_UTF8);
+  EXPECT_EQ(prism_backend_braille_n(backend, bad.data(), bad.size(),
+                                    PRISM_TEXT_DEFAULT),
+            PRISM_ERROR_INVALID_UTF8);
+  // A slice that ends before the bad byte is fine.
+  EXPECT_EQ(prism_backend_speak_n(backend, bad.data(), 2, false,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_OK);
+  EXPECT_EQ(engine->spoken(), std::vector<std::string>{"ab"});
+}
+
+TEST_F(TextSliceTest, TruncatedSequenceIsRejected) {
+  // The slice cuts the two-byte encoding of U+00E9 in half.
+  constexpr std::string_view text = "caf\xc3\xa9";
+  EXPECT_EQ(prism_backend_speak_n(backend, text.data(), 4, false,
+                                  PRISM_TEXT_DEFAULT),
+            PRISM_ERROR_INVALID_UTF8);
+  EXPECT_TRUE(engine->spoken().empty());
+}
+
+TEST_F(TextSliceTest, UnknownFlagsAreRejected) {
+  EXPECT_EQ(prism_backend_speak_n(backend, buffer.data(), 5, false, 1U << 30),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_TRUE(engine->spoken().empty());
+}
+} // namespace
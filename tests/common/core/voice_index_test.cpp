@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace {
+class VoiceIndexTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Index", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    {
+      std::scoped_lock lock(engine->mutex);
+      engine->voices = {{.name = "Alice", .language = "en-US"},
+                        {.name = "Bruno", .language = "pt-BR"},
+                        {.name = "Claire", .language = "en-GB"},
+                        {.name = "Dmitri", .language = "ru"}};
+    }
+    backend = fakes.acquire("Fake Index");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  std::size_t find(PrismBackend *from, const char *query,
+                   PrismVoiceQuery kind) {
+    std::size_t out = 99;
+    EXPECT_EQ(prism_backend_find_voice(from, query, kind, &out), PRISM_OK)
+        << query;
+    return out;
+  }
+
+  std::size_t find(const char *query, PrismVoiceQuery kind) {
+    return find(backend, query, kind);
+  }
+};
+
+TEST_F(VoiceIndexTest, NamesIgnoreAsciiCase) {
+  EXPECT_EQ(find("claire", PRISM_VOICE_QUERY_NAME), 2U);
+  EXPECT_EQ(find("BRUNO", PRISM_VOICE_QUERY_NAME), 1U);
+  std::size_t out = 0;
+  EXPECT_EQ(prism_backend_find_voice(backend, "Clai", PRISM_VOICE_QUERY_NAME,
+                                     &out),
+            PRISM_ERROR_VOICE_NOT_FOUND);
+}
+
+TEST_F(VoiceIndexTest, LanguagesFallBack) {
+  EXPECT_EQ(find("en-GB", PRISM_VOICE_QUERY_LANGUAGE), 2U);
+  EXPECT_EQ(find("en_us", PRISM_VOICE_QUERY_LANGUAGE), 0U);
+  // No voice is tagged en alone, so the lowest index under it wins.
+  EXPECT_EQ(find("en", PRISM_VOICE_QUERY_LANGUAGE), 0U);
+  EXPECT_EQ(find("ru-RU", PRISM_VOICE_QUERY_LANGUAGE), 3U);
+  EXPECT_EQ(find("en-AU", PRISM_VOICE_QUERY_LANGUAGE), 0U);
+  std::size_t out = 0;
+  EXPECT_EQ(prism_backend_find_voice(backend, "fr", PRISM_VOICE_QUERY_LANGUAGE,
+                                     &out),
+            PRISM_ERROR_VOICE_NOT_FOUND);
+}
+
+TEST_F(VoiceIndexTest, IdsFromTheListAreFound) {
+  PrismVoiceList *list = nullptr;
+  ASSERT_EQ(prism_backend_get_voices(backend, &list), PRISM_OK);
+  for (std::size_t i = 0; i < list->count; ++i) {
+    std::size_t out = 99;
+    EXPECT_EQ(prism_backend_find_voice_by_id(backend, list->voices[i].id, &out),
+              PRISM_OK);
+    EXPECT_EQ(out, i);
+  }
+  prism_voice_list_free(list);
+}
+
+TEST_F(VoiceIndexTest, BadQueriesAreRejected) {
+  std::size_t out = 0;
+  EXPECT_EQ(prism_backend_find_voice(backend, "Alice", PRISM_VOICE_QUERY_COUNT,
+                                     &out),
+            PRISM_ERROR_INVALID_PARAM);
+  EXPECT_EQ(prism_backend_find_voice(backend, "\xff", PRISM_VOICE_QUERY_NAME,
+                                     &out),
+            PRISM_ERROR_INVALID_UTF8);
+}
+
+TEST_F(VoiceIndexTest, RefreshRebuildsTheIndex) {
+  EXPECT_EQ(find("Alice", PRISM_VOICE_QUERY_NAME), 0U);
+  {
+    std::scoped_lock lock(engine->mutex);
+    std::swap(engine->voices[0], engine->voices[3]);
+  }
+  ASSERT_EQ(prism_backend_refresh_voices(backend), PRISM_OK);
+  EXPECT_EQ(find("Alice", PRISM_VOICE_QUERY_NAME), 3U);
+}
+
+TEST_F(VoiceIndexTest, RefreshThroughAnotherHandleIsSeen) {
+  auto *other = fakes.acquire("Fake Index");
+  ASSERT_NE(other, nullptr);
+  EXPECT_EQ(find("Alice", PRISM_VOICE_QUERY_NAME), 0U);
+  EXPECT_EQ(find(other, "Alice", PRISM_VOICE_QUERY_NAME), 0U);
+  {
+    std::scoped_lock lock(engine->mutex);
+    std::swap(engine->voices[0], engine->voices[3]);
+  }
+  ASSERT_EQ(prism_backend_refresh_voices(other), PRISM_OK);
+  EXPECT_EQ(find("Alice", PRISM_VOICE_QUERY_NAME), 3U);
+}
+} // namespace
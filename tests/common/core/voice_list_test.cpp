@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MPL-2.0
+
+#include "fake_backend.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace {
+class VoiceListTest : public ::testing::Test {
+protected:
+  FakeRegistry fakes;
+  FakeEngine *engine = nullptr;
+  PrismBackend *backend = nullptr;
+  PrismVoiceList *list = nullptr;
+
+  void SetUp() override {
+    engine = &fakes.add("Fake Voices", 100);
+    ASSERT_EQ(fakes.error(), PRISM_OK);
+    ASSERT_TRUE(fakes.start());
+    backend = fakes.create("Fake Voices");
+    ASSERT_NE(backend, nullptr);
+  }
+
+  void TearDown() override { prism_voice_list_free(list); }
+
+  void get(PrismBackend *from) {
+    prism_voice_list_free(list);
+    list = nullptr;
+    ASSERT_EQ(prism_backend_get_voices(from, &list), PRISM_OK);
+    ASSERT_NE(list, nullptr);
+  }
+};
+
+TEST_F(VoiceListTest, EveryVoiceInIndexOrder) {
+  get(backend);
+  ASSERT_EQ(list->count, engine->voices.size());
+  for (std::size_t i = 0; i < list->count; ++i) {
+    const auto &voice = list->voices[i];
+    EXPECT_EQ(voice.index, i);
+    EXPECT_EQ(std::string(voice.name), engine->voices[i].name);
+    EXPECT_EQ(std::string(voice.language), engine->voices[i].language);
+    const char *name = nullptr;
+    ASSERT_EQ(prism_backend_get_voice_name(backend, i, &name), PRISM_OK);
+    EXPECT_STREQ(voice.name, name);
+  }
+  EXPECT_NE(list->voices[0].id, list->voices[1].id);
+}
+
+TEST_F(VoiceListTest, IdSurvivesReordering) {
+  get(backend);
+  const auto alice = list->voices[0].id;
+  {
+    std::scoped_lock lock(engine->mutex);
+    std::swap(engine->voices[0], engine->voices[2]);
+  }
+  ASSERT_EQ(prism_backend_refresh_voices(backend), PRISM_OK);
+  get(backend);
+  EXPECT_EQ(std::string(list->voices[2].name), "Alice");
+  EXPECT_EQ(list->voices[2].index, 2U);
+  EXPECT_EQ(list->voices[2].id, alice);
+}
+
+TEST_F(VoiceListTest, SameNameAndLanguageShareAnId) {
+  {
+    std::scoped_lock lock(engine->mutex);
+    engine->voices.push_back(engine->voices[0]);
+  }
+  get(backend);
+  ASSERT_EQ(list->count, 4U);
+  EXPECT_EQ(list->voices[3].id, list->voices[0].id);
+}
+
+TEST_F(VoiceListTest, ListOutlivesTheBackend) {
+  auto *own = prism_registry_create(
+      fakes.context(), prism_registry_id(fakes.context(), "Fake Voices"));
+  ASSERT_NE(own, nullptr);
+  ASSERT_EQ(prism_backend_initialize(own), PRISM_OK);
+  get(own);
+  prism_backend_free(own);
+  ASSERT_EQ(list->count, 3U);
+  EXPECT_EQ(std::string(list->voices[1].name), "Bruno");
+  EXPECT_EQ(std::string(list->voices[1].language), "pt-BR");
+}
+
+TEST_F(VoiceListTest, EmptyEngineGivesAnEmptyList) {
+  {
+    std::scoped_lock lock(engine->mutex);
+    engine->voices.clear();
+  }
+  get(backend);
+  EXPECT_EQ(list->count, 0U);
+  prism_voice_list_free(nullptr);
+}
+} // namespace